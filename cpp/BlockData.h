@@ -0,0 +1,71 @@
+#ifndef BLOCKDATA_H
+#define BLOCKDATA_H
+
+#include <QTextBlockUserData>
+#include <QVector>
+
+struct Bracket
+{
+    int offset;     // position inside the block
+    int depth;      // nesting level of the content, the same for both brackets of a pair
+    bool opening;
+};
+
+// Identifier or punctuation the outline parser cares about, strings,
+// numbers and comments are left out
+struct Token
+{
+    enum Keyword : unsigned char {
+        NoKeyword,
+        Property,
+        Signal,
+        Function,
+        Id,
+        Readonly,
+        Default,
+        Required,
+        Import,
+        Pragma,
+        Handler     // onSomething
+    };
+
+    int offset;
+    int length;
+    QChar symbol;       // null for identifiers
+    Keyword keyword;
+    bool capitalized;
+
+    bool isIdentifier() const { return symbol.isNull(); }
+};
+
+// Range the lexer coloured, component is a QMLHighlighter::ColorComponent
+struct FormatSpan
+{
+    int start;
+    int length;
+    unsigned char component;
+};
+
+// Lexer results QMLHighlighter keeps on every block
+class BlockData : public QTextBlockUserData
+{
+public:
+    int depthBefore = 0;    // bracket level at the start of the block
+    int minDepth = 0;       // lowest bracket level reached inside the block
+    QVector<Bracket> brackets;
+    QVector<Token> tokens;
+    QVector<FormatSpan> spans;
+    QVector<FormatSpan> literals;   // strings, comments and directives of the top level language
+
+    // what the tokens were lexed from, a block whose text and incoming
+    // state are the same as last time has the same tokens
+    quint64 textHash = 0;
+    int lexerState = -1;            // incoming state without the bracket level, -1 before the first lexing
+
+    int foldOffset = -1;            // first '{' closed in a later block, -1 if none
+    bool endsInComment = false;     // a block comment continues on the next block
+
+    QVector<int> errorColumns;      // set by DiagnosticsModel, kept across re-lexing
+};
+
+#endif // BLOCKDATA_H
@@ -0,0 +1,266 @@
+#include "BracketIndex.h"
+
+#include <QTextBlock>
+#include <QTextDocument>
+#include <algorithm>
+#include <limits>
+
+// Leaf value of blocks that are not lexed yet, never matches a query
+static const int Unknown = std::numeric_limits<int>::max();
+
+BracketIndex::BracketIndex(QTextDocument *document) :
+    m_document(document),
+    m_size(0),
+    m_blockCount(0),
+    m_dirty(true)
+{
+}
+
+BlockData *BracketIndex::blockData(const QTextBlock &block)
+{
+    return block.isValid() ? static_cast<BlockData *>(block.userData()) : nullptr;
+}
+
+void BracketIndex::blockChanged(const QTextBlock &block)
+{
+    if (m_dirty)
+        return;
+
+    // the highlighter re-lexes from the block an edit starts in, the blocks
+    // it added or removed follow the first one reported after it
+    const int delta = m_document->blockCount() - m_blockCount;
+    if (delta != 0)
+    {
+        splice(block.blockNumber() + 1, delta);
+        if (m_dirty)
+            return;
+    }
+
+    BlockData *data = blockData(block);
+    setLeaf(block.blockNumber(), data ? data->minDepth : Unknown);
+}
+
+int BracketIndex::depthAt(int position) const
+{
+    const QTextBlock block = m_document->findBlock(position);
+    const BlockData *data = blockData(block);
+    if (!data)
+        return 0;
+
+    const int offset = position - block.position();
+    int depth = data->depthBefore;
+    foreach (const Bracket &bracket, data->brackets)
+    {
+        if (bracket.offset >= offset)
+            break;
+        depth = bracket.opening ? bracket.depth : bracket.depth - 1;
+    }
+
+    return depth;
+}
+
+int BracketIndex::matchingBracket(int position) const
+{
+    const QTextBlock block = m_document->findBlock(position);
+    const BlockData *data = blockData(block);
+    if (!data)
+        return -1;
+
+    const int offset = position - block.position();
+    const QVector<Bracket> &brackets = data->brackets;
+    const auto found = std::lower_bound(brackets.constBegin(), brackets.constEnd(), offset,
+                                        [](const Bracket &bracket, int value) { return bracket.offset < value; });
+    if (found == brackets.constEnd() || found->offset != offset)
+        return -1;
+
+    const int index = int(found - brackets.constBegin());
+    if (found->opening)
+        return closingBracketAfter(block, index + 1, found->depth);
+
+    return openingBracketBefore(block, index, found->depth);
+}
+
+int BracketIndex::enclosingBlockStart(int position) const
+{
+    const int depth = depthAt(position);
+    if (depth <= 0)
+        return -1;
+
+    const QTextBlock block = m_document->findBlock(position);
+    const BlockData *data = blockData(block);
+    if (!data)
+        return -1;
+
+    const int offset = position - block.position();
+    int index = 0;
+    while (index < data->brackets.count() && data->brackets.at(index).offset < offset)
+        index++;
+
+    return openingBracketBefore(block, index, depth);
+}
+
+// The other bracket of a pair at depth d is in the nearest block, in the
+// search direction, whose level drops below d
+int BracketIndex::closingBracketAfter(const QTextBlock &block, int index, int depth) const
+{
+    const BlockData *data = blockData(block);
+    for (int i = index; i < data->brackets.count(); i++)
+    {
+        const Bracket &bracket = data->brackets.at(i);
+        if (!bracket.opening && bracket.depth == depth)
+            return block.position() + bracket.offset;
+    }
+
+    const int number = firstBlockBelow(block.blockNumber() + 1, depth - 1);
+    if (number < 0)
+        return -1;
+
+    const QTextBlock target = m_document->findBlockByNumber(number);
+    data = blockData(target);
+    foreach (const Bracket &bracket, data->brackets)
+    {
+        if (!bracket.opening && bracket.depth == depth)
+            return target.position() + bracket.offset;
+    }
+
+    return -1;
+}
+
+int BracketIndex::openingBracketBefore(const QTextBlock &block, int index, int depth) const
+{
+    const BlockData *data = blockData(block);
+    for (int i = index - 1; i >= 0; i--)
+    {
+        const Bracket &bracket = data->brackets.at(i);
+        if (bracket.opening && bracket.depth == depth)
+            return block.position() + bracket.offset;
+    }
+
+    const int number = lastBlockBelow(block.blockNumber() - 1, depth - 1);
+    if (number < 0)
+        return -1;
+
+    const QTextBlock target = m_document->findBlockByNumber(number);
+    data = blockData(target);
+    for (int i = data->brackets.count() - 1; i >= 0; i--)
+    {
+        const Bracket &bracket = data->brackets.at(i);
+        if (bracket.opening && bracket.depth == depth)
+            return target.position() + bracket.offset;
+    }
+
+    return -1;
+}
+
+void BracketIndex::rebuild() const
+{
+    m_blockCount = m_document->blockCount();
+    m_size = 1;
+    while (m_size < m_blockCount)
+        m_size *= 2;
+
+    m_tree.fill(Unknown, 2 * m_size);
+
+    int number = 0;
+    for (QTextBlock block = m_document->begin(); block.isValid(); block = block.next(), number++)
+    {
+        const BlockData *data = blockData(block);
+        m_tree[m_size + number] = data ? data->minDepth : Unknown;
+    }
+
+    for (int node = m_size - 1; node > 0; node--)
+        m_tree[node] = qMin(m_tree.at(2 * node), m_tree.at(2 * node + 1));
+
+    m_dirty = false;
+}
+
+// Moves the leaves from from on by delta, the added ones stay Unknown until
+// their blocks are lexed
+void BracketIndex::splice(int from, int delta)
+{
+    const int count = m_blockCount + delta;
+    if (from > m_blockCount || from - qMin(delta, 0) > m_blockCount || count > m_size)
+    {
+        m_dirty = true;
+        return;
+    }
+
+    int *leaves = m_tree.data() + m_size;
+    if (delta > 0)
+    {
+        std::copy_backward(leaves + from, leaves + m_blockCount, leaves + count);
+        std::fill(leaves + from, leaves + from + delta, Unknown);
+    }
+    else
+    {
+        std::copy(leaves + from - delta, leaves + m_blockCount, leaves + from);
+        std::fill(leaves + count, leaves + m_blockCount, Unknown);
+    }
+
+    int low = m_size + from;
+    int high = m_size + qMax(count, m_blockCount) - 1;
+    while (low > 1)
+    {
+        low /= 2;
+        high /= 2;
+        for (int node = low; node <= high; node++)
+            m_tree[node] = qMin(m_tree.at(2 * node), m_tree.at(2 * node + 1));
+    }
+
+    m_blockCount = count;
+}
+
+void BracketIndex::setLeaf(int blockNumber, int value) const
+{
+    int node = m_size + blockNumber;
+    if (m_tree.at(node) == value)
+        return;
+
+    m_tree[node] = value;
+    for (node /= 2; node > 0; node /= 2)
+        m_tree[node] = qMin(m_tree.at(2 * node), m_tree.at(2 * node + 1));
+}
+
+// first block numbered from or later with minDepth <= depth, -1 if none
+int BracketIndex::firstBlockBelow(int from, int depth) const
+{
+    if (m_dirty)
+        rebuild();
+
+    return first(1, 0, m_size, from, depth);
+}
+
+// last block numbered to or earlier with minDepth <= depth, -1 if none
+int BracketIndex::lastBlockBelow(int to, int depth) const
+{
+    if (m_dirty)
+        rebuild();
+
+    return last(1, 0, m_size, to, depth);
+}
+
+int BracketIndex::first(int node, int low, int high, int from, int depth) const
+{
+    if (high <= from || m_tree.at(node) > depth)
+        return -1;
+
+    if (high - low == 1)
+        return low;
+
+    const int middle = (low + high) / 2;
+    const int found = first(2 * node, low, middle, from, depth);
+    return (found >= 0) ? found : first(2 * node + 1, middle, high, from, depth);
+}
+
+int BracketIndex::last(int node, int low, int high, int to, int depth) const
+{
+    if (low > to || m_tree.at(node) > depth)
+        return -1;
+
+    if (high - low == 1)
+        return low;
+
+    const int middle = (low + high) / 2;
+    const int found = last(2 * node + 1, middle, high, to, depth);
+    return (found >= 0) ? found : last(2 * node, low, middle, to, depth);
+}
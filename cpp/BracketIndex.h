@@ -0,0 +1,51 @@
+#ifndef BRACKETINDEX_H
+#define BRACKETINDEX_H
+
+#include <QVector>
+#include "BlockData.h"
+
+class QTextBlock;
+class QTextDocument;
+
+// Document-wide '{' '}' index. The brackets themselves live in BlockData,
+// on top of that a segment tree over the blocks' minDepth finds the block
+// holding the other bracket of a pair in O(log n). Re-lexed blocks update
+// the tree in place; blocks added or removed shift the leaves after them
+// and only the nodes above those are recomputed.
+class BracketIndex
+{
+public:
+    explicit BracketIndex(QTextDocument *document);
+
+    void blockChanged(const QTextBlock &block);
+
+    // bracket level at position
+    int depthAt(int position) const;
+    // position of the bracket paired with the one at position, -1 if there
+    // is no bracket at position or it is unbalanced
+    int matchingBracket(int position) const;
+    // position of the '{' of the innermost block around position, -1 at top level
+    int enclosingBlockStart(int position) const;
+
+    static BlockData *blockData(const QTextBlock &block);
+
+private:
+    void rebuild() const;
+    void splice(int from, int delta);
+    void setLeaf(int blockNumber, int value) const;
+    int firstBlockBelow(int from, int depth) const;
+    int lastBlockBelow(int to, int depth) const;
+    int first(int node, int low, int high, int from, int depth) const;
+    int last(int node, int low, int high, int to, int depth) const;
+    int closingBracketAfter(const QTextBlock &block, int index, int depth) const;
+    int openingBracketBefore(const QTextBlock &block, int index, int depth) const;
+
+    QTextDocument *m_document;
+
+    mutable QVector<int> m_tree;
+    mutable int m_size;
+    mutable int m_blockCount;
+    mutable bool m_dirty;
+};
+
+#endif // BRACKETINDEX_H
@@ -0,0 +1,274 @@
+#include "CodeFolding.h"
+#include "BracketIndex.h"
+
+#include <QTextDocument>
+#include <QTimer>
+
+CodeFolding::CodeFolding(QObject *parent) : QObject(parent)
+{
+
+}
+
+SyntaxHighlighter *CodeFolding::highlighter() const
+{
+    return m_highlighter;
+}
+
+void CodeFolding::setHighlighter(SyntaxHighlighter *highlighter)
+{
+    if (m_highlighter == highlighter)
+        return;
+
+    if (m_highlighter)
+        QObject::disconnect(m_highlighter, &SyntaxHighlighter::highlighterChanged, this, &CodeFolding::attach);
+
+    m_highlighter = highlighter;
+    if (m_highlighter)
+        QObject::connect(m_highlighter, &SyntaxHighlighter::highlighterChanged, this, &CodeFolding::attach);
+
+    attach();
+    emit highlighterChanged();
+}
+
+void CodeFolding::attach()
+{
+    QTextDocument *document = (m_highlighter && m_highlighter->highlighter()) ?
+                m_highlighter->highlighter()->document() : nullptr;
+    if (m_document == document)
+        return;
+
+    if (m_document)
+    {
+        unfoldAll();
+        QObject::disconnect(m_document, &QTextDocument::contentsChange, this, &CodeFolding::onContentsChange);
+    }
+
+    // connected after the highlighter, so blocks are re-lexed by the time
+    // onContentsChange runs
+    m_document = document;
+    if (m_document)
+        QObject::connect(m_document, &QTextDocument::contentsChange, this, &CodeFolding::onContentsChange);
+}
+
+bool CodeFolding::isFoldable(int lineNumber) const
+{
+    if (!m_document)
+        return false;
+
+    return lastHiddenBlock(m_document->findBlockByNumber(lineNumber)).isValid();
+}
+
+bool CodeFolding::isFolded(int lineNumber) const
+{
+    if (!m_document)
+        return false;
+
+    return regionAt(m_document->findBlockByNumber(lineNumber)) >= 0;
+}
+
+void CodeFolding::toggleFold(int lineNumber)
+{
+    if (!m_document)
+        return;
+
+    const QTextBlock header = m_document->findBlockByNumber(lineNumber);
+    const int index = regionAt(header);
+    if (index >= 0)
+    {
+        expand(index);
+        emit foldsChanged();
+        return;
+    }
+
+    const QTextBlock last = lastHiddenBlock(header);
+    if (!last.isValid())
+        return;
+
+    // folded regions inside this one unfold together with it
+    for (int i = m_regions.count() - 1; i >= 0; i--)
+    {
+        const int number = m_regions.at(i).header.blockNumber();
+        if (number > header.blockNumber() && number <= last.blockNumber())
+            m_regions.removeAt(i);
+    }
+
+    Region region;
+    region.header = QTextCursor(header);
+    region.first = QTextCursor(header.next());
+    region.last = QTextCursor(last);
+    region.touched = false;
+    m_regions.append(region);
+
+    setBlocksVisible(header.next(), last, false);
+    emit foldsChanged();
+}
+
+void CodeFolding::unfoldAll()
+{
+    if (m_regions.isEmpty())
+        return;
+
+    while (!m_regions.isEmpty())
+        expand(m_regions.count() - 1);
+
+    emit foldsChanged();
+}
+
+void CodeFolding::reveal(int position)
+{
+    if (!m_document || m_document->findBlock(position).isVisible())
+        return;
+
+    bool changed = false;
+    for (int i = m_regions.count() - 1; i >= 0; i--)
+    {
+        const Region &region = m_regions.at(i);
+        if (position >= region.first.block().position()
+                && position < region.last.block().position() + region.last.block().length())
+        {
+            expand(i);
+            changed = true;
+        }
+    }
+
+    if (changed)
+        emit foldsChanged();
+}
+
+int CodeFolding::visiblePosition(int position) const
+{
+    if (!m_document)
+        return position;
+
+    QTextBlock block = m_document->findBlock(position);
+    if (block.isVisible())
+        return position;
+
+    while (block.isValid() && !block.isVisible())
+        block = block.previous();
+
+    return block.isValid() ? block.position() + block.length() - 1 : 0;
+}
+
+void CodeFolding::onContentsChange(int position, int charsRemoved, int charsAdded)
+{
+    if (m_updating || m_regions.isEmpty())
+        return;
+
+    // The highlighter reports format-only changes with equal counts, those
+    // never touch the folded text itself
+    if (charsRemoved != charsAdded)
+    {
+        for (int i = 0; i < m_regions.count(); i++)
+        {
+            Region &region = m_regions[i];
+            const int hiddenStart = region.first.block().position();
+            const int hiddenEnd = region.last.block().position() + region.last.block().length();
+            if (position < hiddenEnd && position + qMax(charsAdded, 1) > hiddenStart)
+                region.touched = true;
+        }
+    }
+
+    // the bracket index may still be catching up with a multi-block edit
+    if (!m_validationPending)
+    {
+        m_validationPending = true;
+        QTimer::singleShot(0, this, &CodeFolding::validate);
+    }
+}
+
+void CodeFolding::validate()
+{
+    m_validationPending = false;
+
+    bool changed = false;
+    for (int i = m_regions.count() - 1; i >= 0; i--)
+    {
+        const Region &region = m_regions.at(i);
+        const QTextBlock header = region.header.block();
+        const QTextBlock first = region.first.block();
+
+        const bool valid = !region.touched && first != header && first == header.next()
+                && !first.isVisible() && lastHiddenBlock(header) == region.last.block();
+        if (!valid)
+        {
+            expand(i);
+            changed = true;
+        }
+    }
+
+    if (changed)
+        emit foldsChanged();
+}
+
+// Last block a fold starting at header hides: everything up to the line of
+// the closing '}', or up to the line where a block comment ends
+QTextBlock CodeFolding::lastHiddenBlock(const QTextBlock &header) const
+{
+    const BlockData *data = BracketIndex::blockData(header);
+    if (!data || !m_highlighter)
+        return QTextBlock();
+
+    if (data->foldOffset >= 0)
+    {
+        const int closing = m_highlighter->matchingBracket(header.position() + data->foldOffset);
+        if (closing < 0)
+            return QTextBlock();
+
+        const QTextBlock end = m_document->findBlock(closing);
+        return (end.blockNumber() > header.blockNumber() + 1) ? end.previous() : QTextBlock();
+    }
+
+    const BlockData *previous = BracketIndex::blockData(header.previous());
+    if (!data->endsInComment || (previous && previous->endsInComment))
+        return QTextBlock();
+
+    for (QTextBlock block = header.next(); block.isValid(); block = block.next())
+    {
+        const BlockData *blockData = BracketIndex::blockData(block);
+        if (!blockData || !blockData->endsInComment)
+            return block;
+    }
+
+    return m_document->lastBlock();
+}
+
+int CodeFolding::regionAt(const QTextBlock &header) const
+{
+    for (int i = 0; i < m_regions.count(); i++)
+    {
+        if (m_regions.at(i).header.block() == header)
+            return i;
+    }
+
+    return -1;
+}
+
+void CodeFolding::setBlocksVisible(const QTextBlock &first, const QTextBlock &last, bool visible)
+{
+    for (QTextBlock block = first; block.isValid(); block = block.next())
+    {
+        block.setVisible(visible);
+        if (block == last)
+            break;
+    }
+
+    // relayout only the affected range
+    m_updating = true;
+    m_document->markContentsDirty(first.position(), last.position() + last.length() - first.position());
+    m_updating = false;
+}
+
+void CodeFolding::expand(int index)
+{
+    const QTextBlock header = m_regions.at(index).header.block();
+    m_regions.removeAt(index);
+
+    // hidden blocks are always the ones right behind the header
+    QTextBlock last;
+    for (QTextBlock block = header.next(); block.isValid() && !block.isVisible(); block = block.next())
+        last = block;
+
+    if (last.isValid())
+        setBlocksVisible(header.next(), last, true);
+}
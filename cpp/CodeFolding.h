@@ -0,0 +1,66 @@
+#ifndef CODEFOLDING_H
+#define CODEFOLDING_H
+
+#include <QObject>
+#include <QList>
+#include <QTextBlock>
+#include <QTextCursor>
+#include "SyntaxHighlighter.h"
+
+// Collapsible regions of the editor: '{' '}' blocks and block comments
+// spanning several lines, as found by the highlighter (see BlockData).
+// Collapsing hides the region's blocks from the document layout. Folded
+// regions follow edits through QTextCursors and are only re-checked when
+// the document changes, a region that stops being valid is expanded.
+class CodeFolding : public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY(SyntaxHighlighter* highlighter READ highlighter WRITE setHighlighter NOTIFY highlighterChanged)
+
+public:
+    explicit CodeFolding(QObject *parent = nullptr);
+
+    SyntaxHighlighter *highlighter() const;
+    void setHighlighter(SyntaxHighlighter *highlighter);
+
+    Q_INVOKABLE bool isFoldable(int lineNumber) const;
+    Q_INVOKABLE bool isFolded(int lineNumber) const;
+    Q_INVOKABLE void toggleFold(int lineNumber);
+    Q_INVOKABLE void unfoldAll();
+    // expands the regions hiding position
+    Q_INVOKABLE void reveal(int position);
+    // position itself when visible, otherwise the end of the fold header
+    Q_INVOKABLE int visiblePosition(int position) const;
+
+private slots:
+    void attach();
+    void onContentsChange(int position, int charsRemoved, int charsAdded);
+    void validate();
+
+private:
+    struct Region
+    {
+        QTextCursor header;
+        QTextCursor first;  // first hidden block
+        QTextCursor last;   // last hidden block
+        bool touched;       // text inside the hidden blocks was edited
+    };
+
+    QTextBlock lastHiddenBlock(const QTextBlock &header) const;
+    int regionAt(const QTextBlock &header) const;
+    void setBlocksVisible(const QTextBlock &first, const QTextBlock &last, bool visible);
+    void expand(int index);
+
+    SyntaxHighlighter *m_highlighter = nullptr;
+    QTextDocument *m_document = nullptr;
+    QList<Region> m_regions;
+    bool m_updating = false;
+    bool m_validationPending = false;
+
+signals:
+    void highlighterChanged();
+    void foldsChanged();
+};
+
+#endif // CODEFOLDING_H
@@ -0,0 +1,540 @@
+#include "CodeFormatter.h"
+#include "BracketIndex.h"
+
+#include <QTextBlock>
+#include <QTextCursor>
+#include <QTextDocument>
+#include <cstring>
+
+namespace {
+
+enum Kind : unsigned char {
+    Word,           // identifier, number, keyword
+    Literal,        // string or directive
+    Comment,
+    Open,
+    Close,
+    Comma,
+    Semicolon,
+    Colon,
+    Dot,            // also ?. and ...
+    Operator
+};
+
+// How an operator or colon is used, decided from what comes before it
+enum Role : unsigned char {
+    Other,          // spacing is kept
+    Binary,         // one space on both sides
+    Prefix,         // + - ! ~ ++ -- before an operand
+    Postfix         // ++ -- after one
+};
+
+enum WordType : unsigned char {
+    PlainWord,
+    ControlWord,    // if for while with, the statement after their parenthesis may be unbraced
+    BranchWord,     // else do, followed by a statement
+    SpacedWord,     // switch catch, one space before the parenthesis too
+    OperandWord,    // return typeof ..., followed by an operand without being one
+    CaseWord,       // case default
+    ListWord        // list of list<Type>
+};
+
+struct Item
+{
+    int start;
+    int end;
+    Kind kind;
+    Role role;
+    WordType word;
+    QChar symbol;   // first character
+};
+
+// An open bracket
+struct Level
+{
+    int content;    // indent level of the lines inside
+    int line;       // indent level of the line it was opened on
+    int extra;      // continuation levels of that line
+    bool control;   // parenthesis of a ControlWord
+    int ternaries;  // ? waiting for their : outside of it
+};
+
+enum Spacing {
+    Keep,
+    NoSpace,
+    OneSpace
+};
+
+}
+
+// longest first, anything else is a single character operator
+static const char *const Operators[] = {
+    ">>>=", "===", "!==", "**=", "<<=", ">>=", ">>>", "&&=", "||=", "?\?=", "...",
+    "=>", "==", "!=", "<=", ">=", "&&", "||", "??", "?.", "++", "--",
+    "+=", "-=", "*=", "/=", "%=", "&=", "|=", "^=", "**", "<<", ">>"
+};
+
+static bool isOperatorChar(QChar ch)
+{
+    return ch.unicode() < 128 && strchr("+-*/%=<>!&|^~?", ch.toLatin1());
+}
+
+static int operatorLength(const QString &text, int position)
+{
+    for (const char *op : Operators)
+    {
+        if (text.midRef(position, int(strlen(op))) == QLatin1String(op))
+        {
+            // a?.5:1 is a conditional
+            if (op[0] == '?' && op[1] == '.' && position + 2 < text.length() && text.at(position + 2).isDigit())
+                continue;
+            return int(strlen(op));
+        }
+    }
+    return 1;
+}
+
+static WordType wordType(const QStringRef &word)
+{
+    static const char *const controlWords[] = { "if", "for", "while", "with" };
+    static const char *const branchWords[] = { "else", "do" };
+    static const char *const spacedWords[] = { "switch", "catch" };
+    static const char *const operandWords[] = { "return", "typeof", "instanceof", "in", "of", "new", "delete",
+                                                "void", "throw", "yield", "await" };
+
+    for (const char *controlWord : controlWords)
+        if (word == QLatin1String(controlWord))
+            return ControlWord;
+    for (const char *branchWord : branchWords)
+        if (word == QLatin1String(branchWord))
+            return BranchWord;
+    for (const char *spacedWord : spacedWords)
+        if (word == QLatin1String(spacedWord))
+            return SpacedWord;
+    for (const char *operandWord : operandWords)
+        if (word == QLatin1String(operandWord))
+            return OperandWord;
+    if (word == QLatin1String("case") || word == QLatin1String("default"))
+        return CaseWord;
+    if (word == QLatin1String("list"))
+        return ListWord;
+    return PlainWord;
+}
+
+// Splits a block into items: the lexer's literal ranges and identifiers
+// as they are, numbers and punctuation scanned here
+static void scan(const QString &text, const BlockData *blockData, const Language &language, QVector<Item> &items)
+{
+    items.clear();
+    const QVector<FormatSpan> &literals = blockData->literals;
+    const QVector<Token> &tokens = blockData->tokens;
+    const QChar *data = text.constData();
+    const int length = text.length();
+    int literal = 0;
+    int token = 0;
+    int i = 0;
+
+    while (i < length)
+    {
+        const QChar ch = data[i];
+
+        while (literal < literals.count() && literals.at(literal).start + literals.at(literal).length <= i)
+            literal++;
+        if (literal < literals.count() && literals.at(literal).start <= i)
+        {
+            const FormatSpan &span = literals.at(literal++);
+            const Kind kind = (span.component == QMLHighlighter::Comment) ? Comment : Literal;
+            items += Item { i, span.start + span.length, kind, Other, PlainWord, ch };
+            i = span.start + span.length;
+            continue;
+        }
+
+        const unsigned short chClass = language.charClass(ch);
+        if (chClass & SpaceChar)
+        {
+            ++i;
+            continue;
+        }
+
+        while (token < tokens.count() && tokens.at(token).offset < i)
+            token++;
+        if (token < tokens.count() && tokens.at(token).offset == i && tokens.at(token).isIdentifier())
+        {
+            const Token &identifier = tokens.at(token);
+            items += Item { i, i + identifier.length, Word, Other, wordType(text.midRef(i, identifier.length)), ch };
+            i += identifier.length;
+            continue;
+        }
+
+        const int start = i;
+        if ((chClass & IdentifierChar) || (ch == QLatin1Char('.') && i + 1 < length && data[i + 1].isDigit()))
+        {
+            // numbers, with their exponent's sign
+            do
+            {
+                ++i;
+                if (i + 1 < length && (data[i] == QLatin1Char('+') || data[i] == QLatin1Char('-'))
+                        && (data[start].isDigit() || data[start] == QLatin1Char('.'))
+                        && (data[i - 1] == QLatin1Char('e') || data[i - 1] == QLatin1Char('E'))
+                        && data[i + 1].isDigit())
+                    ++i;
+            } while (i < length && ((language.charClass(data[i]) & (IdentifierChar | NumberChar))
+                                    || data[i] == QLatin1Char('.')));
+            items += Item { start, i, Word, Other, PlainWord, ch };
+            continue;
+        }
+
+        Kind kind = Word;
+        int end = i + 1;
+        switch (ch.toLatin1())
+        {
+        case '(': case '[': case '{': kind = Open; break;
+        case ')': case ']': case '}': kind = Close; break;
+        case ',': kind = Comma; break;
+        case ';': kind = Semicolon; break;
+        case ':': kind = Colon; break;
+        case '.':
+            kind = Dot;
+            end = i + operatorLength(text, i);
+            break;
+        default:
+            if (isOperatorChar(ch))
+            {
+                end = i + operatorLength(text, i);
+                kind = (text.midRef(i, end - i) == QLatin1String("?.")) ? Dot : Operator;
+            }
+            break;
+        }
+        items += Item { start, end, kind, Other, PlainWord, ch };
+        i = end;
+    }
+}
+
+// what to do with the whitespace between two items of a line
+static Spacing spacing(const Item &left, const Item &right)
+{
+    if (left.kind == Comment || right.kind == Comment)
+        return Keep;
+
+    if (right.kind == Comma || right.kind == Semicolon)
+        return NoSpace;
+    if (left.kind == Comma)
+        return OneSpace;
+    if (left.kind == Semicolon)
+        return (right.kind == Close) ? Keep : OneSpace;
+
+    if (left.kind == Dot || right.kind == Dot)
+        return NoSpace;
+    if (left.kind == Open && left.symbol != QLatin1Char('{'))
+        return NoSpace;
+    if (right.kind == Close && right.symbol != QLatin1Char('}'))
+        return NoSpace;
+
+    if (right.kind == Colon)
+        return (right.role == Binary) ? OneSpace : NoSpace;
+    if (left.kind == Colon)
+        return OneSpace;
+
+    if (left.kind == Operator && left.role == Binary)
+        return OneSpace;
+    if (right.kind == Operator && right.role == Binary)
+        return OneSpace;
+    if (right.kind == Operator && right.role == Postfix)
+        return NoSpace;
+    if (left.kind == Operator && left.role == Prefix)
+    {
+        // - -x is not --x
+        if (right.kind == Operator && (right.symbol == QLatin1Char('+') || right.symbol == QLatin1Char('-')))
+            return Keep;
+        return NoSpace;
+    }
+
+    if (right.kind == Open && right.symbol == QLatin1Char('{')
+            && (left.kind == Word || left.kind == Literal || left.kind == Close))
+        return OneSpace;
+    if (right.kind == Open && right.symbol == QLatin1Char('(') && left.kind == Word
+            && (left.word == ControlWord || left.word == SpacedWord))
+        return OneSpace;
+
+    return Keep;
+}
+
+CodeFormatter::CodeFormatter(QObject *parent) : QObject(parent)
+{
+
+}
+
+SyntaxHighlighter *CodeFormatter::highlighter() const
+{
+    return m_highlighter;
+}
+
+void CodeFormatter::setHighlighter(SyntaxHighlighter *highlighter)
+{
+    if (m_highlighter == highlighter)
+        return;
+
+    m_highlighter = highlighter;
+    emit highlighterChanged();
+}
+
+int CodeFormatter::indentSize() const
+{
+    return m_indentSize;
+}
+
+void CodeFormatter::setIndentSize(int indentSize)
+{
+    if (m_indentSize == indentSize)
+        return;
+
+    m_indentSize = indentSize;
+    emit indentSizeChanged();
+}
+
+int CodeFormatter::formatDocument()
+{
+    QTextDocument *document = (m_highlighter && m_highlighter->highlighter()) ?
+                m_highlighter->highlighter()->document() : nullptr;
+    if (!document)
+        return 0;
+
+    return format(document, 0, document->blockCount() - 1);
+}
+
+int CodeFormatter::formatRange(int start, int end)
+{
+    QTextDocument *document = (m_highlighter && m_highlighter->highlighter()) ?
+                m_highlighter->highlighter()->document() : nullptr;
+    if (!document)
+        return 0;
+
+    const QTextBlock first = document->findBlock(qMin(start, end));
+    const QTextBlock last = document->findBlock(qMax(start, end));
+    if (!first.isValid() || !last.isValid())
+        return 0;
+
+    return format(document, first.blockNumber(), last.blockNumber());
+}
+
+// Streams every block up to lastBlock through the bracket stack, only
+// blocks from firstBlock on get edits. A line is indented one level past
+// the innermost bracket open before it, all brackets opened on one line
+// count as one level, and a line starting with closing brackets goes back
+// to the line that opened them. Statements running over lines are
+// indented once more: after a binary operator or colon, or before one,
+// and under an unbraced if, for, while, with, else or do.
+int CodeFormatter::format(QTextDocument *document, int firstBlock, int lastBlock)
+{
+    const Language &language = m_highlighter->highlighter()->language();
+
+    QVector<Edit> edits;
+    QVector<Level> stack;
+    QVector<Item> items;
+
+    // what the previous code line left behind
+    bool lastValue = false;         // the last item was an operand
+    WordType lastWord = PlainWord;
+    bool pendingStatement = false;  // an unbraced statement follows
+    int statementExtra = 0;         // continuation levels of the line its if, else ... is on
+    bool endsInOperator = false;
+    int previousExtra = 0;
+    bool previousContinued = false;
+    int ternaries = 0;
+    int generics = 0;
+
+    for (QTextBlock block = document->firstBlock(); block.isValid() && block.blockNumber() <= lastBlock;
+         block = block.next())
+    {
+        const BlockData *blockData = BracketIndex::blockData(block);
+        if (!blockData)
+            continue;
+
+        const QString text = block.text();
+        const bool editable = block.blockNumber() >= firstBlock;
+        const bool startsInLiteral = QMLHighlighter::endsInLiteral(block.previous().userState());
+        scan(text, blockData, language, items);
+
+        if (items.isEmpty())
+        {
+            if (editable && !text.isEmpty())
+                edits += Edit { block.position(), text.length(), QString() };
+            continue;
+        }
+
+        // the line's indent level
+        int closers = 0;
+        while (closers < items.count() && items.at(closers).kind == Close)
+            closers++;
+        closers = qMin(closers, stack.count());
+
+        const Item &first = items.first();
+        const bool firstContinues = first.kind == Dot
+                || (first.kind == Operator && lastValue
+                    && first.symbol != QLatin1Char('!') && first.symbol != QLatin1Char('~')
+                    && text.midRef(first.start, 2) != QLatin1String("++")
+                    && text.midRef(first.start, 2) != QLatin1String("--"))
+                || (first.kind == Colon && ternaries > 0);
+        const bool caseLine = first.kind == Word && first.word == CaseWord && items.last().kind == Colon;
+
+        int level;
+        int extra = 0;
+        bool continued = false;
+        if (closers > 0)
+        {
+            level = stack.at(stack.count() - closers).line;
+            extra = stack.at(stack.count() - closers).extra;
+        }
+        else
+        {
+            if (caseLine)
+            {
+                extra = -1;
+            }
+            else if (pendingStatement)
+            {
+                extra = (first.kind == Open && first.symbol == QLatin1Char('{')) ? statementExtra : statementExtra + 1;
+            }
+            else if (endsInOperator || firstContinues)
+            {
+                extra = previousContinued ? previousExtra : previousExtra + 1;
+                continued = true;
+            }
+            level = qMax(0, (stack.isEmpty() ? 0 : stack.last().content) + extra);
+        }
+
+        if (editable && m_indentSize > 0 && !startsInLiteral)
+        {
+            const QString indent(level * m_indentSize, QLatin1Char(' '));
+            if (text.midRef(0, first.start) != indent)
+                edits += Edit { block.position(), first.start, indent };
+        }
+
+        // the items, with the spaces between them
+        bool raw = false;       // after a regular expression the rest of the line is kept
+        bool closedControl = false;
+        int controlExtra = extra;
+        const Item *lastCode = nullptr;
+        for (int i = 0; i < items.count(); ++i)
+        {
+            Item &item = items[i];
+            if (item.kind == Comment)
+                continue;
+
+            const int length = item.end - item.start;
+            switch (item.kind)
+            {
+            case Operator:
+                if (generics > 0 && item.symbol == QLatin1Char('>') && length == 1)
+                {
+                    generics--;
+                }
+                else if (item.symbol == QLatin1Char('<') && length == 1 && lastWord == ListWord)
+                {
+                    generics++;
+                }
+                else if (lastValue)
+                {
+                    const bool increment = length == 2 && (text.midRef(item.start, 2) == QLatin1String("++")
+                                                           || text.midRef(item.start, 2) == QLatin1String("--"));
+                    if (increment)
+                        item.role = Postfix;
+                    else if (item.symbol != QLatin1Char('!') && item.symbol != QLatin1Char('~'))
+                        item.role = Binary;
+                    if (item.symbol == QLatin1Char('?') && length == 1)
+                        ternaries++;
+                }
+                else if (item.symbol == QLatin1Char('/'))
+                {
+                    raw = true;
+                }
+                else if (length <= 2 && strchr("+-!~", item.symbol.toLatin1())
+                         && (length == 1 || text.at(item.start + 1) == item.symbol))
+                {
+                    item.role = Prefix;
+                }
+                break;
+            case Colon:
+                if (ternaries > 0)
+                {
+                    ternaries--;
+                    item.role = Binary;
+                }
+                break;
+            case Open:
+                stack += Level { level + 1, level, extra,
+                                 item.symbol == QLatin1Char('(') && lastWord == ControlWord, ternaries };
+                ternaries = 0;
+                break;
+            case Close:
+                closedControl = false;
+                if (!stack.isEmpty())
+                {
+                    closedControl = item.symbol == QLatin1Char(')') && stack.last().control;
+                    controlExtra = closedControl ? stack.last().extra : extra;
+                    ternaries = stack.last().ternaries;
+                    stack.removeLast();
+                }
+                break;
+            case Semicolon:
+                ternaries = 0;
+                break;
+            default:
+                break;
+            }
+
+            if (i > 0 && editable && !raw)
+            {
+                const Item &left = items.at(i - 1);
+                const Spacing space = spacing(left, item);
+                const int gap = item.start - left.end;
+                if (space == NoSpace && gap > 0)
+                    edits += Edit { block.position() + left.end, gap, QString() };
+                else if (space == OneSpace && (gap != 1 || text.at(left.end) != QLatin1Char(' ')))
+                    edits += Edit { block.position() + left.end, gap, QStringLiteral(" ") };
+            }
+
+            lastValue = (item.kind == Word && (item.word == PlainWord || item.word == ListWord))
+                    || item.kind == Literal || item.kind == Close
+                    || (item.kind == Operator && item.role == Postfix);
+            lastWord = (item.kind == Word) ? item.word : PlainWord;
+            lastCode = &item;
+        }
+
+        const Item &last = items.last();
+        if (editable && last.end < text.length())
+            edits += Edit { block.position() + last.end, text.length() - last.end, QString() };
+
+        // comment lines do not change how the next line continues
+        if (!lastCode)
+            continue;
+
+        pendingStatement = (lastCode->kind == Close && closedControl)
+                || (lastCode->kind == Word && lastCode->word == BranchWord);
+        statementExtra = (lastCode->kind == Close) ? controlExtra : extra;
+        endsInOperator = (lastCode->kind == Operator && lastCode->role == Binary) || lastCode->kind == Colon;
+        previousExtra = extra;
+        previousContinued = continued;
+    }
+
+    apply(document, edits);
+    return edits.count();
+}
+
+// Last edit first, so the positions of the others stay valid
+void CodeFormatter::apply(QTextDocument *document, const QVector<Edit> &edits)
+{
+    if (edits.isEmpty())
+        return;
+
+    QTextCursor cursor(document);
+    cursor.beginEditBlock();
+    for (int i = edits.count() - 1; i >= 0; --i)
+    {
+        const Edit &edit = edits.at(i);
+        cursor.setPosition(edit.position);
+        cursor.setPosition(edit.position + edit.length, QTextCursor::KeepAnchor);
+        cursor.insertText(edit.text);
+    }
+    cursor.endEditBlock();
+}
@@ -0,0 +1,60 @@
+#ifndef CODEFORMATTER_H
+#define CODEFORMATTER_H
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include "SyntaxHighlighter.h"
+
+class QTextDocument;
+
+// Re-indents code and normalizes the spaces between its tokens, working
+// from what the highlighter's lexer left on every block (see BlockData)
+// instead of parsing the text again. Blocks are streamed from the top of
+// the document to know the brackets open at each line, only whitespace is
+// ever edited, and strings, comments, directives and embedded code are
+// left exactly as they are. The edits go to the document as one edit
+// block, so they make a single change: one undo step, one rehighlight and
+// a cursor that stays on the text it was on.
+class CodeFormatter : public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY(SyntaxHighlighter* highlighter READ highlighter WRITE setHighlighter NOTIFY highlighterChanged)
+    // spaces per level, 0 leaves the indentation as it is
+    Q_PROPERTY(int indentSize READ indentSize WRITE setIndentSize NOTIFY indentSizeChanged)
+
+public:
+    explicit CodeFormatter(QObject *parent = nullptr);
+
+    SyntaxHighlighter *highlighter() const;
+    void setHighlighter(SyntaxHighlighter *highlighter);
+
+    int indentSize() const;
+    void setIndentSize(int indentSize);
+
+    // both return the number of edits made
+    Q_INVOKABLE int formatDocument();
+    // formats the lines touching [start, end]
+    Q_INVOKABLE int formatRange(int start, int end);
+
+private:
+    struct Edit
+    {
+        int position;
+        int length;
+        QString text;
+    };
+
+    int format(QTextDocument *document, int firstBlock, int lastBlock);
+    void apply(QTextDocument *document, const QVector<Edit> &edits);
+
+    SyntaxHighlighter *m_highlighter = nullptr;
+    int m_indentSize = 4;
+
+signals:
+    void highlighterChanged();
+    void indentSizeChanged();
+};
+
+#endif // CODEFORMATTER_H
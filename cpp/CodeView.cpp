@@ -0,0 +1,424 @@
+#include "CodeView.h"
+
+#include <QAbstractTextDocumentLayout>
+#include <QDebug>
+#include <QGuiApplication>
+#include <QPainter>
+#include <QQuickTextDocument>
+#include <QQuickWindow>
+#include <QSGSimpleRectNode>
+#include <QSGSimpleTextureNode>
+#include <QSGTransformNode>
+#include <QStyleHints>
+#include <QTextBlock>
+#include <QTextDocument>
+#include <QTextLayout>
+#include <QtMath>
+
+CodeView::CodeView(QQuickItem *parent) : QQuickItem(parent)
+{
+    setFlag(ItemHasContents);
+
+    QObject::connect(&m_blinkTimer, &QTimer::timeout, this, &CodeView::onBlink);
+}
+
+QQuickItem *CodeView::editor() const
+{
+    return m_editor;
+}
+
+void CodeView::setEditor(QQuickItem *editor)
+{
+    if (m_editor == editor)
+        return;
+
+    if (m_editor)
+    {
+        QObject::disconnect(m_editor, nullptr, this, nullptr);
+        m_editor->setFlag(ItemHasContents, true);
+    }
+    if (m_document)
+        QObject::disconnect(m_document, nullptr, this, nullptr);
+
+    m_editor = editor;
+    m_document = nullptr;
+    if (m_editor)
+    {
+        QQuickTextDocument *quickTextDocument = qvariant_cast<QQuickTextDocument*>(m_editor->property("textDocument"));
+        if (quickTextDocument)
+            m_document = quickTextDocument->textDocument();
+        else
+            qWarning() << "CodeView: the editor has no textDocument";
+
+        // the text is drawn here from now on
+        m_editor->setFlag(ItemHasContents, false);
+
+        // TextEdit is not public C++ API, its signals are connected by name
+        QObject::connect(m_editor, SIGNAL(selectionStartChanged()), this, SLOT(onSelectionChanged()));
+        QObject::connect(m_editor, SIGNAL(selectionEndChanged()), this, SLOT(onSelectionChanged()));
+        QObject::connect(m_editor, SIGNAL(colorChanged(QColor)), this, SLOT(onColorsChanged()));
+        QObject::connect(m_editor, SIGNAL(selectionColorChanged(QColor)), this, SLOT(onColorsChanged()));
+        QObject::connect(m_editor, SIGNAL(selectedTextColorChanged(QColor)), this, SLOT(onColorsChanged()));
+        QObject::connect(m_editor, SIGNAL(cursorRectangleChanged()), this, SLOT(onCursorChanged()));
+        QObject::connect(m_editor, SIGNAL(cursorVisibleChanged(bool)), this, SLOT(onCursorChanged()));
+    }
+    if (m_document)
+        QObject::connect(m_document, &QTextDocument::contentsChange, this, &CodeView::onContentsChange);
+
+    onColorsChanged();
+    onSelectionChanged();
+    onCursorChanged();
+    resetBlocks();
+    emit editorChanged();
+}
+
+qreal CodeView::viewportY() const
+{
+    return m_viewportY;
+}
+
+void CodeView::setViewportY(qreal viewportY)
+{
+    if (qFuzzyCompare(m_viewportY, viewportY))
+        return;
+
+    m_viewportY = viewportY;
+    polish();
+    emit viewportChanged();
+}
+
+qreal CodeView::viewportHeight() const
+{
+    return m_viewportHeight;
+}
+
+void CodeView::setViewportHeight(qreal viewportHeight)
+{
+    if (qFuzzyCompare(m_viewportHeight, viewportHeight))
+        return;
+
+    m_viewportHeight = viewportHeight;
+    polish();
+    emit viewportChanged();
+}
+
+QTextDocument *CodeView::document() const
+{
+    return m_document;
+}
+
+// Blocks first to last replace first to first + removedLines, only those
+// are painted again, the nodes of the others stay as they are and are
+// moved to wherever the layout puts them now
+void CodeView::onContentsChange(int position, int charsRemoved, int charsAdded)
+{
+    Q_UNUSED(charsRemoved)
+
+    QTextDocument *document = this->document();
+    const int first = document->findBlock(position).blockNumber();
+    const int last = document->findBlock(position + charsAdded).blockNumber();
+    const int removedLines = (last - first) - (document->blockCount() - m_blocks.count());
+    if (first < 0 || last < first || removedLines < 0 || first + removedLines >= m_blocks.count())
+    {
+        resetBlocks();
+        return;
+    }
+
+    for (int i = first; i <= first + removedLines; ++i)
+        releaseNode(m_blocks[i]);
+    m_blocks.remove(first, removedLines + 1);
+    m_blocks.insert(first, last - first + 1, Block());
+    polish();
+}
+
+void CodeView::onSelectionChanged()
+{
+    const int start = m_editor ? m_editor->property("selectionStart").toInt() : 0;
+    const int end = m_editor ? m_editor->property("selectionEnd").toInt() : 0;
+    if (start == m_selectionStart && end == m_selectionEnd)
+        return;
+
+    // only the blocks the selection grew or shrank over change
+    if (m_selectionStart == m_selectionEnd)
+    {
+        markDirty(start, end);
+    }
+    else if (start == end)
+    {
+        markDirty(m_selectionStart, m_selectionEnd);
+    }
+    else
+    {
+        markDirty(qMin(start, m_selectionStart), qMax(start, m_selectionStart));
+        markDirty(qMin(end, m_selectionEnd), qMax(end, m_selectionEnd));
+    }
+
+    m_selectionStart = start;
+    m_selectionEnd = end;
+    polish();
+}
+
+void CodeView::onColorsChanged()
+{
+    if (!m_editor)
+        return;
+
+    m_color = m_editor->property("color").value<QColor>();
+    m_selectionColor = m_editor->property("selectionColor").value<QColor>();
+    m_selectedTextColor = m_editor->property("selectedTextColor").value<QColor>();
+    for (Block &block : m_blocks)
+        block.dirty = true;
+    polish();
+}
+
+void CodeView::onCursorChanged()
+{
+    m_cursorRectangle = m_editor ? m_editor->property("cursorRectangle").toRectF() : QRectF();
+    m_cursorVisible = m_editor && m_editor->property("cursorVisible").toBool();
+
+    // the cursor stays on while it moves
+    m_cursorOn = true;
+    const int flashTime = QGuiApplication::styleHints()->cursorFlashTime();
+    if (m_cursorVisible && flashTime > 0)
+        m_blinkTimer.start(flashTime / 2);
+    else
+        m_blinkTimer.stop();
+    update();
+}
+
+void CodeView::onBlink()
+{
+    m_cursorOn = !m_cursorOn;
+    update();
+}
+
+// The first block reaching below y or one before it. Blocks are stacked in
+// order, hidden (folded) ones aside, so a binary search finds it.
+QTextBlock CodeView::blockAt(qreal y) const
+{
+    QTextDocument *document = this->document();
+    QAbstractTextDocumentLayout *layout = document->documentLayout();
+
+    int low = 0;
+    int high = document->blockCount() - 1;
+    while (low < high)
+    {
+        const int middle = (low + high) / 2;
+        QTextBlock block = document->findBlockByNumber(middle);
+        while (block.isValid() && !block.isVisible() && block.blockNumber() < high)
+            block = block.next();
+
+        if (block.isVisible() && layout->blockBoundingRect(block).bottom() <= y)
+            low = block.blockNumber() + 1;
+        else
+            high = middle;
+    }
+
+    return document->findBlockByNumber(low);
+}
+
+void CodeView::resetBlocks()
+{
+    for (Block &block : m_blocks)
+        releaseNode(block);
+
+    QTextDocument *document = this->document();
+    m_blocks = QVector<Block>(document ? document->blockCount() : 0);
+    polish();
+}
+
+// Marks the blocks touching document positions from to to
+void CodeView::markDirty(int from, int to)
+{
+    QTextDocument *document = this->document();
+    if (!document || from > to)
+        return;
+
+    const int first = qMax(document->findBlock(from).blockNumber(), 0);
+    int last = document->findBlock(to).blockNumber();
+    if (last < 0)
+        last = document->blockCount() - 1;
+
+    for (int i = first; i <= last && i < m_blocks.count(); ++i)
+        m_blocks[i].dirty = true;
+}
+
+void CodeView::releaseNode(Block &block)
+{
+    if (block.node)
+        m_releasedNodes += block.node;
+    block.node = nullptr;
+    block.image = QImage();
+}
+
+// Paints the block's layout, cut to the width of its text, with the
+// selection as an extra format range
+QImage CodeView::paint(const QTextBlock &block) const
+{
+    QTextLayout *layout = block.layout();
+    const QRectF bounds = layout->boundingRect();
+
+    qreal width = 0;
+    for (int i = 0; i < layout->lineCount(); ++i)
+    {
+        const QTextLine line = layout->lineAt(i);
+        width = qMax(width, line.x() + line.naturalTextWidth() - bounds.left());
+    }
+    const qreal ratio = window() ? window()->effectiveDevicePixelRatio() : 1;
+    const QSize size(qCeil((width + 1) * ratio), qCeil(bounds.height() * ratio));
+    if (width <= 0 || size.isEmpty())
+        return QImage();
+
+    QImage image(size, QImage::Format_ARGB32_Premultiplied);
+    image.setDevicePixelRatio(ratio);
+    image.fill(Qt::transparent);
+
+    QVector<QTextLayout::FormatRange> selections;
+    const int selectionStart = qMax(m_selectionStart - block.position(), 0);
+    const int selectionEnd = qMin(m_selectionEnd - block.position(), block.length());
+    if (selectionStart < selectionEnd)
+    {
+        QTextLayout::FormatRange range;
+        range.start = selectionStart;
+        range.length = selectionEnd - selectionStart;
+        range.format.setBackground(m_selectionColor);
+        range.format.setForeground(m_selectedTextColor);
+        selections += range;
+    }
+
+    QPainter painter(&image);
+    painter.setPen(m_color);
+    layout->draw(&painter, -layout->position() - bounds.topLeft(), selections);
+    return image;
+}
+
+// Runs in the GUI thread before every sync: finds the blocks in and around
+// the viewport and paints the ones that changed, uploading is left to the
+// render thread
+void CodeView::updatePolish()
+{
+    QTextDocument *document = this->document();
+    if (!document)
+        return;
+
+    if (m_blocks.count() != document->blockCount())
+        resetBlocks();
+
+    // half a viewport above and below is ready before it is scrolled to
+    const qreal margin = m_viewportHeight / 2;
+    const qreal top = m_viewportY - margin;
+    const qreal bottom = m_viewportY + m_viewportHeight + margin;
+    QAbstractTextDocumentLayout *layout = document->documentLayout();
+
+    m_polish++;
+    for (QTextBlock block = blockAt(top); block.isValid(); block = block.next())
+    {
+        if (!block.isVisible())
+            continue;
+
+        const QRectF rect = layout->blockBoundingRect(block);
+        if (rect.top() >= bottom)
+            break;
+        if (rect.bottom() <= top)
+            continue;
+
+        Block &entry = m_blocks[block.blockNumber()];
+        if (entry.dirty || entry.rect.size() != rect.size() || (!entry.node && entry.image.isNull()))
+        {
+            entry.image = paint(block);
+            entry.paintedSize = entry.image.isNull() ? QSizeF() : QSizeF(entry.image.size()) / entry.image.devicePixelRatio();
+            entry.dirty = false;
+            if (entry.paintedSize.isEmpty())
+                releaseNode(entry);
+        }
+        entry.rect = rect;
+        entry.shownIn = m_polish;
+    }
+
+    m_shownChanged = true;
+    update();
+}
+
+// Runs in the render thread while the GUI thread waits
+QSGNode *CodeView::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data)
+{
+    Q_UNUSED(data)
+
+    QSGNode *root = oldNode;
+    if (!root)
+    {
+        // the scene graph was (re)created, nodes held from a previous one are gone
+        root = new QSGNode;
+        m_releasedNodes.clear();
+        m_cursorNode = nullptr;
+        bool lost = false;
+        for (Block &block : m_blocks)
+        {
+            lost = lost || block.node;
+            block.node = nullptr;
+        }
+        if (lost)
+            QMetaObject::invokeMethod(this, [this] { polish(); }, Qt::QueuedConnection);
+    }
+
+    qDeleteAll(m_releasedNodes);
+    m_releasedNodes.clear();
+
+    // the cursor is the last child, over the blocks
+    if (!m_cursorNode)
+    {
+        m_cursorNode = new QSGSimpleRectNode;
+        root->appendChildNode(m_cursorNode);
+    }
+
+    if (m_shownChanged)
+    {
+        m_shownChanged = false;
+        for (Block &block : m_blocks)
+        {
+            if (block.shownIn != m_polish || block.paintedSize.isEmpty())
+            {
+                if (block.node)
+                {
+                    delete block.node;
+                    block.node = nullptr;
+                }
+                block.image = QImage();
+                continue;
+            }
+
+            if (!block.node && block.image.isNull())
+                continue;
+
+            if (!block.node)
+            {
+                block.node = new QSGTransformNode;
+                QSGSimpleTextureNode *textureNode = new QSGSimpleTextureNode;
+                textureNode->setOwnsTexture(true);
+                block.node->appendChildNode(textureNode);
+                root->insertChildNodeBefore(block.node, m_cursorNode);
+            }
+
+            QSGSimpleTextureNode *textureNode = static_cast<QSGSimpleTextureNode*>(block.node->firstChild());
+            if (!block.image.isNull())
+            {
+                textureNode->setTexture(window()->createTextureFromImage(block.image, QQuickWindow::TextureCanUseAtlas
+                                                                         | QQuickWindow::TextureHasAlphaChannel));
+                textureNode->setRect(QRectF(QPointF(), block.paintedSize));
+                block.image = QImage();
+            }
+
+            QMatrix4x4 matrix;
+            matrix.translate(block.rect.left(), block.rect.top());
+            if (block.node->matrix() != matrix)
+                block.node->setMatrix(matrix);
+        }
+    }
+
+    const bool cursorShown = m_cursorVisible && m_cursorOn;
+    m_cursorNode->setColor(cursorShown ? m_color : Qt::transparent);
+    m_cursorNode->setRect(QRectF(m_cursorRectangle.topLeft(),
+                                 QSizeF(qMax<qreal>(m_cursorRectangle.width(), 1), m_cursorRectangle.height())));
+
+    return root;
+}
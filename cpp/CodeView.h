@@ -0,0 +1,103 @@
+#ifndef CODEVIEW_H
+#define CODEVIEW_H
+
+#include <QColor>
+#include <QImage>
+#include <QPointer>
+#include <QQuickItem>
+#include <QTimer>
+#include <QVector>
+
+class QSGNode;
+class QSGSimpleRectNode;
+class QSGTransformNode;
+class QTextBlock;
+class QTextDocument;
+
+// Draws the document of a TextEdit in its place, one scene graph subtree
+// per text block: a texture node holding the block's layout as painted by
+// QTextLayout (highlighting formats, selection and input method preedit
+// included) under a transform node that places it. Only the blocks in and
+// around the viewport get nodes, and a block is painted again only when an
+// edit or its highlighting changed it, the selection moved over it or its
+// size changed; scrolling merely moves the nodes. The TextEdit keeps doing
+// layout, input, selection and the input method, but no longer builds glyph
+// nodes of its own, the cursor is drawn here as well.
+class CodeView : public QQuickItem
+{
+    Q_OBJECT
+
+    Q_PROPERTY(QQuickItem* editor READ editor WRITE setEditor NOTIFY editorChanged)
+    // the visible part of the view, in its own coordinates
+    Q_PROPERTY(qreal viewportY READ viewportY WRITE setViewportY NOTIFY viewportChanged)
+    Q_PROPERTY(qreal viewportHeight READ viewportHeight WRITE setViewportHeight NOTIFY viewportChanged)
+
+public:
+    explicit CodeView(QQuickItem *parent = nullptr);
+
+    QQuickItem *editor() const;
+    void setEditor(QQuickItem *editor);
+
+    qreal viewportY() const;
+    void setViewportY(qreal viewportY);
+
+    qreal viewportHeight() const;
+    void setViewportHeight(qreal viewportHeight);
+
+protected:
+    void updatePolish() override;
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data) override;
+
+private slots:
+    void onContentsChange(int position, int charsRemoved, int charsAdded);
+    void onSelectionChanged();
+    void onColorsChanged();
+    void onCursorChanged();
+    void onBlink();
+
+private:
+    struct Block
+    {
+        QRectF rect;                        // in the document, at the last polish
+        QImage image;                       // painted but not uploaded yet
+        QSizeF paintedSize;                 // empty for blocks without any text
+        bool dirty = true;
+        int shownIn = -1;                   // the last polish that found it in the viewport
+        QSGTransformNode *node = nullptr;
+    };
+
+    QTextDocument *document() const;
+    QTextBlock blockAt(qreal y) const;
+    void resetBlocks();
+    void markDirty(int from, int to);
+    void releaseNode(Block &block);
+    QImage paint(const QTextBlock &block) const;
+
+    QPointer<QQuickItem> m_editor;
+    QPointer<QTextDocument> m_document;
+    qreal m_viewportY = 0;
+    qreal m_viewportHeight = 0;
+
+    QVector<Block> m_blocks;                // one per block of the document
+    QVector<QSGNode*> m_releasedNodes;      // deleted at the next sync
+    int m_polish = 0;
+    bool m_shownChanged = false;            // the blocks need nodes added or removed at the next sync
+
+    QColor m_color;
+    QColor m_selectionColor;
+    QColor m_selectedTextColor;
+    int m_selectionStart = 0;
+    int m_selectionEnd = 0;
+
+    QRectF m_cursorRectangle;
+    bool m_cursorVisible = false;
+    bool m_cursorOn = true;
+    QTimer m_blinkTimer;
+    QSGSimpleRectNode *m_cursorNode = nullptr;
+
+signals:
+    void editorChanged();
+    void viewportChanged();
+};
+
+#endif // CODEVIEW_H
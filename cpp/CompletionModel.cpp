@@ -0,0 +1,420 @@
+#include "CompletionModel.h"
+#include "BracketIndex.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QTextBlock>
+#include <QTextDocument>
+#include <QTextStream>
+#include <algorithm>
+
+QVector<CompletionModel::Entry> CompletionModel::m_dictionary = QVector<CompletionModel::Entry>();
+
+static const int MaximumCount = 20;
+
+static const int ExactPrefixScore = 300;
+static const int PrefixScore = 200;
+static const int SubsequenceScore = 100;
+
+// how well each kind of word fits a context, by Context and then Kind
+// (Type, Property, BuiltIn, Keyword)
+static const int KindWeights[][4] = {
+    {  0,  0,  0,  0 },     // NoContext
+    { 60,  0, 10, 40 },     // TopLevelContext
+    { 40, 60,  0, 30 },     // StatementContext
+    { 30, 10, 50, 40 },     // ValueContext
+    {  0, 60, 30,  0 },     // MemberContext
+    { 30,  0,  0, 60 }      // PropertyTypeContext
+};
+
+static bool isWordCharacter(QChar ch)
+{
+    return ch.isLetterOrNumber() || ch == '_';
+}
+
+CompletionModel::CompletionModel(QObject *parent) : QAbstractListModel(parent)
+{
+    if (m_dictionary.isEmpty())
+        loadDictionaries();
+}
+
+SyntaxHighlighter *CompletionModel::highlighter() const
+{
+    return m_highlighter;
+}
+
+void CompletionModel::setHighlighter(SyntaxHighlighter *highlighter)
+{
+    if (m_highlighter == highlighter)
+        return;
+
+    clear();
+    m_highlighter = highlighter;
+    emit highlighterChanged();
+}
+
+int CompletionModel::count() const
+{
+    return m_candidates.count();
+}
+
+int CompletionModel::wordStart() const
+{
+    return m_wordStart;
+}
+
+int CompletionModel::wordEnd() const
+{
+    return m_wordEnd;
+}
+
+void CompletionModel::addQmlComponent(const QString &componentName)
+{
+    // candidates point into the entries
+    clear();
+    insertSorted(m_projectEntries, componentName, Type);
+}
+
+void CompletionModel::addJsComponent(const QString &componentName)
+{
+    clear();
+    insertSorted(m_projectEntries, componentName, BuiltIn);
+}
+
+void CompletionModel::update(int position)
+{
+    QMLHighlighter *highlighter = m_highlighter ? m_highlighter->highlighter() : nullptr;
+    if (!highlighter)
+        return;
+
+    const QTextBlock block = highlighter->document()->findBlock(position);
+    const QString text = block.text();
+    const int column = position - block.position();
+
+    int start = column;
+    while (start > 0 && isWordCharacter(text.at(start - 1)))
+        start--;
+
+    if (start == column || text.at(start).isDigit())
+    {
+        clear();
+        return;
+    }
+
+    const Context context = contextAt(block.position() + start);
+    if (context == NoContext)
+    {
+        clear();
+        return;
+    }
+
+    const QString prefix = text.mid(start, column - start);
+
+    beginResetModel();
+    m_candidates.clear();
+    collect(m_dictionary, prefix, context, m_candidates);
+    collect(m_projectEntries, prefix, context, m_candidates);
+
+    auto compare = [](const Candidate &a, const Candidate &b) {
+        if (a.score != b.score)
+            return a.score > b.score;
+        if (a.entry->word.length() != b.entry->word.length())
+            return a.entry->word.length() < b.entry->word.length();
+        return a.entry->key < b.entry->key;
+    };
+
+    if (m_candidates.count() > MaximumCount)
+    {
+        std::partial_sort(m_candidates.begin(), m_candidates.begin() + MaximumCount, m_candidates.end(), compare);
+        m_candidates.resize(MaximumCount);
+    }
+    else
+    {
+        std::sort(m_candidates.begin(), m_candidates.end(), compare);
+    }
+
+    m_context = context;
+    m_wordStart = block.position() + start;
+    m_wordEnd = position;
+    endResetModel();
+
+    emit countChanged();
+}
+
+void CompletionModel::clear()
+{
+    if (m_candidates.isEmpty() && m_wordStart < 0)
+        return;
+
+    beginResetModel();
+    m_candidates.clear();
+    m_context = NoContext;
+    m_wordStart = -1;
+    m_wordEnd = -1;
+    endResetModel();
+
+    emit countChanged();
+}
+
+QString CompletionModel::completion(int row) const
+{
+    if (row < 0 || row >= m_candidates.count())
+        return QString();
+
+    // a property at the start of a statement is a binding
+    const Entry *entry = m_candidates.at(row).entry;
+    if (entry->kind == Property && m_context == StatementContext)
+        return entry->word + QStringLiteral(": ");
+
+    return entry->word;
+}
+
+int CompletionModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+
+    return m_candidates.count();
+}
+
+QVariant CompletionModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_candidates.count())
+        return QVariant();
+
+    const Entry *entry = m_candidates.at(index.row()).entry;
+    switch (role) {
+    case Qt::DisplayRole:
+    case NameRole:
+        return entry->word;
+    case KindRole:
+        switch (entry->kind) {
+        case Type: return QStringLiteral("type");
+        case Property: return QStringLiteral("property");
+        case BuiltIn: return QStringLiteral("builtin");
+        case Keyword: return QStringLiteral("keyword");
+        }
+        break;
+    case CompletionRole:
+        return completion(index.row());
+    }
+
+    return QVariant();
+}
+
+QHash<int, QByteArray> CompletionModel::roleNames() const
+{
+    QHash<int, QByteArray> roles;
+    roles[NameRole] = "name";
+    roles[KindRole] = "kind";
+    roles[CompletionRole] = "completion";
+    return roles;
+}
+
+bool CompletionModel::lessThanKey(const Entry &entry, const QString &key)
+{
+    return entry.key < key;
+}
+
+void CompletionModel::loadDictionaries()
+{
+    loadDictionary(":/resources/dictionaries/qml.txt", Type, m_dictionary);
+    loadDictionary(":/resources/dictionaries/properties.txt", Property, m_dictionary);
+    loadDictionary(":/resources/dictionaries/javascript.txt", BuiltIn, m_dictionary);
+    loadDictionary(":/resources/dictionaries/keywords.txt", Keyword, m_dictionary);
+
+    std::sort(m_dictionary.begin(), m_dictionary.end(), [](const Entry &a, const Entry &b) {
+        return (a.key != b.key) ? a.key < b.key : a.word < b.word;
+    });
+    m_dictionary.squeeze();
+}
+
+void CompletionModel::loadDictionary(const QString &filePath, Kind kind, QVector<Entry> &entries)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        qWarning() << "Can't open dictionary" << filePath;
+        return;
+    }
+
+    QTextStream textStream(&file);
+    while (!textStream.atEnd())
+    {
+        const QString word = textStream.readLine().trimmed();
+        if (!word.isEmpty())
+            entries += Entry { word.toLower(), word, kind };
+    }
+}
+
+void CompletionModel::insertSorted(QVector<Entry> &entries, const QString &word, Kind kind)
+{
+    const QString key = word.toLower();
+    auto it = std::lower_bound(entries.begin(), entries.end(), key, lessThanKey);
+    for (auto same = it; same != entries.end() && same->key == key; ++same)
+    {
+        if (same->word == word && same->kind == kind)
+            return;
+    }
+
+    entries.insert(it, Entry { key, word, kind });
+}
+
+// Number of characters skipped when matching pattern as a subsequence of
+// key, -1 if it does not match. The first characters have to be equal.
+int CompletionModel::fuzzyGaps(const QString &key, const QString &pattern)
+{
+    if (key.isEmpty() || key.at(0) != pattern.at(0))
+        return -1;
+
+    int gaps = 0;
+    int k = 1;
+    for (int p = 1; p < pattern.length(); p++)
+    {
+        while (k < key.length() && key.at(k) != pattern.at(p))
+        {
+            k++;
+            gaps++;
+        }
+
+        if (k == key.length())
+            return -1;
+
+        k++;
+    }
+
+    return gaps;
+}
+
+bool CompletionModel::isKeyword(const QString &word)
+{
+    const QString key = word.toLower();
+    auto it = std::lower_bound(m_dictionary.constBegin(), m_dictionary.constEnd(), key, lessThanKey);
+    for (; it != m_dictionary.constEnd() && it->key == key; ++it)
+    {
+        if (it->kind == Keyword && it->word == word)
+            return true;
+    }
+
+    return false;
+}
+
+// What is expected at wordStart, from the token in front of the word
+CompletionModel::Context CompletionModel::contextAt(int wordStart) const
+{
+    QMLHighlighter *highlighter = m_highlighter->highlighter();
+    QTextBlock block = highlighter->document()->findBlock(wordStart);
+    const BlockData *data = BracketIndex::blockData(block);
+    if (!data)
+        return NoContext;
+
+    // the lexer leaves no identifier token in strings and comments
+    const int column = wordStart - block.position();
+    int index = 0;
+    while (index < data->tokens.count() && data->tokens.at(index).offset < column)
+        index++;
+
+    if (index == data->tokens.count() || data->tokens.at(index).offset != column
+            || !data->tokens.at(index).isIdentifier())
+        return NoContext;
+
+    const Token::Keyword firstKeyword = data->tokens.first().keyword;
+    if (firstKeyword == Token::Import || firstKeyword == Token::Pragma)
+        return NoContext;
+
+    const int depth = highlighter->brackets().depthAt(wordStart);
+    const Context statementContext = (depth == 0) ? TopLevelContext : StatementContext;
+
+    // previous token, possibly on an earlier line
+    bool sameLine = true;
+    while (index == 0)
+    {
+        block = block.previous();
+        data = BracketIndex::blockData(block);
+        if (!block.isValid())
+            return statementContext;
+
+        sameLine = false;
+        index = data ? data->tokens.count() : 0;
+    }
+
+    const Token &previous = data->tokens.at(index - 1);
+    if (previous.isIdentifier())
+    {
+        switch (previous.keyword) {
+        case Token::Property:
+            return PropertyTypeContext;
+        case Token::Readonly:
+        case Token::Default:
+        case Token::Required:
+            return StatementContext;
+        case Token::NoKeyword:
+            break;
+        default:
+            // names being declared
+            return NoContext;
+        }
+
+        if (!sameLine)
+            return statementContext;
+
+        const QString word = block.text().mid(previous.offset, previous.length);
+        if (word == QLatin1String("on"))
+            return MemberContext;
+        if (isKeyword(word))
+            return ValueContext;
+
+        return NoContext;
+    }
+
+    switch (previous.symbol.unicode()) {
+    case '.':
+        return MemberContext;
+    case '{':
+    case '}':
+    case ';':
+        return statementContext;
+    case ':':
+        if (index >= 2 && data->tokens.at(index - 2).keyword == Token::Id)
+            return NoContext;
+        return ValueContext;
+    case ')':
+    case ']':
+        // the previous statement ended on the line before
+        return sameLine ? ValueContext : statementContext;
+    default:
+        return ValueContext;
+    }
+}
+
+void CompletionModel::collect(const QVector<Entry> &entries, const QString &prefix, Context context,
+                              QVector<Candidate> &candidates) const
+{
+    const QString key = prefix.toLower();
+    const int *weights = KindWeights[context];
+
+    auto first = std::lower_bound(entries.constBegin(), entries.constEnd(), key, lessThanKey);
+    for (auto it = first; it != entries.constEnd() && it->key.startsWith(key); ++it)
+    {
+        if (it->word == prefix)
+            continue;
+
+        const int score = it->word.startsWith(prefix) ? ExactPrefixScore : PrefixScore;
+        candidates += Candidate { &*it, score + weights[it->kind] };
+    }
+
+    // a single character matches too much as a subsequence
+    if (key.length() < 2)
+        return;
+
+    for (int i = 0; i < entries.count(); i++)
+    {
+        const Entry &entry = entries.at(i);
+        if (entry.key.startsWith(key))
+            continue;
+
+        const int gaps = fuzzyGaps(entry.key, key);
+        if (gaps >= 0)
+            candidates += Candidate { &entry, SubsequenceScore - qMin(gaps, 50) + weights[entry.kind] };
+    }
+}
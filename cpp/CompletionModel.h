@@ -0,0 +1,110 @@
+#ifndef COMPLETIONMODEL_H
+#define COMPLETIONMODEL_H
+
+#include <QAbstractListModel>
+#include <QVector>
+#include "SyntaxHighlighter.h"
+
+// Completion candidates for the word in front of the cursor. The words
+// come from the highlighter's dictionaries and the project's components,
+// kept in arrays sorted by their lowercase form so a prefix is a binary
+// search away. Candidates are ranked by how they match (prefix, case
+// insensitive prefix, then subsequence) and by what fits the place the
+// lexer says the cursor is at: a property at the start of a statement
+// inside an object, a type or a builtin after a ':' and so on.
+class CompletionModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+    Q_PROPERTY(SyntaxHighlighter* highlighter READ highlighter WRITE setHighlighter NOTIFY highlighterChanged)
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+    Q_PROPERTY(int wordStart READ wordStart NOTIFY countChanged)
+    Q_PROPERTY(int wordEnd READ wordEnd NOTIFY countChanged)
+
+public:
+    enum Roles {
+        NameRole = Qt::UserRole + 1,
+        KindRole,
+        CompletionRole
+    };
+
+    enum Kind : unsigned char {
+        Type,
+        Property,
+        BuiltIn,
+        Keyword
+    };
+
+    enum Context {
+        NoContext,
+        TopLevelContext,    // outside of any object
+        StatementContext,   // start of a statement inside an object
+        ValueContext,       // right hand side of a binding, expressions
+        MemberContext,      // after a '.'
+        PropertyTypeContext // after "property"
+    };
+
+    explicit CompletionModel(QObject *parent = nullptr);
+
+    SyntaxHighlighter *highlighter() const;
+    void setHighlighter(SyntaxHighlighter *highlighter);
+
+    int count() const;
+    int wordStart() const;
+    int wordEnd() const;
+
+    Q_INVOKABLE void addQmlComponent(const QString &componentName);
+    Q_INVOKABLE void addJsComponent(const QString &componentName);
+
+    // completes the word ending at position, the model is emptied when
+    // there is nothing to complete there
+    Q_INVOKABLE void update(int position);
+    Q_INVOKABLE void clear();
+    // text replacing [wordStart, wordEnd) for the candidate at row
+    Q_INVOKABLE QString completion(int row) const;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+private:
+    struct Entry
+    {
+        QString key;    // lowercase word, the sort key
+        QString word;
+        Kind kind;
+    };
+
+    struct Candidate
+    {
+        const Entry *entry;
+        int score;
+    };
+
+    static bool lessThanKey(const Entry &entry, const QString &key);
+    static void loadDictionaries();
+    static void loadDictionary(const QString &filePath, Kind kind, QVector<Entry> &entries);
+    static void insertSorted(QVector<Entry> &entries, const QString &word, Kind kind);
+    static int fuzzyGaps(const QString &key, const QString &pattern);
+    static bool isKeyword(const QString &word);
+
+    Context contextAt(int wordStart) const;
+    void collect(const QVector<Entry> &entries, const QString &prefix, Context context,
+                 QVector<Candidate> &candidates) const;
+
+    static QVector<Entry> m_dictionary;
+
+    SyntaxHighlighter *m_highlighter = nullptr;
+    QVector<Entry> m_projectEntries;
+
+    QVector<Candidate> m_candidates;
+    Context m_context = NoContext;
+    int m_wordStart = -1;
+    int m_wordEnd = -1;
+
+signals:
+    void highlighterChanged();
+    void countChanged();
+};
+
+#endif // COMPLETIONMODEL_H
@@ -0,0 +1,341 @@
+#include "DiagnosticsModel.h"
+#include "BracketIndex.h"
+
+#include <QQmlComponent>
+#include <QQmlEngine>
+#include <QQmlError>
+#include <QTextBlock>
+#include <QTextDocument>
+#include <QThread>
+
+DiagnosticsModel::DiagnosticsModel(QObject *parent) : QAbstractListModel(parent),
+    m_thread(new QThread(this)),
+    m_worker(new QObject)
+{
+    m_timer.setSingleShot(true);
+    m_timer.setInterval(500);
+    QObject::connect(&m_timer, &QTimer::timeout, this, &DiagnosticsModel::check);
+
+    // the worker and the engine are deleted in their own thread once it ends
+    m_worker->moveToThread(m_thread);
+    QObject::connect(m_thread, &QThread::finished, m_worker, &QObject::deleteLater);
+}
+
+DiagnosticsModel::~DiagnosticsModel()
+{
+    m_generation.fetchAndAddOrdered(1);
+    if (m_thread->isRunning())
+    {
+        m_thread->quit();
+        m_thread->wait();
+    }
+    else
+    {
+        delete m_worker;
+    }
+}
+
+TextBuffer *DiagnosticsModel::buffer() const
+{
+    return m_buffer;
+}
+
+void DiagnosticsModel::setBuffer(TextBuffer *buffer)
+{
+    if (m_buffer == buffer)
+        return;
+
+    if (m_buffer)
+        QObject::disconnect(m_buffer, nullptr, this, nullptr);
+
+    setEntries(QVector<Entry>());
+    m_buffer = buffer;
+    if (m_buffer)
+    {
+        QObject::connect(m_buffer, &TextBuffer::contentsEdited, this, &DiagnosticsModel::onContentsEdited);
+        QObject::connect(m_buffer, &TextBuffer::loadingChanged, this, &DiagnosticsModel::onContentsEdited);
+    }
+
+    onContentsEdited();
+    emit bufferChanged();
+}
+
+SyntaxHighlighter *DiagnosticsModel::highlighter() const
+{
+    return m_highlighter;
+}
+
+void DiagnosticsModel::setHighlighter(SyntaxHighlighter *highlighter)
+{
+    if (m_highlighter == highlighter)
+        return;
+
+    setEntries(QVector<Entry>());
+    m_highlighter = highlighter;
+    emit highlighterChanged();
+}
+
+QUrl DiagnosticsModel::fileUrl() const
+{
+    return m_fileUrl;
+}
+
+void DiagnosticsModel::setFileUrl(const QUrl &fileUrl)
+{
+    if (m_fileUrl == fileUrl)
+        return;
+
+    m_fileUrl = fileUrl;
+    if (m_fileUrl.isEmpty())
+        setEntries(QVector<Entry>());
+
+    onContentsEdited();
+    emit fileUrlChanged();
+}
+
+int DiagnosticsModel::delay() const
+{
+    return m_timer.interval();
+}
+
+void DiagnosticsModel::setDelay(int delay)
+{
+    if (m_timer.interval() == delay)
+        return;
+
+    m_timer.setInterval(delay);
+    emit delayChanged();
+}
+
+int DiagnosticsModel::count() const
+{
+    return m_entries.count();
+}
+
+bool DiagnosticsModel::hasDiagnostic(int lineIndex) const
+{
+    foreach (const Entry &entry, m_entries) {
+        if (entry.cursor.blockNumber() == lineIndex)
+            return true;
+    }
+
+    return false;
+}
+
+QString DiagnosticsModel::messageAt(int position) const
+{
+    if (m_entries.isEmpty())
+        return QString();
+
+    const int blockNumber = m_entries.first().cursor.document()->findBlock(position).blockNumber();
+    foreach (const Entry &entry, m_entries) {
+        if (entry.cursor.blockNumber() == blockNumber)
+            return entry.message;
+    }
+
+    return QString();
+}
+
+void DiagnosticsModel::clearCache()
+{
+    m_cacheStale = true;
+    onContentsEdited();
+}
+
+int DiagnosticsModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+
+    return m_entries.count();
+}
+
+QVariant DiagnosticsModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_entries.count())
+        return QVariant();
+
+    const Entry &entry = m_entries.at(index.row());
+    switch (role) {
+    case LineRole:
+        return entry.cursor.blockNumber() + 1;
+    case ColumnRole:
+        return entry.cursor.positionInBlock() + 1;
+    case Qt::DisplayRole:
+    case MessageRole:
+        return entry.message;
+    case PositionRole:
+        return entry.cursor.position();
+    }
+
+    return QVariant();
+}
+
+QHash<int, QByteArray> DiagnosticsModel::roleNames() const
+{
+    QHash<int, QByteArray> roles;
+    roles[LineRole] = "line";
+    roles[ColumnRole] = "column";
+    roles[MessageRole] = "message";
+    roles[PositionRole] = "position";
+    return roles;
+}
+
+void DiagnosticsModel::onContentsEdited()
+{
+    // whatever is queued or compiling describes an older text now
+    m_generation.fetchAndAddOrdered(1);
+
+    // a new file is coming in
+    if (m_buffer && m_buffer->loading())
+        setEntries(QVector<Entry>());
+
+    if (m_buffer && !m_buffer->loading() && !m_fileUrl.isEmpty())
+        m_timer.start();
+    else
+        m_timer.stop();
+}
+
+void DiagnosticsModel::check()
+{
+    if (!m_buffer || m_buffer->loading() || m_fileUrl.isEmpty())
+        return;
+
+    const QString text = m_buffer->text();
+    const QByteArray imports = importSection(text);
+    const bool cacheStale = (imports != m_imports) || m_cacheStale;
+    m_imports = imports;
+    m_cacheStale = false;
+
+    QStringList importPaths;
+    QQmlEngine *engine = qmlEngine(this);
+    if (engine)
+        importPaths = engine->importPathList();
+
+    const int generation = m_generation.fetchAndAddOrdered(1) + 1;
+    const QByteArray data = text.toUtf8();
+    const QUrl url = m_fileUrl;
+
+    if (!m_thread->isRunning())
+        m_thread->start(QThread::LowPriority);
+
+    QMetaObject::invokeMethod(m_worker, [=]() {
+        compile(generation, data, url, importPaths, cacheStale);
+    }, Qt::QueuedConnection);
+}
+
+// Runs in m_thread
+void DiagnosticsModel::compile(int generation, const QByteArray &data, const QUrl &url,
+                               const QStringList &importPaths, bool cacheStale)
+{
+    if (!m_engine)
+    {
+        m_engine = new QQmlEngine(m_worker);
+        m_engine->setImportPathList(importPaths);
+    }
+    else if (cacheStale)
+    {
+        // done even for a stale run, the next one expects it
+        m_engine->clearComponentCache();
+    }
+
+    if (generation != m_generation.loadAcquire())
+        return;
+
+    QQmlComponent *component = new QQmlComponent(m_engine, m_worker);
+
+    auto finish = [this, component, generation, url]() {
+        if (component->isLoading())
+            return;
+
+        QVector<Diagnostic> diagnostics;
+        foreach (const QQmlError &error, component->errors()) {
+            // errors inside the files it imports are reported on the first line
+            if (error.url() == url || error.url().isEmpty())
+                diagnostics += Diagnostic { error.line(), error.column(), error.description() };
+            else
+                diagnostics += Diagnostic { 1, 1, error.toString() };
+        }
+        component->deleteLater();
+
+        QMetaObject::invokeMethod(this, [this, generation, diagnostics]() {
+            handleResult(generation, diagnostics);
+        }, Qt::QueuedConnection);
+    };
+
+    // compiles right away unless an import has to be fetched
+    component->setData(data, url);
+    if (component->isLoading())
+        QObject::connect(component, &QQmlComponent::statusChanged, m_worker, finish);
+    else
+        finish();
+}
+
+void DiagnosticsModel::handleResult(int generation, const QVector<Diagnostic> &diagnostics)
+{
+    if (generation != m_generation.loadAcquire() || !m_buffer || !m_buffer->textDocument())
+        return;
+
+    QTextDocument *document = m_buffer->textDocument();
+
+    QVector<Entry> entries;
+    foreach (const Diagnostic &diagnostic, diagnostics) {
+        QTextBlock block = document->findBlockByNumber(qMax(0, diagnostic.line - 1));
+        if (!block.isValid())
+            block = document->lastBlock();
+
+        Entry entry;
+        entry.cursor = QTextCursor(document);
+        entry.cursor.setPosition(block.position() + qBound(0, diagnostic.column - 1, block.length() - 1));
+        entry.message = diagnostic.message;
+        entries += entry;
+    }
+
+    setEntries(entries);
+}
+
+void DiagnosticsModel::setEntries(const QVector<Entry> &entries)
+{
+    if (m_entries.isEmpty() && entries.isEmpty())
+        return;
+
+    beginResetModel();
+    setErrorColumns(m_entries, false);
+    m_entries = entries;
+    setErrorColumns(m_entries, true);
+    endResetModel();
+
+    emit diagnosticsChanged();
+}
+
+void DiagnosticsModel::setErrorColumns(const QVector<Entry> &entries, bool set)
+{
+    QMLHighlighter *highlighter = m_highlighter ? m_highlighter->highlighter() : nullptr;
+
+    foreach (const Entry &entry, entries) {
+        const QTextBlock block = entry.cursor.block();
+        BlockData *data = BracketIndex::blockData(block);
+        if (!data)
+            continue;
+
+        if (set)
+            data->errorColumns += entry.cursor.positionInBlock();
+        else
+            data->errorColumns.clear();
+
+        if (highlighter)
+            highlighter->rehighlightBlock(block);
+    }
+}
+
+QByteArray DiagnosticsModel::importSection(const QString &text)
+{
+    QByteArray imports;
+    foreach (const QStringRef &line, text.splitRef('\n')) {
+        const QStringRef trimmed = line.trimmed();
+        if (trimmed.startsWith(QLatin1String("import ")) || trimmed.startsWith(QLatin1String("pragma ")))
+            imports += trimmed.toUtf8() + '\n';
+    }
+
+    return imports;
+}
@@ -0,0 +1,122 @@
+#ifndef DIAGNOSTICSMODEL_H
+#define DIAGNOSTICSMODEL_H
+
+#include <QAbstractListModel>
+#include <QAtomicInt>
+#include <QTextCursor>
+#include <QTimer>
+#include <QUrl>
+#include <QVector>
+#include "SyntaxHighlighter.h"
+#include "TextBuffer.h"
+
+class QQmlEngine;
+class QThread;
+
+struct Diagnostic
+{
+    int line;       // 1-based, as QQmlError reports them
+    int column;
+    QString message;
+};
+
+// Compile errors of the edited QML file, found while typing. A short
+// while after the last edit the buffer is compiled with QQmlComponent::setData
+// on a private engine in a worker thread; nothing is ever instantiated.
+// Only the newest request is compiled, runs that went stale while queued
+// are dropped and late results are ignored. The engine lives as long as
+// the model, so imported modules are resolved once. Its component cache
+// is cleared when the file's imports change and after clearCache, for
+// the project's files it compiled along with the edited one.
+// The errors are anchored to the document with QTextCursors and shown
+// through the highlighter as squiggles (see BlockData::errorColumns).
+class DiagnosticsModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+    Q_PROPERTY(TextBuffer* buffer READ buffer WRITE setBuffer NOTIFY bufferChanged)
+    Q_PROPERTY(SyntaxHighlighter* highlighter READ highlighter WRITE setHighlighter NOTIFY highlighterChanged)
+    // an empty url turns the checks off
+    Q_PROPERTY(QUrl fileUrl READ fileUrl WRITE setFileUrl NOTIFY fileUrlChanged)
+    Q_PROPERTY(int delay READ delay WRITE setDelay NOTIFY delayChanged)
+    Q_PROPERTY(int count READ count NOTIFY diagnosticsChanged)
+
+public:
+    enum Roles {
+        LineRole = Qt::UserRole + 1,
+        ColumnRole,
+        MessageRole,
+        PositionRole
+    };
+
+    explicit DiagnosticsModel(QObject *parent = nullptr);
+    ~DiagnosticsModel();
+
+    TextBuffer *buffer() const;
+    void setBuffer(TextBuffer *buffer);
+
+    SyntaxHighlighter *highlighter() const;
+    void setHighlighter(SyntaxHighlighter *highlighter);
+
+    QUrl fileUrl() const;
+    void setFileUrl(const QUrl &fileUrl);
+
+    int delay() const;
+    void setDelay(int delay);
+
+    int count() const;
+
+    // both take a block number, the gutter's line index
+    Q_INVOKABLE bool hasDiagnostic(int lineIndex) const;
+    // first message for the line holding position, empty if there is none
+    Q_INVOKABLE QString messageAt(int position) const;
+    // files the edited one uses were saved or replaced, the next check
+    // compiles them again; it is run right away
+    Q_INVOKABLE void clearCache();
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+private slots:
+    void onContentsEdited();
+    void check();
+
+private:
+    struct Entry
+    {
+        QTextCursor cursor;
+        QString message;
+    };
+
+    void compile(int generation, const QByteArray &data, const QUrl &url,
+                 const QStringList &importPaths, bool cacheStale);
+    void handleResult(int generation, const QVector<Diagnostic> &diagnostics);
+    void setEntries(const QVector<Entry> &entries);
+    void setErrorColumns(const QVector<Entry> &entries, bool set);
+    static QByteArray importSection(const QString &text);
+
+    TextBuffer *m_buffer = nullptr;
+    SyntaxHighlighter *m_highlighter = nullptr;
+    QUrl m_fileUrl;
+    QTimer m_timer;
+    QVector<Entry> m_entries;
+
+    // newest request, read by the worker to skip stale runs
+    QAtomicInt m_generation;
+    QByteArray m_imports;
+    bool m_cacheStale = false;
+
+    QThread *m_thread;
+    QObject *m_worker;
+    QQmlEngine *m_engine = nullptr;     // created and used in m_thread only
+
+signals:
+    void bufferChanged();
+    void highlighterChanged();
+    void fileUrlChanged();
+    void delayChanged();
+    void diagnosticsChanged();
+};
+
+#endif // DIAGNOSTICSMODEL_H
@@ -0,0 +1,262 @@
+#include "DocumentManager.h"
+#include "TextBuffer.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QFileInfo>
+#include <QTextDocument>
+
+static const quint32 SnapshotMagic = 0x51434453; // "QCDS"
+
+// Rough per character cost of a live editor: the document text, its block
+// layouts and formats and the highlighter's BlockData
+static const int LiveBytesPerCharacter = 16;
+
+DocumentManager::DocumentManager(QObject *parent) : QObject(parent)
+{
+
+}
+
+int DocumentManager::maximumOpen() const
+{
+    return m_maximumOpen;
+}
+
+void DocumentManager::setMaximumOpen(int count)
+{
+    count = qMax(1, count);
+    if (m_maximumOpen == count)
+        return;
+
+    m_maximumOpen = count;
+    evict();
+    emit maximumOpenChanged();
+    emit memoryUsageChanged();
+}
+
+int DocumentManager::memoryLimit() const
+{
+    return m_memoryLimit;
+}
+
+void DocumentManager::setMemoryLimit(int bytes)
+{
+    if (m_memoryLimit == bytes)
+        return;
+
+    m_memoryLimit = bytes;
+    evict();
+    emit memoryLimitChanged();
+    emit memoryUsageChanged();
+}
+
+int DocumentManager::memoryUsage() const
+{
+    int usage = 0;
+    foreach (const Entry &entry, m_entries) {
+        if (entry.editor)
+            usage += liveCost(entry.editor);
+        else
+            usage += entry.snapshot.size();
+    }
+
+    return usage;
+}
+
+QObject *DocumentManager::editor(const QString &filePath)
+{
+    const int index = indexOf(filePath);
+    if (index < 0 || !m_entries.at(index).editor)
+        return nullptr;
+
+    // the editor would show, and save back, what the file was before
+    if (changedOnDisk(m_entries.at(index)))
+    {
+        discard(m_entries.takeAt(index).editor);
+        emit memoryUsageChanged();
+        return nullptr;
+    }
+
+    m_entries.move(index, 0);
+    return m_entries.first().editor;
+}
+
+void DocumentManager::insert(const QString &filePath, QObject *editor)
+{
+    Entry entry;
+    const int index = indexOf(filePath);
+    if (index >= 0)
+        entry = m_entries.takeAt(index);
+
+    if (entry.editor && entry.editor != editor)
+        discard(entry.editor);
+
+    entry.filePath = filePath;
+    entry.editor = editor;
+    m_entries.prepend(entry);
+
+    evict();
+    emit memoryUsageChanged();
+}
+
+bool DocumentManager::restore(const QString &filePath, QObject *editor)
+{
+    const int index = indexOf(filePath);
+    if (index < 0 || m_entries.at(index).snapshot.isEmpty())
+        return false;
+
+    // used up either way
+    Entry &entry = m_entries[index];
+    const QByteArray snapshot = entry.snapshot;
+    entry.snapshot.clear();
+    emit memoryUsageChanged();
+
+    if (changedOnDisk(entry))
+        return false;
+
+    TextBuffer *buffer = bufferOf(editor);
+    if (!buffer)
+        return false;
+
+    const QByteArray data = qUncompress(snapshot);
+    QDataStream stream(data);
+    quint32 magic = 0;
+    QString text;
+    qint32 cursorPosition = 0;
+    qreal scrollPosition = 0;
+    stream >> magic >> text >> cursorPosition >> scrollPosition;
+    if (magic != SnapshotMagic || stream.status() != QDataStream::Ok)
+    {
+        qWarning() << "Corrupted editor snapshot" << filePath;
+        return false;
+    }
+
+    buffer->loadText(text, &stream);
+    editor->setProperty("cursorPosition", cursorPosition);
+    editor->setProperty("scrollPosition", scrollPosition);
+    return true;
+}
+
+void DocumentManager::synced(const QString &filePath)
+{
+    const int index = indexOf(filePath);
+    if (index < 0)
+        return;
+
+    const QFileInfo fileInfo(filePath);
+    m_entries[index].modified = fileInfo.lastModified();
+    m_entries[index].size = fileInfo.size();
+}
+
+void DocumentManager::remove(const QString &path)
+{
+    const QString prefix = path + '/';
+    bool removed = false;
+    for (int i = 0; i < m_entries.count(); i++)
+    {
+        const QString &filePath = m_entries.at(i).filePath;
+        if (filePath != path && !filePath.startsWith(prefix))
+            continue;
+
+        const Entry entry = m_entries.takeAt(i--);
+        if (entry.editor)
+            discard(entry.editor);
+        removed = true;
+    }
+
+    if (removed)
+        emit memoryUsageChanged();
+}
+
+int DocumentManager::indexOf(const QString &filePath) const
+{
+    for (int i = 0; i < m_entries.count(); i++)
+    {
+        if (m_entries.at(i).filePath == filePath)
+            return i;
+    }
+
+    return -1;
+}
+
+bool DocumentManager::changedOnDisk(const Entry &entry)
+{
+    const QFileInfo fileInfo(entry.filePath);
+    return fileInfo.lastModified() != entry.modified || fileInfo.size() != entry.size;
+}
+
+// An editor still on the stack goes when it is popped, not saving the
+// file that changed under it
+void DocumentManager::discard(QObject *editor)
+{
+    if (!editor)
+        return;
+    if (!QMetaObject::invokeMethod(editor, "discard"))
+        editor->deleteLater();
+}
+
+// Walks from the most to the least recently used entry, whatever no
+// longer fits is snapshotted, snapshots that do not fit are dropped. The
+// most recent editor is always kept.
+void DocumentManager::evict()
+{
+    int live = 0;
+    int usage = 0;
+
+    for (int i = 0; i < m_entries.count(); i++)
+    {
+        Entry &entry = m_entries[i];
+        if (entry.editor)
+        {
+            const int cost = liveCost(entry.editor);
+            if (i == 0 || (live < m_maximumOpen && usage + cost <= m_memoryLimit))
+            {
+                live++;
+                usage += cost;
+                continue;
+            }
+
+            takeSnapshot(entry);
+            entry.editor->deleteLater();
+            entry.editor.clear();
+        }
+
+        if (entry.snapshot.isEmpty() || usage + entry.snapshot.size() > m_memoryLimit)
+        {
+            m_entries.removeAt(i--);
+            continue;
+        }
+
+        usage += entry.snapshot.size();
+    }
+}
+
+void DocumentManager::takeSnapshot(Entry &entry) const
+{
+    TextBuffer *buffer = bufferOf(entry.editor);
+    if (!buffer)
+        return;
+
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream << SnapshotMagic << buffer->text()
+           << qint32(entry.editor->property("cursorPosition").toInt())
+           << qreal(entry.editor->property("scrollPosition").toReal());
+    buffer->history()->write(stream);
+
+    entry.snapshot = qCompress(data);
+}
+
+TextBuffer *DocumentManager::bufferOf(QObject *editor)
+{
+    return editor ? qobject_cast<TextBuffer *>(editor->property("buffer").value<QObject *>()) : nullptr;
+}
+
+int DocumentManager::liveCost(QObject *editor)
+{
+    TextBuffer *buffer = bufferOf(editor);
+    if (!buffer || !buffer->textDocument())
+        return 0;
+
+    return buffer->textDocument()->characterCount() * LiveBytesPerCharacter + buffer->history()->memoryUsage();
+}
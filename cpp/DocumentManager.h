@@ -0,0 +1,82 @@
+#ifndef DOCUMENTMANAGER_H
+#define DOCUMENTMANAGER_H
+
+#include <QObject>
+#include <QDateTime>
+#include <QList>
+#include <QPointer>
+
+class TextBuffer;
+
+// Editors of the recently opened files, most recently used first. Live
+// editors keep their document, highlighting, undo history, cursor and
+// scroll position, so switching back to one is only a push on the stack.
+// Past maximumOpen editors, or over memoryLimit, the least recently used
+// ones are evicted: their state is kept as a compressed snapshot (text,
+// edit history, cursor and scroll position) and the editor is destroyed.
+// Reopening such a file restores the snapshot instead of reading the file,
+// only the highlighting has to be redone. Editors and snapshots of a file
+// that changed on disk since are dropped, the file is read again.
+//
+// Editors handed in need a "buffer" (TextBuffer), a "cursorPosition" and
+// a "scrollPosition" property, and a discard() method that destroys the
+// editor without saving it, once it is off the screen.
+class DocumentManager : public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY(int maximumOpen READ maximumOpen WRITE setMaximumOpen NOTIFY maximumOpenChanged)
+    Q_PROPERTY(int memoryLimit READ memoryLimit WRITE setMemoryLimit NOTIFY memoryLimitChanged)
+    Q_PROPERTY(int memoryUsage READ memoryUsage NOTIFY memoryUsageChanged)
+
+public:
+    explicit DocumentManager(QObject *parent = nullptr);
+
+    int maximumOpen() const;
+    void setMaximumOpen(int count);
+
+    int memoryLimit() const;
+    void setMemoryLimit(int bytes);
+    int memoryUsage() const;
+
+    // live editor of filePath, marked as the most recently used one
+    Q_INVOKABLE QObject *editor(const QString &filePath);
+    Q_INVOKABLE void insert(const QString &filePath, QObject *editor);
+    // the editor of filePath has just loaded or saved it
+    Q_INVOKABLE void synced(const QString &filePath);
+    // loads the snapshot of filePath into editor, false if there is none
+    // or the file was changed since
+    Q_INVOKABLE bool restore(const QString &filePath, QObject *editor);
+    // forgets path and the files below it, e.g. after they were deleted
+    Q_INVOKABLE void remove(const QString &path);
+
+private:
+    struct Entry
+    {
+        QString filePath;
+        QPointer<QObject> editor;
+        QByteArray snapshot;
+        // of the file when the editor last loaded or saved it
+        QDateTime modified;
+        qint64 size = -1;
+    };
+
+    int indexOf(const QString &filePath) const;
+    static bool changedOnDisk(const Entry &entry);
+    static void discard(QObject *editor);
+    void evict();
+    void takeSnapshot(Entry &entry) const;
+    static TextBuffer *bufferOf(QObject *editor);
+    static int liveCost(QObject *editor);
+
+    QList<Entry> m_entries;
+    int m_maximumOpen = 4;
+    int m_memoryLimit = 16 * 1024 * 1024;
+
+signals:
+    void maximumOpenChanged();
+    void memoryLimitChanged();
+    void memoryUsageChanged();
+};
+
+#endif // DOCUMENTMANAGER_H
@@ -0,0 +1,472 @@
+#include "EditHistory.h"
+#include "TextBuffer.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QTextCursor>
+#include <QTextDocument>
+
+// Size of one arena block in characters
+static const int ArenaBlockSize = 16 * 1024;
+
+// Keystrokes further apart than this never end up in the same group
+static const qint64 GroupTimeout = 1000;
+
+static const int DefaultMemoryLimit = 4 * 1024 * 1024;
+
+static const quint32 HistoryFileMagic = 0x51434548;
+static const quint32 HistoryFileVersion = 1;
+
+static bool isWordCharacter(QChar ch)
+{
+    return ch.isLetterOrNumber() || ch == '_';
+}
+
+EditHistory::EditHistory(TextBuffer *buffer) : QObject(buffer),
+    m_buffer(buffer),
+    m_firstBlock(0),
+    m_arenaBytes(0),
+    m_recordCount(0),
+    m_undoIndex(0),
+    m_groupOpen(false),
+    m_continueGroup(false),
+    m_applying(false),
+    m_lastKind(Insertion),
+    m_memoryLimit(DefaultMemoryLimit),
+    m_persistent(false)
+{
+    m_clock.start();
+}
+
+void EditHistory::undo()
+{
+    if (!canUndo())
+        return;
+
+    m_groupOpen = false;
+    m_undoIndex--;
+    apply(m_groups.at(m_undoIndex), false);
+    emit changed();
+}
+
+void EditHistory::redo()
+{
+    if (!canRedo())
+        return;
+
+    m_groupOpen = false;
+    apply(m_groups.at(m_undoIndex), true);
+    m_undoIndex++;
+    emit changed();
+}
+
+void EditHistory::clear()
+{
+    m_groups.clear();
+    m_blocks.clear();
+    m_firstBlock = 0;
+    m_arenaBytes = 0;
+    m_recordCount = 0;
+    m_undoIndex = 0;
+    m_groupOpen = false;
+    m_continueGroup = false;
+    emit changed();
+}
+
+void EditHistory::continueGroup()
+{
+    m_continueGroup = true;
+}
+
+bool EditHistory::canUndo() const
+{
+    return m_undoIndex > 0;
+}
+
+bool EditHistory::canRedo() const
+{
+    return m_undoIndex < m_groups.count();
+}
+
+int EditHistory::memoryLimit() const
+{
+    return m_memoryLimit;
+}
+
+void EditHistory::setMemoryLimit(int bytes)
+{
+    if (m_memoryLimit == bytes)
+        return;
+
+    m_memoryLimit = bytes;
+    evict();
+    emit memoryLimitChanged();
+}
+
+int EditHistory::memoryUsage() const
+{
+    return m_arenaBytes + m_groups.count() * int(sizeof(Group)) + m_recordCount * int(sizeof(Record));
+}
+
+bool EditHistory::persistent() const
+{
+    return m_persistent;
+}
+
+void EditHistory::setPersistent(bool persistent)
+{
+    if (m_persistent == persistent)
+        return;
+
+    m_persistent = persistent;
+    emit persistentChanged();
+}
+
+bool EditHistory::isApplying() const
+{
+    return m_applying;
+}
+
+void EditHistory::record(int position, const QString &removed, const QString &added)
+{
+    if (m_applying || (removed.isEmpty() && added.isEmpty()))
+        return;
+
+    truncateRedo();
+
+    const EditKind kind = removed.isEmpty() ? Insertion : (added.isEmpty() ? Removal : Replacement);
+
+    if (startsNewGroup(position, removed, added))
+    {
+        Group group;
+        group.timestamp = m_clock.elapsed();
+        m_groups.append(group);
+        m_undoIndex = m_groups.count();
+    }
+
+    Group &group = m_groups.last();
+    group.timestamp = m_clock.elapsed();
+
+    // typing right behind the previous insertion only grows its text
+    Record *last = group.records.isEmpty() ? nullptr : &group.records.last();
+    const bool grows = kind == Insertion && last && last->removed.length == 0
+            && position == last->position + last->added.length;
+
+    if (!grows || !extend(last->added, added))
+    {
+        Record record;
+        record.position = position;
+        record.removed = store(removed);
+        record.added = store(added);
+        group.records.append(record);
+        m_recordCount++;
+    }
+
+    // pastes and other bulk edits stay a group of their own
+    m_groupOpen = kind != Replacement && removed.length() <= 1 && added.length() <= 1;
+    m_continueGroup = false;
+    m_lastKind = kind;
+
+    evict();
+    emit changed();
+}
+
+bool EditHistory::startsNewGroup(int position, const QString &removed, const QString &added) const
+{
+    if (m_groups.isEmpty())
+        return true;
+
+    if (m_continueGroup)
+        return false;
+
+    if (!m_groupOpen || m_clock.elapsed() - m_groups.last().timestamp > GroupTimeout)
+        return true;
+
+    const Record &last = m_groups.last().records.last();
+
+    if (!removed.isEmpty() && added.isEmpty())
+    {
+        // backspace removes right before, delete right at the previous removal
+        return m_lastKind != Removal
+                || (position + removed.length() != last.position && position != last.position);
+    }
+
+    if (m_lastKind != Insertion || position != last.position + last.added.length)
+        return true;
+
+    // a word starts a new group once the previous one was followed by a separator
+    const QChar previous = m_blocks.at(last.added.block - m_firstBlock).at(last.added.offset + last.added.length - 1);
+    return !isWordCharacter(previous) && isWordCharacter(added.at(0));
+}
+
+void EditHistory::truncateRedo()
+{
+    if (!canRedo())
+        return;
+
+    // redo groups hold the newest text in the arena, hand that space back
+    TextRef earliest;
+    const Group &group = m_groups.at(m_undoIndex);
+    foreach (const Record &record, group.records)
+    {
+        if (record.removed.length > 0 || record.added.length > 0)
+        {
+            earliest = (record.removed.length > 0) ? record.removed : record.added;
+            break;
+        }
+    }
+
+    while (m_groups.count() > m_undoIndex)
+    {
+        m_recordCount -= m_groups.last().records.count();
+        m_groups.removeLast();
+    }
+
+    if (earliest.block >= 0)
+        rewindTo(earliest);
+
+    m_groupOpen = false;
+}
+
+void EditHistory::evict()
+{
+    // most of the usage is arena blocks, hand back the ones the evicted
+    // group was the last to use before checking again
+    while (m_undoIndex > 1 && memoryUsage() > m_memoryLimit)
+    {
+        m_recordCount -= m_groups.first().records.count();
+        m_groups.removeFirst();
+        m_undoIndex--;
+        releaseUnreferencedBlocks();
+    }
+}
+
+void EditHistory::apply(const Group &group, bool forward)
+{
+    QTextDocument *document = m_buffer->textDocument();
+    if (!document)
+        return;
+
+    QTextCursor cursor(document);
+    int cursorPosition = 0;
+
+    m_applying = true;
+    cursor.beginEditBlock();
+
+    const int count = group.records.count();
+    for (int i = 0; i < count; i++)
+    {
+        const Record &record = group.records.at(forward ? i : count - 1 - i);
+        const TextRef &from = forward ? record.removed : record.added;
+        const TextRef &to = forward ? record.added : record.removed;
+
+        cursor.setPosition(record.position);
+        cursor.setPosition(record.position + from.length, QTextCursor::KeepAnchor);
+        if (to.length > 0)
+            cursor.insertText(text(to));
+        else
+            cursor.removeSelectedText();
+
+        cursorPosition = record.position + to.length;
+    }
+
+    cursor.endEditBlock();
+    m_applying = false;
+
+    emit cursorPositionRequested(cursorPosition);
+}
+
+EditHistory::TextRef EditHistory::store(const QString &text)
+{
+    TextRef ref;
+    if (text.isEmpty())
+        return ref;
+
+    if (m_blocks.isEmpty() || m_blocks.last().capacity() - m_blocks.last().length() < text.length())
+    {
+        QString block;
+        block.reserve(qMax(ArenaBlockSize, text.length()));
+        m_arenaBytes += block.capacity() * int(sizeof(QChar));
+        m_blocks.append(block);
+    }
+
+    QString &block = m_blocks.last();
+    ref.block = m_firstBlock + m_blocks.count() - 1;
+    ref.offset = block.length();
+    ref.length = text.length();
+    block.append(text);
+
+    return ref;
+}
+
+bool EditHistory::extend(TextRef &ref, const QString &text)
+{
+    if (ref.block != m_firstBlock + m_blocks.count() - 1)
+        return false;
+
+    QString &block = m_blocks.last();
+    if (ref.offset + ref.length != block.length() || block.capacity() - block.length() < text.length())
+        return false;
+
+    block.append(text);
+    ref.length += text.length();
+    return true;
+}
+
+QString EditHistory::text(const TextRef &ref) const
+{
+    if (ref.length == 0)
+        return QString();
+
+    return m_blocks.at(ref.block - m_firstBlock).mid(ref.offset, ref.length);
+}
+
+void EditHistory::rewindTo(const TextRef &ref)
+{
+    while (m_firstBlock + m_blocks.count() - 1 > ref.block)
+    {
+        m_arenaBytes -= m_blocks.last().capacity() * int(sizeof(QChar));
+        m_blocks.removeLast();
+    }
+
+    if (!m_blocks.isEmpty())
+        m_blocks.last().truncate(ref.offset);
+}
+
+void EditHistory::releaseUnreferencedBlocks()
+{
+    int firstUsed = m_firstBlock + m_blocks.count();
+    if (!m_groups.isEmpty())
+    {
+        foreach (const Record &record, m_groups.first().records)
+        {
+            if (record.removed.length > 0)
+                firstUsed = qMin(firstUsed, record.removed.block);
+            if (record.added.length > 0)
+                firstUsed = qMin(firstUsed, record.added.block);
+        }
+    }
+
+    while (m_firstBlock < firstUsed && !m_blocks.isEmpty())
+    {
+        m_arenaBytes -= m_blocks.first().capacity() * int(sizeof(QChar));
+        m_blocks.removeFirst();
+        m_firstBlock++;
+    }
+}
+
+QByteArray EditHistory::contentHash() const
+{
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    m_buffer->pieces().forEachChunk(0, m_buffer->length(), [&hash](const QChar *chunk, int length) {
+        hash.addData(reinterpret_cast<const char *>(chunk), length * int(sizeof(QChar)));
+        return true;
+    });
+    return hash.result();
+}
+
+QString EditHistory::historyFilePath(const QString &filePath)
+{
+    QFileInfo fileInfo(filePath);
+    return fileInfo.absolutePath() + "/." + fileInfo.fileName() + ".history";
+}
+
+bool EditHistory::save(const QString &filePath) const
+{
+    QSaveFile file(historyFilePath(filePath));
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        qWarning() << "Unable to write" << file.fileName();
+        return false;
+    }
+
+    QDataStream stream(&file);
+    write(stream);
+    return file.commit();
+}
+
+bool EditHistory::restore(const QString &filePath)
+{
+    clear();
+
+    QFile file(historyFilePath(filePath));
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream stream(&file);
+    if (read(stream))
+        return true;
+
+    if (stream.status() != QDataStream::Ok)
+        qWarning() << "Corrupted edit history" << file.fileName();
+    return false;
+}
+
+void EditHistory::write(QDataStream &stream) const
+{
+    stream << HistoryFileMagic << HistoryFileVersion << contentHash()
+           << qint32(m_undoIndex) << qint32(m_groups.count());
+
+    foreach (const Group &group, m_groups)
+    {
+        stream << qint32(group.records.count());
+        foreach (const Record &record, group.records)
+            stream << qint32(record.position) << text(record.removed) << text(record.added);
+    }
+}
+
+bool EditHistory::read(QDataStream &stream)
+{
+    clear();
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    QByteArray hash;
+    qint32 undoIndex = 0;
+    qint32 groupCount = 0;
+    stream >> magic >> version >> hash >> undoIndex >> groupCount;
+
+    // the file was changed outside of the editor, the history no longer applies
+    if (magic != HistoryFileMagic || version != HistoryFileVersion || hash != contentHash())
+        return false;
+
+    for (int i = 0; i < groupCount && stream.status() == QDataStream::Ok; i++)
+    {
+        Group group;
+        group.timestamp = 0;
+
+        qint32 recordCount = 0;
+        stream >> recordCount;
+        for (int j = 0; j < recordCount && stream.status() == QDataStream::Ok; j++)
+        {
+            qint32 position = 0;
+            QString removed;
+            QString added;
+            stream >> position >> removed >> added;
+
+            Record record;
+            record.position = position;
+            record.removed = store(removed);
+            record.added = store(added);
+            group.records.append(record);
+            m_recordCount++;
+        }
+
+        m_groups.append(group);
+    }
+
+    if (stream.status() != QDataStream::Ok)
+    {
+        clear();
+        return false;
+    }
+
+    m_undoIndex = qBound(0, int(undoIndex), m_groups.count());
+    evict();
+    emit changed();
+    return true;
+}
@@ -0,0 +1,119 @@
+#ifndef EDITHISTORY_H
+#define EDITHISTORY_H
+
+#include <QObject>
+#include <QDataStream>
+#include <QList>
+#include <QVector>
+#include <QElapsedTimer>
+
+class TextBuffer;
+
+// Undo/redo history of a TextBuffer. Keystrokes are coalesced into
+// word-sized groups, the text of every edit is stored in an append-only
+// arena of fixed-size blocks and the oldest groups are evicted once the
+// history grows past memoryLimit.
+class EditHistory : public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY(bool canUndo READ canUndo NOTIFY changed)
+    Q_PROPERTY(bool canRedo READ canRedo NOTIFY changed)
+    Q_PROPERTY(int memoryLimit READ memoryLimit WRITE setMemoryLimit NOTIFY memoryLimitChanged)
+    Q_PROPERTY(int memoryUsage READ memoryUsage NOTIFY changed)
+    Q_PROPERTY(bool persistent READ persistent WRITE setPersistent NOTIFY persistentChanged)
+
+public:
+    explicit EditHistory(TextBuffer *buffer);
+
+    Q_INVOKABLE void undo();
+    Q_INVOKABLE void redo();
+    Q_INVOKABLE void clear();
+    // the next edit joins the current group (used for auto-indentation)
+    Q_INVOKABLE void continueGroup();
+
+    bool canUndo() const;
+    bool canRedo() const;
+
+    int memoryLimit() const;
+    void setMemoryLimit(int bytes);
+    int memoryUsage() const;
+
+    bool persistent() const;
+    void setPersistent(bool persistent);
+
+    bool isApplying() const;
+    void record(int position, const QString &removed, const QString &added);
+
+    // history file next to the edited file, restored only when the file
+    // content still matches what the history was saved against
+    bool save(const QString &filePath) const;
+    bool restore(const QString &filePath);
+    static QString historyFilePath(const QString &filePath);
+
+    // the same format in memory, used for editor snapshots
+    void write(QDataStream &stream) const;
+    bool read(QDataStream &stream);
+
+private:
+    struct TextRef
+    {
+        int block = -1;
+        int offset = 0;
+        int length = 0;
+    };
+
+    struct Record
+    {
+        int position;
+        TextRef removed;
+        TextRef added;
+    };
+
+    struct Group
+    {
+        QVector<Record> records;
+        qint64 timestamp;
+    };
+
+    enum EditKind { Insertion, Removal, Replacement };
+
+    // arena
+    TextRef store(const QString &text);
+    bool extend(TextRef &ref, const QString &text);
+    QString text(const TextRef &ref) const;
+    void rewindTo(const TextRef &ref);
+    void releaseUnreferencedBlocks();
+
+    bool startsNewGroup(int position, const QString &removed, const QString &added) const;
+    void truncateRedo();
+    void evict();
+    QByteArray contentHash() const;
+    void apply(const Group &group, bool forward);
+
+    TextBuffer *m_buffer;
+
+    QList<QString> m_blocks;
+    int m_firstBlock;
+    int m_arenaBytes;
+    int m_recordCount;
+
+    QList<Group> m_groups;
+    int m_undoIndex;
+    bool m_groupOpen;
+    bool m_continueGroup;
+    bool m_applying;
+    EditKind m_lastKind;
+    QElapsedTimer m_clock;
+
+    int m_memoryLimit;
+    bool m_persistent;
+
+signals:
+    void changed();
+    void memoryLimitChanged();
+    void persistentChanged();
+    void cursorPositionRequested(int position);
+};
+
+#endif // EDITHISTORY_H
@@ -0,0 +1,396 @@
+#include "FileJobQueue.h"
+#include "ProjectArchive.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QMetaObject>
+#include <QtConcurrent>
+#include <functional>
+
+namespace {
+
+const QDir::Filters AllEntries = QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden | QDir::System;
+
+// Files a step handles, the unit of progress
+int countFiles(const FileJobQueue::Step &step)
+{
+    if (step.operation == FileJobQueue::Extract)
+        return ProjectArchive::chunkCount(step.source);
+
+    QFileInfo info(step.source);
+    if (!info.isDir() || step.operation == FileJobQueue::Move)
+        return 1;
+
+    int count = (step.operation == FileJobQueue::Remove) ? 1 : 0;
+    QDirIterator it(step.source, step.operation == FileJobQueue::Remove ? AllEntries : QDir::Files | QDir::Hidden | QDir::System,
+                    QDirIterator::Subdirectories);
+    while (it.hasNext())
+    {
+        it.next();
+        count++;
+    }
+    return count;
+}
+
+bool isParentOf(const QString &parent, const QString &path)
+{
+    return path.startsWith(parent) && path.length() > parent.length() && path.at(parent.length()) == QLatin1Char('/');
+}
+
+// step calls it after every file, false when the job is canceled
+typedef std::function<bool ()> Tick;
+
+bool removePath(const QString &path, const Tick &tick)
+{
+    QFileInfo info(path);
+    if (!info.exists() && !info.isSymLink())
+        return tick();
+    if (!info.isDir() || info.isSymLink())
+        return QFile::remove(path) && tick();
+
+    // the iterator yields a directory before its entries, so in reverse
+    // the directories come out empty
+    QStringList directories;
+    QDirIterator it(path, AllEntries, QDirIterator::Subdirectories);
+    while (it.hasNext())
+    {
+        it.next();
+        if (it.fileInfo().isDir() && !it.fileInfo().isSymLink())
+        {
+            directories += it.filePath();
+        }
+        else
+        {
+            if (!QFile::remove(it.filePath()))
+            {
+                qWarning() << "Unable to remove" << it.filePath();
+                return false;
+            }
+            if (!tick())
+                return false;
+        }
+    }
+
+    directories.prepend(path);
+    for (int i = directories.count() - 1; i >= 0; --i)
+    {
+        if (!QDir().rmdir(directories.at(i)))
+        {
+            qWarning() << "Unable to remove" << directories.at(i);
+            return false;
+        }
+        if (!tick())
+            return false;
+    }
+    return true;
+}
+
+bool copyFile(const QString &source, const QString &target)
+{
+    if (QFileInfo::exists(target))
+        QFile::remove(target);
+    if (!QFile::copy(source, target))
+    {
+        qWarning() << "Unable to copy" << source << "to" << target;
+        return false;
+    }
+
+    // files from the resources are read-only
+    return QFile::setPermissions(target, QFile::ReadOwner | QFile::WriteOwner |
+                                         QFile::ReadUser | QFile::WriteUser |
+                                         QFile::ReadGroup | QFile::WriteGroup |
+                                         QFile::ReadOther | QFile::WriteOther);
+}
+
+bool copyPath(const QString &source, const QString &target, const Tick &tick)
+{
+    if (!QFileInfo(source).isDir())
+        return copyFile(source, target) && tick();
+
+    if (!QDir().mkpath(target))
+    {
+        qWarning() << "Unable to create" << target;
+        return false;
+    }
+
+    const QDir sourceDir(source);
+    QDirIterator it(source, QDir::Dirs | QDir::Files | QDir::NoDotAndDotDot | QDir::Hidden | QDir::System,
+                    QDirIterator::Subdirectories);
+    while (it.hasNext())
+    {
+        it.next();
+        const QString targetPath = target + QLatin1Char('/') + sourceDir.relativeFilePath(it.filePath());
+        if (it.fileInfo().isDir())
+        {
+            if (!QDir().mkpath(targetPath))
+            {
+                qWarning() << "Unable to create" << targetPath;
+                return false;
+            }
+        }
+        else if (!copyFile(it.filePath(), targetPath) || !tick())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool movePath(const QString &source, const QString &target, const Tick &tick)
+{
+    if (QFileInfo::exists(target))
+    {
+        qWarning() << "Unable to move" << source << "to" << target << "which exists";
+        return false;
+    }
+
+    if (QDir().rename(source, target))
+        return tick();
+
+    // another file system, the target is removed again if the copy fails
+    static const Tick untimed = [] { return true; };
+    if (!copyPath(source, target, untimed))
+    {
+        removePath(target, untimed);
+        return false;
+    }
+    return removePath(source, untimed) && tick();
+}
+
+} // namespace
+
+FileJobQueue::FileJobQueue(QObject *parent) : QObject(parent)
+{
+    // the disk is the bottleneck, more threads only make them wait on each other
+    m_pool.setMaxThreadCount(2);
+}
+
+FileJobQueue::~FileJobQueue()
+{
+    cancelAll();
+    m_pool.waitForDone();
+}
+
+int FileJobQueue::enqueue(const QString &description, const QVector<Step> &steps)
+{
+    QSharedPointer<Job> job(new Job);
+    job->id = m_nextId++;
+    job->description = description;
+    job->steps = steps;
+    for (const Step &step : steps)
+    {
+        job->paths += QDir::cleanPath(step.source);
+        if (!step.target.isEmpty())
+            job->paths += QDir::cleanPath(step.target);
+    }
+
+    m_jobs += job;
+    schedule();
+    emit jobsChanged();
+    return job->id;
+}
+
+void FileJobQueue::cancel(int id)
+{
+    for (int i = 0; i < m_jobs.count(); ++i)
+    {
+        QSharedPointer<Job> job = m_jobs.at(i);
+        if (job->id != id)
+            continue;
+
+        if (job->running)
+        {
+            // the worker stops at the next file and reports back
+            job->canceled.storeRelaxed(1);
+        }
+        else
+        {
+            m_jobs.removeAt(i);
+            emit finished(id, false, true, job->description, QStringList());
+            schedule();
+            emit jobsChanged();
+        }
+        return;
+    }
+}
+
+void FileJobQueue::cancelAll()
+{
+    QList<int> ids;
+    for (const QSharedPointer<Job> &job : m_jobs)
+        ids += job->id;
+    for (int id : ids)
+        cancel(id);
+}
+
+int FileJobQueue::count() const
+{
+    return m_jobs.count();
+}
+
+qreal FileJobQueue::progress() const
+{
+    qint64 done = 0;
+    qint64 total = 0;
+    for (const QSharedPointer<Job> &job : m_jobs)
+    {
+        done += job->done;
+        total += job->total;
+    }
+    return (total > 0) ? qreal(done) / total : 0;
+}
+
+// Starts the queued jobs that overlap with no job queued before them
+void FileJobQueue::schedule()
+{
+    for (int i = 0; i < m_jobs.count(); ++i)
+    {
+        QSharedPointer<Job> job = m_jobs.at(i);
+        if (job->running)
+            continue;
+
+        bool blocked = false;
+        for (int j = 0; j < i && !blocked; ++j)
+            blocked = overlaps(*m_jobs.at(j), *job);
+        if (blocked)
+            continue;
+
+        job->running = true;
+        QtConcurrent::run(&m_pool, &FileJobQueue::run, job, this);
+        emit started(job->id);
+    }
+}
+
+bool FileJobQueue::overlaps(const Job &first, const Job &second)
+{
+    for (const QString &a : first.paths)
+    {
+        for (const QString &b : second.paths)
+        {
+            if (a == b || isParentOf(a, b) || isParentOf(b, a))
+                return true;
+        }
+    }
+    return false;
+}
+
+void FileJobQueue::onProgress(int id, int done, int total)
+{
+    for (const QSharedPointer<Job> &job : m_jobs)
+    {
+        if (job->id == id)
+        {
+            job->done = done;
+            job->total = total;
+            emit progressed(id, done, total);
+            emit jobsChanged();
+            return;
+        }
+    }
+}
+
+void FileJobQueue::onFinished(int id, bool succeeded)
+{
+    for (int i = 0; i < m_jobs.count(); ++i)
+    {
+        QSharedPointer<Job> job = m_jobs.at(i);
+        if (job->id != id)
+            continue;
+
+        // a directory's entries change with what is added to or removed
+        // from it, and a removed or replaced directory's own as well
+        QStringList directories;
+        for (const QString &path : job->paths)
+        {
+            const QString parent = QFileInfo(path).path();
+            if (!directories.contains(parent))
+                directories += parent;
+            if (!directories.contains(path))
+                directories += path;
+        }
+
+        m_jobs.removeAt(i);
+        emit finished(id, succeeded, job->canceled.loadRelaxed() != 0, job->description, directories);
+        schedule();
+        emit jobsChanged();
+        return;
+    }
+}
+
+// Runs in a pool thread, talks to the queue only through queued calls
+bool FileJobQueue::run(QSharedPointer<Job> job, FileJobQueue *queue)
+{
+    const int id = job->id;
+    int total = 0;
+    for (const Step &step : job->steps)
+        total += countFiles(step);
+
+    int done = 0;
+    int reported = -1;
+    auto report = [&]() {
+        // about a hundred updates per job are enough for a progress bar
+        const int percent = (total > 0) ? int(qint64(done) * 100 / total) : 100;
+        if (percent == reported)
+            return;
+        reported = percent;
+        const int doneNow = done;
+        QMetaObject::invokeMethod(queue, [queue, id, doneNow, total]() {
+            queue->onProgress(id, doneNow, total);
+        }, Qt::QueuedConnection);
+    };
+    const Tick tick = [&]() {
+        done++;
+        report();
+        return job->canceled.loadRelaxed() == 0;
+    };
+
+    report();
+    bool succeeded = true;
+    for (const Step &step : job->steps)
+    {
+        if (job->canceled.loadRelaxed() != 0)
+        {
+            succeeded = false;
+            break;
+        }
+
+        switch (step.operation)
+        {
+        case Remove:
+            succeeded = removePath(step.source, tick);
+            break;
+        case Copy:
+            // never into what is there, so no half copies are left behind
+            if (QFileInfo::exists(step.target))
+            {
+                qWarning() << "Unable to copy" << step.source << "to" << step.target << "which exists";
+                succeeded = false;
+                break;
+            }
+            succeeded = copyPath(step.source, step.target, tick);
+            if (!succeeded)
+                removePath(step.target, [] { return true; });
+            break;
+        case Move:
+            succeeded = movePath(step.source, step.target, tick);
+            break;
+        case Archive:
+            succeeded = ProjectArchive::write(step.source, step.target, tick);
+            break;
+        case Extract:
+            succeeded = ProjectArchive::extract(step.source, step.target, tick);
+            break;
+        }
+
+        if (!succeeded)
+            break;
+    }
+
+    QMetaObject::invokeMethod(queue, [queue, id, succeeded]() {
+        queue->onFinished(id, succeeded);
+    }, Qt::QueuedConnection);
+    return succeeded;
+}
@@ -0,0 +1,85 @@
+#ifndef FILEJOBQUEUE_H
+#define FILEJOBQUEUE_H
+
+#include <QAtomicInt>
+#include <QList>
+#include <QObject>
+#include <QSharedPointer>
+#include <QStringList>
+#include <QThreadPool>
+#include <QVector>
+
+// Bulk file operations of ProjectManager, run on a small thread pool so
+// deleting or copying a big project does not block the GUI. A job is a
+// list of steps run in order on one worker; jobs whose paths overlap run
+// one after the other in the order they were queued, the others side by
+// side. Workers report progress in files, check for cancellation between
+// files, and a canceled or failed copy removes what it had copied.
+class FileJobQueue : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Operation {
+        Remove,     // source, recursively
+        Copy,       // source to target, recursively, which must not exist
+        Move,       // source to target, a rename unless they are on different file systems
+        Archive,    // source directory to the target archive (see ProjectArchive)
+        Extract     // source archive to the target directory, which must not exist
+    };
+
+    struct Step
+    {
+        Operation operation;
+        QString source;
+        QString target;
+    };
+
+    explicit FileJobQueue(QObject *parent = nullptr);
+    ~FileJobQueue();
+
+    // returns the job's id, description is for messages ("delete \"name\"")
+    int enqueue(const QString &description, const QVector<Step> &steps);
+    void cancel(int id);
+    void cancelAll();
+
+    // queued and running jobs
+    int count() const;
+    // done of all files the running jobs handle, from 0 to 1
+    qreal progress() const;
+
+private:
+    struct Job
+    {
+        int id = 0;
+        QString description;
+        QVector<Step> steps;
+        QStringList paths;          // of all steps, cleaned
+        QAtomicInt canceled;
+        bool running = false;
+        int done = 0;
+        int total = 0;
+    };
+
+    void schedule();
+    static bool overlaps(const Job &first, const Job &second);
+    void onProgress(int id, int done, int total);
+    void onFinished(int id, bool succeeded);
+
+    // run on a worker
+    static bool run(QSharedPointer<Job> job, FileJobQueue *queue);
+
+    QThreadPool m_pool;
+    QList<QSharedPointer<Job>> m_jobs;
+    int m_nextId = 1;
+
+signals:
+    void jobsChanged();
+    void started(int id);
+    void progressed(int id, int done, int total);
+    // changedDirectories are the ones whose entries may differ now
+    void finished(int id, bool succeeded, bool canceled, const QString &description,
+                  const QStringList &changedDirectories);
+};
+
+#endif // FILEJOBQUEUE_H
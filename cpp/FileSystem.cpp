@@ -0,0 +1,363 @@
+#include "FileSystem.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStringList>
+#include <algorithm>
+
+// "a/b" of "a/b/c", "" of "a"
+static QString parentPath(const QString &path)
+{
+    const int slash = path.lastIndexOf(QLatin1Char('/'));
+    return (slash < 0) ? QString() : path.left(slash);
+}
+
+FileSystem::~FileSystem()
+{
+
+}
+
+bool FileSystem::isReadOnly() const
+{
+    return false;
+}
+
+bool FileSystem::isLocal() const
+{
+    return true;
+}
+
+bool FileSystem::copy(const FileSystem &from, const QString &fromPath, FileSystem &to, const QString &toPath)
+{
+    if (!from.isDir(fromPath))
+    {
+        bool read = false;
+        const QByteArray data = from.read(fromPath, &read);
+        return read && to.write(toPath, data);
+    }
+
+    if (!to.makePath(toPath))
+        return false;
+
+    for (const Entry &entry : from.entries(fromPath))
+    {
+        if (!copy(from, joinPath(fromPath, entry.name), to, joinPath(toPath, entry.name)))
+            return false;
+    }
+    return true;
+}
+
+QString FileSystem::cleanPath(const QString &path)
+{
+    QString clean = QDir::cleanPath(path);
+    while (clean.startsWith(QLatin1Char('/')))
+        clean.remove(0, 1);
+    return (clean == QLatin1String(".")) ? QString() : clean;
+}
+
+bool FileSystem::isBelowRoot(const QString &path)
+{
+    const QString clean = cleanPath(path);
+    return !clean.isEmpty() && clean != QLatin1String("..") && !clean.startsWith(QLatin1String("../"));
+}
+
+QString FileSystem::joinPath(const QString &first, const QString &second)
+{
+    return cleanPath(first + QLatin1Char('/') + second);
+}
+
+DiskFileSystem::DiskFileSystem(const QString &rootPath) :
+    m_rootPath(QDir::cleanPath(rootPath))
+{
+
+}
+
+QString DiskFileSystem::filePath(const QString &path) const
+{
+    const QString relativePath = cleanPath(path);
+    return relativePath.isEmpty() ? m_rootPath : m_rootPath + QLatin1Char('/') + relativePath;
+}
+
+QUrl DiskFileSystem::url(const QString &path) const
+{
+    return QUrl::fromLocalFile(filePath(path));
+}
+
+bool DiskFileSystem::exists(const QString &path) const
+{
+    return QFileInfo::exists(filePath(path));
+}
+
+bool DiskFileSystem::isDir(const QString &path) const
+{
+    return QFileInfo(filePath(path)).isDir();
+}
+
+qint64 DiskFileSystem::size(const QString &path) const
+{
+    return QFileInfo(filePath(path)).size();
+}
+
+QVector<FileSystem::Entry> DiskFileSystem::entries(const QString &dirPath) const
+{
+    QVector<Entry> entries;
+    const QFileInfoList infos = QDir(filePath(dirPath)).entryInfoList(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot,
+                                                                      QDir::Name | QDir::IgnoreCase);
+    for (const QFileInfo &info : infos)
+        entries += Entry { info.fileName(), info.isDir() };
+    return entries;
+}
+
+QByteArray DiskFileSystem::read(const QString &path, bool *ok) const
+{
+    QFile file(filePath(path));
+    const bool opened = file.open(QIODevice::ReadOnly);
+    if (!opened)
+        qWarning() << "Unable to open" << file.fileName();
+    if (ok)
+        *ok = opened;
+    return opened ? file.readAll() : QByteArray();
+}
+
+bool DiskFileSystem::write(const QString &path, const QByteArray &data)
+{
+    QSaveFile file(filePath(path));
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit())
+    {
+        qWarning() << "Unable to write" << file.fileName();
+        return false;
+    }
+    return true;
+}
+
+bool DiskFileSystem::makePath(const QString &dirPath)
+{
+    return QDir().mkpath(filePath(dirPath));
+}
+
+bool DiskFileSystem::remove(const QString &path)
+{
+    if (!isBelowRoot(path))
+        return false;
+
+    // a link to a directory goes, not what is in that directory
+    const QString fullPath = filePath(path);
+    const QFileInfo info(fullPath);
+    return (info.isDir() && !info.isSymLink()) ? QDir(fullPath).removeRecursively() : QFile::remove(fullPath);
+}
+
+bool DiskFileSystem::rename(const QString &path, const QString &newPath)
+{
+    if (!isBelowRoot(path) || !isBelowRoot(newPath) || exists(newPath))
+        return false;
+
+    return QDir().rename(filePath(path), filePath(newPath));
+}
+
+ResourceFileSystem::ResourceFileSystem(const QString &rootPath) :
+    DiskFileSystem(rootPath)
+{
+
+}
+
+bool ResourceFileSystem::isReadOnly() const
+{
+    return true;
+}
+
+QUrl ResourceFileSystem::url(const QString &path) const
+{
+    // ":/qml/examples" is "qrc:/qml/examples"
+    return QUrl(QLatin1String("qrc") + filePath(path));
+}
+
+bool ResourceFileSystem::write(const QString &, const QByteArray &)
+{
+    return false;
+}
+
+bool ResourceFileSystem::makePath(const QString &)
+{
+    return false;
+}
+
+bool ResourceFileSystem::remove(const QString &)
+{
+    return false;
+}
+
+bool ResourceFileSystem::rename(const QString &, const QString &)
+{
+    return false;
+}
+
+MemoryFileSystem::MemoryFileSystem()
+{
+    m_dirs.insert(QString());
+}
+
+bool MemoryFileSystem::isLocal() const
+{
+    return false;
+}
+
+QString MemoryFileSystem::filePath(const QString &path) const
+{
+    return QLatin1String("memory:/") + cleanPath(path);
+}
+
+QUrl MemoryFileSystem::url(const QString &path) const
+{
+    return QUrl(filePath(path));
+}
+
+bool MemoryFileSystem::exists(const QString &path) const
+{
+    const QString key = cleanPath(path);
+    return m_files.contains(key) || m_dirs.contains(key);
+}
+
+bool MemoryFileSystem::isDir(const QString &path) const
+{
+    return m_dirs.contains(cleanPath(path));
+}
+
+qint64 MemoryFileSystem::size(const QString &path) const
+{
+    return m_files.value(cleanPath(path)).size();
+}
+
+QVector<FileSystem::Entry> MemoryFileSystem::entries(const QString &dirPath) const
+{
+    const QString dir = cleanPath(dirPath);
+    QVector<Entry> entries;
+    if (!m_dirs.contains(dir))
+        return entries;
+
+    const QString prefix = dir.isEmpty() ? QString() : dir + QLatin1Char('/');
+    QMap<QString, bool> children;
+    for (const QString &subdir : m_dirs)
+    {
+        if (subdir.startsWith(prefix) && subdir.length() > prefix.length() &&
+                subdir.indexOf(QLatin1Char('/'), prefix.length()) < 0)
+            children.insert(subdir.mid(prefix.length()), true);
+    }
+    // the files below dir are next to each other in the map
+    for (auto it = m_files.lowerBound(prefix); it != m_files.constEnd() && it.key().startsWith(prefix); ++it)
+    {
+        if (it.key().indexOf(QLatin1Char('/'), prefix.length()) < 0)
+            children.insert(it.key().mid(prefix.length()), false);
+    }
+
+    for (auto it = children.constBegin(); it != children.constEnd(); ++it)
+        entries += Entry { it.key(), it.value() };
+    // in the order DiskFileSystem lists them
+    std::stable_sort(entries.begin(), entries.end(), [](const Entry &first, const Entry &second) {
+        return first.name.compare(second.name, Qt::CaseInsensitive) < 0;
+    });
+    return entries;
+}
+
+QByteArray MemoryFileSystem::read(const QString &path, bool *ok) const
+{
+    const auto it = m_files.constFind(cleanPath(path));
+    if (ok)
+        *ok = (it != m_files.constEnd());
+    return (it != m_files.constEnd()) ? it.value() : QByteArray();
+}
+
+bool MemoryFileSystem::write(const QString &path, const QByteArray &data)
+{
+    const QString key = cleanPath(path);
+    if (key.isEmpty() || m_dirs.contains(key) || !m_dirs.contains(parentPath(key)))
+        return false;
+
+    m_files.insert(key, data);
+    return true;
+}
+
+bool MemoryFileSystem::makePath(const QString &dirPath)
+{
+    if (!cleanPath(dirPath).isEmpty() && !isBelowRoot(dirPath))
+        return false;
+
+    const QStringList parts = cleanPath(dirPath).split(QLatin1Char('/'), Qt::SkipEmptyParts);
+    QString path;
+    for (const QString &part : parts)
+    {
+        path = joinPath(path, part);
+        if (m_files.contains(path))
+            return false;
+        m_dirs.insert(path);
+    }
+    return true;
+}
+
+bool MemoryFileSystem::remove(const QString &path)
+{
+    if (!isBelowRoot(path))
+        return false;
+
+    const QString key = cleanPath(path);
+    if (m_files.remove(key) > 0)
+        return true;
+    if (!m_dirs.remove(key))
+        return false;
+
+    const QString prefix = key + QLatin1Char('/');
+    for (auto it = m_files.lowerBound(prefix); it != m_files.end() && it.key().startsWith(prefix); )
+        it = m_files.erase(it);
+    for (auto it = m_dirs.begin(); it != m_dirs.end(); )
+    {
+        if (it->startsWith(prefix))
+            it = m_dirs.erase(it);
+        else
+            ++it;
+    }
+    return true;
+}
+
+bool MemoryFileSystem::rename(const QString &path, const QString &newPath)
+{
+    const QString from = cleanPath(path);
+    const QString to = cleanPath(newPath);
+    if (!isBelowRoot(from) || !isBelowRoot(to) || !exists(from) || exists(to) ||
+            !m_dirs.contains(parentPath(to)) || to.startsWith(from + QLatin1Char('/')))
+        return false;
+
+    if (m_files.contains(from))
+    {
+        m_files.insert(to, m_files.take(from));
+        return true;
+    }
+
+    // the directory and everything below it move to the new prefix
+    const QString prefix = from + QLatin1Char('/');
+    QMap<QString, QByteArray> files;
+    for (auto it = m_files.lowerBound(prefix); it != m_files.end() && it.key().startsWith(prefix); )
+    {
+        files.insert(to + it.key().mid(from.length()), it.value());
+        it = m_files.erase(it);
+    }
+    for (auto it = files.constBegin(); it != files.constEnd(); ++it)
+        m_files.insert(it.key(), it.value());
+
+    QSet<QString> dirs;
+    for (auto it = m_dirs.begin(); it != m_dirs.end(); )
+    {
+        if (*it == from || it->startsWith(prefix))
+        {
+            dirs.insert(to + it->mid(from.length()));
+            it = m_dirs.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    m_dirs += dirs;
+    return true;
+}
@@ -0,0 +1,126 @@
+#ifndef FILESYSTEM_H
+#define FILESYSTEM_H
+
+#include <QByteArray>
+#include <QMap>
+#include <QSet>
+#include <QString>
+#include <QUrl>
+#include <QVector>
+
+// What ProjectManager reads and writes projects through. Paths are '/'
+// separated and relative to the file system's root, "" being the root
+// itself. DiskFileSystem is the real thing, ResourceFileSystem serves the
+// examples straight from the resources, read-only, and MemoryFileSystem
+// keeps everything in a map so that file operations can be tested and
+// benchmarked without a disk.
+class FileSystem
+{
+public:
+    struct Entry
+    {
+        QString name;
+        bool isDir;
+    };
+
+    virtual ~FileSystem();
+
+    virtual bool isReadOnly() const;
+    // QFile, QSaveFile and the QML engine can open filePath() and url()
+    virtual bool isLocal() const;
+
+    // where path is, for messages, the job queue and document keys
+    virtual QString filePath(const QString &path) const = 0;
+    virtual QUrl url(const QString &path) const = 0;
+
+    virtual bool exists(const QString &path) const = 0;
+    virtual bool isDir(const QString &path) const = 0;
+    virtual qint64 size(const QString &path) const = 0;
+    // files and directories in dirPath, by name
+    virtual QVector<Entry> entries(const QString &dirPath) const = 0;
+
+    virtual QByteArray read(const QString &path, bool *ok = nullptr) const = 0;
+    // replaces the file as a whole; its directory has to exist
+    virtual bool write(const QString &path, const QByteArray &data) = 0;
+    virtual bool makePath(const QString &dirPath) = 0;
+    // directories with everything in them, links without what they point to
+    virtual bool remove(const QString &path) = 0;
+    // fails when newPath exists
+    virtual bool rename(const QString &path, const QString &newPath) = 0;
+
+    // copies a file or a directory tree, between any two file systems
+    static bool copy(const FileSystem &from, const QString &fromPath, FileSystem &to, const QString &toPath);
+
+    // "a//b/../c/" is "a/c", and "/" and "." are ""
+    static QString cleanPath(const QString &path);
+    // neither the root nor outside of it, what remove and rename accept
+    static bool isBelowRoot(const QString &path);
+    static QString joinPath(const QString &first, const QString &second);
+};
+
+class DiskFileSystem : public FileSystem
+{
+public:
+    // rootPath is resolved once, the paths below it are only appended
+    explicit DiskFileSystem(const QString &rootPath);
+
+    QString filePath(const QString &path) const override;
+    QUrl url(const QString &path) const override;
+
+    bool exists(const QString &path) const override;
+    bool isDir(const QString &path) const override;
+    qint64 size(const QString &path) const override;
+    QVector<Entry> entries(const QString &dirPath) const override;
+
+    QByteArray read(const QString &path, bool *ok = nullptr) const override;
+    bool write(const QString &path, const QByteArray &data) override;
+    bool makePath(const QString &dirPath) override;
+    bool remove(const QString &path) override;
+    bool rename(const QString &path, const QString &newPath) override;
+
+private:
+    QString m_rootPath;
+};
+
+class ResourceFileSystem : public DiskFileSystem
+{
+public:
+    // rootPath starts with ":/"
+    explicit ResourceFileSystem(const QString &rootPath);
+
+    bool isReadOnly() const override;
+    QUrl url(const QString &path) const override;
+
+    bool write(const QString &path, const QByteArray &data) override;
+    bool makePath(const QString &dirPath) override;
+    bool remove(const QString &path) override;
+    bool rename(const QString &path, const QString &newPath) override;
+};
+
+class MemoryFileSystem : public FileSystem
+{
+public:
+    MemoryFileSystem();
+
+    bool isLocal() const override;
+
+    QString filePath(const QString &path) const override;
+    QUrl url(const QString &path) const override;
+
+    bool exists(const QString &path) const override;
+    bool isDir(const QString &path) const override;
+    qint64 size(const QString &path) const override;
+    QVector<Entry> entries(const QString &dirPath) const override;
+
+    QByteArray read(const QString &path, bool *ok = nullptr) const override;
+    bool write(const QString &path, const QByteArray &data) override;
+    bool makePath(const QString &dirPath) override;
+    bool remove(const QString &path) override;
+    bool rename(const QString &path, const QString &newPath) override;
+
+private:
+    QMap<QString, QByteArray> m_files;
+    QSet<QString> m_dirs;           // the root is one of them
+};
+
+#endif // FILESYSTEM_H
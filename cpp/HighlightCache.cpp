@@ -0,0 +1,310 @@
+#include "HighlightCache.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QTextBlock>
+#include <QTextDocument>
+#include <QtEndian>
+#include <cstring>
+
+static const quint32 CacheMagic = 0x51434843; // "QCHC"
+static const quint32 CacheVersion = 2;
+static const int MaximumEntries = 256;
+
+// xxHash64, see https://github.com/Cyan4973/xxHash
+static const quint64 Prime1 = 0x9E3779B185EBCA87ULL;
+static const quint64 Prime2 = 0xC2B2AE3D27D4EB4FULL;
+static const quint64 Prime3 = 0x165667B19E3779F9ULL;
+static const quint64 Prime4 = 0x85EBCA77C2B2AE63ULL;
+static const quint64 Prime5 = 0x27D4EB2F165667C5ULL;
+
+static inline quint64 rotateLeft(quint64 value, int bits)
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+static inline quint64 read64(const uchar *p)
+{
+    quint64 value;
+    memcpy(&value, p, sizeof(value));
+    return qFromLittleEndian(value);
+}
+
+static inline quint32 read32(const uchar *p)
+{
+    quint32 value;
+    memcpy(&value, p, sizeof(value));
+    return qFromLittleEndian(value);
+}
+
+static inline quint64 accumulate(quint64 accumulator, quint64 input)
+{
+    accumulator += input * Prime2;
+    accumulator = rotateLeft(accumulator, 31);
+    return accumulator * Prime1;
+}
+
+static inline quint64 mergeRound(quint64 hash, quint64 accumulator)
+{
+    hash ^= accumulate(0, accumulator);
+    return hash * Prime1 + Prime4;
+}
+
+static quint64 xxHash64(const uchar *data, size_t length, quint64 seed)
+{
+    const uchar *p = data;
+    const uchar *end = data + length;
+    quint64 hash;
+
+    if (length >= 32)
+    {
+        quint64 v1 = seed + Prime1 + Prime2;
+        quint64 v2 = seed + Prime2;
+        quint64 v3 = seed;
+        quint64 v4 = seed - Prime1;
+        const uchar *limit = end - 32;
+        do
+        {
+            v1 = accumulate(v1, read64(p));
+            v2 = accumulate(v2, read64(p + 8));
+            v3 = accumulate(v3, read64(p + 16));
+            v4 = accumulate(v4, read64(p + 24));
+            p += 32;
+        } while (p <= limit);
+
+        hash = rotateLeft(v1, 1) + rotateLeft(v2, 7) + rotateLeft(v3, 12) + rotateLeft(v4, 18);
+        hash = mergeRound(hash, v1);
+        hash = mergeRound(hash, v2);
+        hash = mergeRound(hash, v3);
+        hash = mergeRound(hash, v4);
+    }
+    else
+    {
+        hash = seed + Prime5;
+    }
+
+    hash += quint64(length);
+
+    while (p + 8 <= end)
+    {
+        hash ^= accumulate(0, read64(p));
+        hash = rotateLeft(hash, 27) * Prime1 + Prime4;
+        p += 8;
+    }
+
+    if (p + 4 <= end)
+    {
+        hash ^= quint64(read32(p)) * Prime1;
+        hash = rotateLeft(hash, 23) * Prime2 + Prime3;
+        p += 4;
+    }
+
+    while (p < end)
+    {
+        hash ^= (*p) * Prime5;
+        hash = rotateLeft(hash, 11) * Prime1;
+        p++;
+    }
+
+    hash ^= hash >> 33;
+    hash *= Prime2;
+    hash ^= hash >> 29;
+    hash *= Prime3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+static void writeSpans(QDataStream &stream, const QVector<FormatSpan> &spans)
+{
+    stream << qint32(spans.count());
+    foreach (const FormatSpan &span, spans)
+        stream << qint32(span.start) << qint32(span.length) << quint8(span.component);
+}
+
+static bool readSpans(QDataStream &stream, QVector<FormatSpan> &spans, int limit)
+{
+    qint32 count;
+    stream >> count;
+    if (count < 0 || count > limit)
+        stream.setStatus(QDataStream::ReadCorruptData);
+    if (stream.status() != QDataStream::Ok)
+        return false;
+
+    spans.resize(count);
+    for (FormatSpan &span : spans)
+    {
+        qint32 start, length;
+        quint8 component;
+        stream >> start >> length >> component;
+        span.start = start;
+        span.length = length;
+        span.component = component;
+    }
+
+    return stream.status() == QDataStream::Ok;
+}
+
+quint64 HighlightCache::hash(const QChar *data, int length, quint64 seed)
+{
+    return xxHash64(reinterpret_cast<const uchar *>(data), size_t(length) * sizeof(QChar), seed);
+}
+
+quint64 HighlightCache::hash(const QString &text, quint64 seed)
+{
+    return hash(text.constData(), text.length(), seed);
+}
+
+QVector<HighlightCache::Block> HighlightCache::load(quint64 key)
+{
+    QFile file(filePath(key));
+    if (!file.open(QIODevice::ReadOnly))
+        return QVector<Block>();
+
+    const QByteArray data = qUncompress(file.readAll());
+    QDataStream stream(data);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    qint32 count = 0;
+    stream >> magic >> version >> count;
+    if (magic != CacheMagic || version != CacheVersion || count < 0 || count > data.size())
+        return QVector<Block>();
+
+    QVector<Block> blocks(count);
+    for (Block &block : blocks)
+    {
+        qint32 previousState, state, depthBefore, minDepth, foldOffset;
+        qint32 bracketCount, tokenCount;
+        stream >> block.textHash >> previousState >> state
+               >> depthBefore >> minDepth >> foldOffset >> block.endsInComment;
+        block.previousState = previousState;
+        block.state = state;
+        block.depthBefore = depthBefore;
+        block.minDepth = minDepth;
+        block.foldOffset = foldOffset;
+
+        stream >> bracketCount;
+        if (bracketCount < 0 || bracketCount > data.size())
+            stream.setStatus(QDataStream::ReadCorruptData);
+        if (stream.status() != QDataStream::Ok)
+            break;
+        block.brackets.resize(bracketCount);
+        for (Bracket &bracket : block.brackets)
+        {
+            qint32 offset, depth;
+            stream >> offset >> depth >> bracket.opening;
+            bracket.offset = offset;
+            bracket.depth = depth;
+        }
+
+        stream >> tokenCount;
+        if (tokenCount < 0 || tokenCount > data.size())
+            stream.setStatus(QDataStream::ReadCorruptData);
+        if (stream.status() != QDataStream::Ok)
+            break;
+        block.tokens.resize(tokenCount);
+        for (Token &token : block.tokens)
+        {
+            qint32 offset, length;
+            quint16 symbol;
+            quint8 keyword;
+            stream >> offset >> length >> symbol >> keyword >> token.capitalized;
+            token.offset = offset;
+            token.length = length;
+            token.symbol = QChar(symbol);
+            token.keyword = Token::Keyword(keyword);
+        }
+
+        if (!readSpans(stream, block.spans, data.size()) || !readSpans(stream, block.literals, data.size()))
+            break;
+    }
+
+    if (stream.status() != QDataStream::Ok)
+    {
+        qWarning() << "Corrupted highlight cache" << file.fileName();
+        file.remove();
+        return QVector<Block>();
+    }
+
+    return blocks;
+}
+
+bool HighlightCache::contains(quint64 key)
+{
+    return QFileInfo::exists(filePath(key));
+}
+
+QByteArray HighlightCache::serialize(const QTextDocument *document)
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream << CacheMagic << CacheVersion << qint32(document->blockCount());
+
+    for (QTextBlock block = document->begin(); block.isValid(); block = block.next())
+    {
+        // not highlighted yet
+        const BlockData *blockData = static_cast<const BlockData *>(block.userData());
+        if (!blockData)
+            return QByteArray();
+
+        const QString text = block.text();
+        const QTextBlock previous = block.previous();
+        stream << hash(text)
+               << qint32(previous.isValid() ? previous.userState() : -1)
+               << qint32(block.userState())
+               << qint32(blockData->depthBefore) << qint32(blockData->minDepth)
+               << qint32(blockData->foldOffset) << blockData->endsInComment;
+
+        stream << qint32(blockData->brackets.count());
+        foreach (const Bracket &bracket, blockData->brackets)
+            stream << qint32(bracket.offset) << qint32(bracket.depth) << bracket.opening;
+
+        stream << qint32(blockData->tokens.count());
+        foreach (const Token &token, blockData->tokens)
+            stream << qint32(token.offset) << qint32(token.length) << quint16(token.symbol.unicode())
+                   << quint8(token.keyword) << token.capitalized;
+
+        writeSpans(stream, blockData->spans);
+        writeSpans(stream, blockData->literals);
+    }
+
+    return data;
+}
+
+void HighlightCache::store(quint64 key, const QByteArray &data)
+{
+    const QString directory = directoryPath();
+    if (!QDir().mkpath(directory))
+        return;
+
+    QSaveFile file(filePath(key));
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+
+    file.write(qCompress(data));
+    if (!file.commit())
+    {
+        qWarning() << "Unable to write highlight cache" << file.fileName();
+        return;
+    }
+
+    const QFileInfoList entries = QDir(directory).entryInfoList(QDir::Files, QDir::Time);
+    for (int i = MaximumEntries; i < entries.count(); i++)
+        QFile::remove(entries.at(i).filePath());
+}
+
+QString HighlightCache::directoryPath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) +
+            QDir::separator() + QStringLiteral("highlight");
+}
+
+QString HighlightCache::filePath(quint64 key)
+{
+    return directoryPath() + QDir::separator() + QString::number(key, 16) + QStringLiteral(".bin");
+}
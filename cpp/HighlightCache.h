@@ -0,0 +1,54 @@
+#ifndef HIGHLIGHTCACHE_H
+#define HIGHLIGHTCACHE_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+#include "BlockData.h"
+
+class QTextDocument;
+
+// Lexer results of whole files on disk, so reopening a file that did not
+// change skips the lexing. An entry is keyed by the xxHash64 of the file's
+// text, seeded with everything else the colours depend on (see
+// QMLHighlighter::cacheSeed), and holds for every block the hash of its
+// text, the lexer states around it, its BlockData and the spans it was
+// coloured with. Entries live in <cache location>/highlight, the oldest
+// ones are removed past MaximumEntries.
+class HighlightCache
+{
+public:
+    struct Block
+    {
+        quint64 textHash = 0;
+        int previousState = -1;
+        int state = -1;
+
+        int depthBefore = 0;
+        int minDepth = 0;
+        int foldOffset = -1;
+        bool endsInComment = false;
+        QVector<Bracket> brackets;
+        QVector<Token> tokens;
+        QVector<FormatSpan> spans;
+        QVector<FormatSpan> literals;
+    };
+
+    static quint64 hash(const QChar *data, int length, quint64 seed = 0);
+    static quint64 hash(const QString &text, quint64 seed = 0);
+
+    // empty if there is no valid entry for key
+    static QVector<Block> load(quint64 key);
+    static bool contains(quint64 key);
+
+    // serialize() reads the highlighted document and has to run in its
+    // thread, store() only writes the file and can run anywhere
+    static QByteArray serialize(const QTextDocument *document);
+    static void store(quint64 key, const QByteArray &data);
+
+private:
+    static QString directoryPath();
+    static QString filePath(quint64 key);
+};
+
+#endif // HIGHLIGHTCACHE_H
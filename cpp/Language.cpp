@@ -0,0 +1,190 @@
+#include "Language.h"
+#include "QMLHighlighter.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QTextStream>
+
+using LanguageTables::CharClassTable;
+
+// Syntax descriptions, the characters besides letters and digits that
+// start and continue identifiers and numbers, quote strings and start
+// preprocessor lines
+
+struct QmlSyntax
+{
+    static constexpr const char *identifierStart = "_";
+    static constexpr const char *identifierPart = "_";
+    static constexpr const char *numberPart = "";
+    static constexpr const char *quotes = "\"'";
+    static constexpr const char *directive = "";
+};
+
+struct JavaScriptSyntax
+{
+    static constexpr const char *identifierStart = "_$";
+    static constexpr const char *identifierPart = "_$";
+    static constexpr const char *numberPart = ".xXabcdefABCDEF_n";
+    static constexpr const char *quotes = "\"'`";
+    static constexpr const char *directive = "";
+};
+
+struct JsonSyntax
+{
+    static constexpr const char *identifierStart = "";
+    static constexpr const char *identifierPart = "";
+    static constexpr const char *numberPart = ".eE+-";
+    static constexpr const char *quotes = "\"";
+    static constexpr const char *directive = "";
+};
+
+struct GlslSyntax
+{
+    static constexpr const char *identifierStart = "_";
+    static constexpr const char *identifierPart = "_";
+    static constexpr const char *numberPart = ".xXabcdefABCDEFuU";
+    static constexpr const char *quotes = "";
+    static constexpr const char *directive = "#";
+};
+
+Language::Language(const char *name, const unsigned short *classes, bool comments,
+                   const QVector<KeywordSet> &keywordSets,
+                   const QStringList &embeddingProperties, const Language *embedded) :
+    m_name(name),
+    m_classes(classes),
+    m_comments(comments),
+    m_keywordSets(keywordSets),
+    m_embeddingProperties(embeddingProperties),
+    m_embedded(embedded)
+{
+
+}
+
+const char *Language::name() const
+{
+    return m_name;
+}
+
+bool Language::comments() const
+{
+    return m_comments;
+}
+
+const QVector<Language::KeywordSet> &Language::keywordSets() const
+{
+    return m_keywordSets;
+}
+
+const QVector<QSet<QString>> &Language::words() const
+{
+    if (m_words.count() == m_keywordSets.count())
+        return m_words;
+
+    foreach (const KeywordSet &keywordSet, m_keywordSets) {
+        QSet<QString> words;
+        const QString source = QString::fromLatin1(keywordSet.words);
+        if (source.startsWith(':'))
+        {
+            QFile file(source);
+            if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+                qWarning() << "Can't open dictionary" << source;
+
+            QTextStream textStream(&file);
+            while (!textStream.atEnd())
+                words << textStream.readLine().trimmed();
+        }
+        else
+        {
+            foreach (const QString &word, source.split(' ', Qt::SkipEmptyParts))
+                words << word;
+        }
+
+        m_words += words;
+    }
+
+    return m_words;
+}
+
+const Language *Language::embedded() const
+{
+    return m_embedded;
+}
+
+bool Language::embeds(const QStringRef &property) const
+{
+    if (!m_embedded)
+        return false;
+
+    foreach (const QString &embeddingProperty, m_embeddingProperties) {
+        if (property == embeddingProperty)
+            return true;
+    }
+
+    return false;
+}
+
+const Language &Language::qml()
+{
+    static const Language language("qml", CharClassTable<QmlSyntax>::classes, true, {
+        { ":/resources/dictionaries/keywords.txt", QMLHighlighter::Keyword, KeywordSet::NoExtra },
+        { ":/resources/dictionaries/qml.txt", QMLHighlighter::Item, KeywordSet::QmlComponents },
+        { ":/resources/dictionaries/properties.txt", QMLHighlighter::Property, KeywordSet::NoExtra },
+        { ":/resources/dictionaries/javascript.txt", QMLHighlighter::BuiltIn, KeywordSet::JsComponents }
+    }, { "fragmentShader", "vertexShader" }, &glsl());
+    return language;
+}
+
+const Language &Language::javaScript()
+{
+    static const Language language("js", CharClassTable<JavaScriptSyntax>::classes, true, {
+        { "async await break case catch class const continue debugger default delete do else export "
+          "extends false finally for function if import in instanceof let new null of return static "
+          "super switch this throw true try typeof undefined var void while with yield",
+          QMLHighlighter::Keyword, KeywordSet::NoExtra },
+        { ":/resources/dictionaries/javascript.txt", QMLHighlighter::BuiltIn, KeywordSet::JsComponents }
+    });
+    return language;
+}
+
+const Language &Language::json()
+{
+    static const Language language("json", CharClassTable<JsonSyntax>::classes, false, {
+        { "true false null", QMLHighlighter::Keyword, KeywordSet::NoExtra }
+    });
+    return language;
+}
+
+const Language &Language::glsl()
+{
+    static const Language language("glsl", CharClassTable<GlslSyntax>::classes, true, {
+        { "attribute break case centroid const continue default discard do else false flat for "
+          "highp if in inout invariant layout lowp mediump noperspective out precision return "
+          "smooth struct switch true uniform varying while",
+          QMLHighlighter::Keyword, KeywordSet::NoExtra },
+        { "bool bvec2 bvec3 bvec4 double float int ivec2 ivec3 ivec4 mat2 mat2x2 mat2x3 mat2x4 "
+          "mat3 mat3x2 mat3x3 mat3x4 mat4 mat4x2 mat4x3 mat4x4 sampler1D sampler2D sampler3D "
+          "samplerCube uint uvec2 uvec3 uvec4 vec2 vec3 vec4 void",
+          QMLHighlighter::Item, KeywordSet::NoExtra },
+        { "abs acos asin atan ceil clamp cos cross dFdx dFdy degrees distance dot exp exp2 "
+          "faceforward floor fract fwidth gl_FragColor gl_FragCoord gl_FragData gl_FrontFacing "
+          "gl_PointCoord gl_PointSize gl_Position inversesqrt length log log2 max min mix mod "
+          "normalize pow qt_Matrix qt_MultiTexCoord0 qt_Opacity qt_TexCoord0 qt_Vertex radians "
+          "reflect refract sign sin smoothstep sqrt step tan texture texture2D textureCube",
+          QMLHighlighter::BuiltIn, KeywordSet::NoExtra }
+    });
+    return language;
+}
+
+const Language &Language::forFileFormat(const QString &fileFormat)
+{
+    const QString suffix = fileFormat.toLower();
+    if (suffix == QLatin1String("js") || suffix == QLatin1String("mjs"))
+        return javaScript();
+    if (suffix == QLatin1String("json"))
+        return json();
+    if (suffix == QLatin1String("glsl") || suffix == QLatin1String("frag") || suffix == QLatin1String("vert")
+            || suffix == QLatin1String("fsh") || suffix == QLatin1String("vsh"))
+        return glsl();
+
+    return qml();
+}
@@ -0,0 +1,146 @@
+#ifndef LANGUAGE_H
+#define LANGUAGE_H
+
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+enum CharClass : unsigned short {
+    OtherChar = 0,
+    SpaceChar = 1 << 0,
+    DigitChar = 1 << 1,
+    IdentifierStartChar = 1 << 2,
+    IdentifierChar = 1 << 3,
+    NumberChar = 1 << 4,        // continues a number
+    QuoteChar = 1 << 5,
+    BracketChar = 1 << 6,       // (){}[], not coloured as operators
+    PunctuationChar = 1 << 7,   // what the outline parser gets tokens for
+    DirectiveChar = 1 << 8      // starts a preprocessor line
+};
+
+namespace LanguageTables {
+
+constexpr bool contains(const char *set, int c)
+{
+    return *set != 0 && (*set == c || contains(set + 1, c));
+}
+
+constexpr bool isSpace(int c)
+{
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+constexpr bool isDigit(int c)
+{
+    return c >= '0' && c <= '9';
+}
+
+constexpr bool isLetter(int c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+// Class of the ASCII character c in the language Syntax describes, with
+// the same answers QChar gives for spaces, digits and letters
+template <typename Syntax>
+constexpr unsigned short classify(int c)
+{
+    return (isSpace(c) ? SpaceChar : 0)
+         | (isDigit(c) ? DigitChar | IdentifierChar | NumberChar : 0)
+         | (isLetter(c) || contains(Syntax::identifierStart, c) ? IdentifierStartChar | IdentifierChar : 0)
+         | (contains(Syntax::identifierPart, c) ? IdentifierChar : 0)
+         | (contains(Syntax::numberPart, c) ? NumberChar : 0)
+         | (contains(Syntax::quotes, c) ? QuoteChar : 0)
+         | (contains("(){}[]", c) ? BracketChar : 0)
+         | (contains("(){}[]:;,.=", c) ? PunctuationChar : 0)
+         | (contains(Syntax::directive, c) ? DirectiveChar : 0);
+}
+
+template <int... I> struct IndexList {};
+template <int N, int... I> struct MakeIndexList : MakeIndexList<N - 1, N - 1, I...> {};
+template <int... I> struct MakeIndexList<0, I...> { typedef IndexList<I...> Type; };
+
+// The 128 entry class table of Syntax, filled in by the compiler
+template <typename Syntax, typename Indices = typename MakeIndexList<128>::Type>
+struct CharClassTable;
+
+template <typename Syntax, int... I>
+struct CharClassTable<Syntax, IndexList<I...>>
+{
+    static constexpr unsigned short classes[sizeof...(I)] = { classify<Syntax>(I)... };
+};
+
+template <typename Syntax, int... I>
+constexpr unsigned short CharClassTable<Syntax, IndexList<I...>>::classes[sizeof...(I)];
+
+} // namespace LanguageTables
+
+// What QMLHighlighter's lexer needs to know about a language. The
+// character classes come from a Syntax description turned into a table
+// at compile time (see Language.cpp), the rest is plain data: C style
+// comments or not, the keyword sets identifiers are coloured by, and the
+// properties whose string values are written in another language.
+class Language
+{
+public:
+    struct KeywordSet
+    {
+        enum Extra : unsigned char {
+            NoExtra,
+            QmlComponents,      // plus the project's .qml files
+            JsComponents        // plus the project's .js files
+        };
+
+        const char *words;          // dictionary resource, or words separated by spaces
+        unsigned char component;    // QMLHighlighter::ColorComponent
+        Extra extra;
+    };
+
+    Language(const char *name, const unsigned short *classes, bool comments,
+             const QVector<KeywordSet> &keywordSets,
+             const QStringList &embeddingProperties = QStringList(),
+             const Language *embedded = nullptr);
+
+    const char *name() const;
+    bool comments() const;
+    const QVector<KeywordSet> &keywordSets() const;
+    // the words of each keyword set, read on first use
+    const QVector<QSet<QString>> &words() const;
+
+    const Language *embedded() const;
+    bool embeds(const QStringRef &property) const;
+
+    inline unsigned short charClass(QChar ch) const
+    {
+        // Unicode tables are only looked at past ASCII
+        if (ch.unicode() < 128)
+            return m_classes[ch.unicode()];
+        if (ch.isSpace())
+            return SpaceChar;
+        if (ch.isDigit())
+            return DigitChar | IdentifierChar | NumberChar;
+        if (ch.isLetter())
+            return IdentifierStartChar | IdentifierChar;
+        return OtherChar;
+    }
+
+    static const Language &qml();
+    static const Language &javaScript();
+    static const Language &json();
+    static const Language &glsl();
+    // by file suffix, QML for anything unknown
+    static const Language &forFileFormat(const QString &fileFormat);
+
+private:
+    const char *m_name;
+    const unsigned short *m_classes;
+    bool m_comments;
+    QVector<KeywordSet> m_keywordSets;
+    QStringList m_embeddingProperties;
+    const Language *m_embedded;
+
+    mutable QVector<QSet<QString>> m_words;
+};
+
+#endif // LANGUAGE_H
@@ -0,0 +1,341 @@
+#include "LatencyTracer.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QInputMethodEvent>
+#include <QKeyEvent>
+#include <QStandardPaths>
+#include <QTextStream>
+#include <algorithm>
+
+// upper bounds of the histogram buckets in milliseconds, the last one is open
+static const int BucketBounds[] = { 8, 16, 33, 50, 100, 200 };
+static const int BucketCount = sizeof(BucketBounds) / sizeof(BucketBounds[0]) + 1;
+
+// keystrokes that have not reached a frame by then caused none
+static const qint64 StaleAfter = 1000 * 1000 * 1000;
+
+static QString milliseconds(qint64 nanoseconds)
+{
+    return QString::number(nanoseconds / 1000000.0, 'f', 1);
+}
+
+LatencyTracer::LatencyTracer(QObject *parent) :
+    QObject(parent),
+    m_enabled(false),
+    m_buckets(BucketCount, 0),
+    m_editTotal(0),
+    m_renderTotal(0),
+    m_stale(0)
+{
+    std::fill(m_stageTotals, m_stageTotals + StageCount, 0);
+    m_timer.start();
+}
+
+LatencyTracer::~LatencyTracer()
+{
+    setEnabled(false);
+}
+
+LatencyTracer *LatencyTracer::instance()
+{
+    static LatencyTracer tracer;
+    return &tracer;
+}
+
+bool LatencyTracer::isEnabled() const
+{
+    return m_enabled;
+}
+
+void LatencyTracer::setEnabled(bool enabled)
+{
+    if (m_enabled == enabled)
+        return;
+
+    m_enabled = enabled;
+    m_pending.clear();
+    m_running.clear();
+
+    if (m_enabled)
+    {
+        QDir().mkpath(QFileInfo(logPath()).absolutePath());
+        m_log.setFileName(logPath());
+        if (m_log.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text))
+        {
+            log(QString("# %1 keystroke to frame swap in ms: at, total, edit, highlight, gutter, script, render")
+                .arg(QDateTime::currentDateTime().toString(Qt::ISODate)));
+        }
+        else
+        {
+            qWarning() << "Unable to open" << m_log.fileName();
+        }
+        connectWindow();
+    }
+    else
+    {
+        QObject::disconnect(m_syncConnection);
+        QObject::disconnect(m_swapConnection);
+        if (m_log.isOpen())
+        {
+            for (const QString &line : summary().split('\n'))
+                log("# " + line);
+            m_log.close();
+        }
+    }
+
+    emit enabledChanged();
+}
+
+void LatencyTracer::setWindow(QQuickWindow *window)
+{
+    QObject::disconnect(m_syncConnection);
+    QObject::disconnect(m_swapConnection);
+    m_window = window;
+    if (m_enabled)
+        connectWindow();
+}
+
+void LatencyTracer::connectWindow()
+{
+    if (!m_window)
+        return;
+
+    // both are emitted on the render thread with the threaded render loop,
+    // synchronization with the GUI thread blocked
+    m_syncConnection = QObject::connect(m_window, &QQuickWindow::beforeSynchronizing,
+                                        this, &LatencyTracer::onSynchronizing, Qt::DirectConnection);
+    m_swapConnection = QObject::connect(m_window, &QQuickWindow::frameSwapped,
+                                        this, &LatencyTracer::onFrameSwapped, Qt::DirectConnection);
+}
+
+void LatencyTracer::input(const QEvent *event)
+{
+    if (!m_enabled)
+        return;
+
+    if (event->type() == QEvent::KeyPress)
+    {
+        // modifiers on their own change nothing on the screen
+        const int key = static_cast<const QKeyEvent *>(event)->key();
+        if ((key >= Qt::Key_Shift && key <= Qt::Key_ScrollLock) || key == Qt::Key_AltGr)
+            return;
+    }
+    else if (event->type() == QEvent::InputMethod)
+    {
+        const QInputMethodEvent *imEvent = static_cast<const QInputMethodEvent *>(event);
+        if (imEvent->commitString().isEmpty() && imEvent->preeditString().isEmpty() &&
+                imEvent->replacementLength() == 0)
+            return;
+    }
+    else
+    {
+        return;
+    }
+
+    Trace trace;
+    trace.input = m_timer.nsecsElapsed();
+    trace.edited = -1;
+    std::fill(trace.stages, trace.stages + StageCount, 0);
+    trace.synced = -1;
+    trace.swapped = -1;
+    m_pending += trace;
+}
+
+void LatencyTracer::begin(Stage stage)
+{
+    if (!m_enabled || stage < 0 || stage >= StageCount)
+        return;
+
+    const qint64 now = m_timer.nsecsElapsed();
+    pause(now);
+    m_running += Running { stage, now };
+
+    if (!m_pending.isEmpty() && m_pending.last().edited < 0)
+        m_pending.last().edited = now;
+}
+
+void LatencyTracer::end(Stage stage)
+{
+    // unbalanced when tracing was enabled in the middle of a stage
+    if (m_running.isEmpty() || m_running.last().stage != stage)
+        return;
+
+    const qint64 now = m_timer.nsecsElapsed();
+    pause(now);
+    m_running.removeLast();
+    if (!m_running.isEmpty())
+        m_running.last().since = now;
+}
+
+// the time so far goes to the innermost stage and the latest keystroke
+void LatencyTracer::pause(qint64 now)
+{
+    if (m_running.isEmpty() || m_pending.isEmpty())
+        return;
+
+    Running &running = m_running.last();
+    m_pending.last().stages[running.stage] += now - running.since;
+    running.since = now;
+}
+
+void LatencyTracer::reset()
+{
+    m_latencies.clear();
+    m_buckets.fill(0);
+    m_editTotal = 0;
+    std::fill(m_stageTotals, m_stageTotals + StageCount, 0);
+    m_renderTotal = 0;
+    m_stale = 0;
+    emit tracesChanged();
+}
+
+void LatencyTracer::onSynchronizing()
+{
+    // everything the keystrokes so far caused is in this frame
+    const qint64 now = m_timer.nsecsElapsed();
+    int stale = 0;
+    for (Trace &trace : m_pending)
+    {
+        if (now - trace.input > StaleAfter)
+        {
+            stale++;
+            continue;
+        }
+        trace.synced = now;
+        m_inFlight += trace;
+    }
+    m_pending.clear();
+
+    if (stale > 0)
+    {
+        QMetaObject::invokeMethod(this, [this, stale]() {
+            finish(QVector<Trace>(), stale);
+        }, Qt::QueuedConnection);
+    }
+}
+
+void LatencyTracer::onFrameSwapped()
+{
+    if (m_inFlight.isEmpty())
+        return;
+
+    const qint64 now = m_timer.nsecsElapsed();
+    for (Trace &trace : m_inFlight)
+        trace.swapped = now;
+
+    const QVector<Trace> traces = m_inFlight;
+    m_inFlight.clear();
+    QMetaObject::invokeMethod(this, [this, traces]() {
+        finish(traces, 0);
+    }, Qt::QueuedConnection);
+}
+
+void LatencyTracer::finish(const QVector<Trace> &traces, int stale)
+{
+    if (!m_enabled)
+        return;
+
+    m_stale += stale;
+    for (const Trace &trace : traces)
+    {
+        const qint64 latency = trace.swapped - trace.input;
+        const qint64 edit = (trace.edited < 0) ? 0 : trace.edited - trace.input;
+        const qint64 render = trace.swapped - trace.synced;
+
+        m_latencies.insert(std::lower_bound(m_latencies.begin(), m_latencies.end(), latency), latency);
+        int bucket = 0;
+        while (bucket < BucketCount - 1 && latency >= BucketBounds[bucket] * 1000000LL)
+            bucket++;
+        m_buckets[bucket]++;
+
+        m_editTotal += edit;
+        for (int stage = 0; stage < StageCount; stage++)
+            m_stageTotals[stage] += trace.stages[stage];
+        m_renderTotal += render;
+
+        log(QString("%1\t%2\t%3\t%4\t%5\t%6\t%7")
+            .arg(milliseconds(trace.input), milliseconds(latency), milliseconds(edit),
+                 milliseconds(trace.stages[Highlight]), milliseconds(trace.stages[Gutter]),
+                 milliseconds(trace.stages[Script]), milliseconds(render)));
+    }
+
+    emit tracesChanged();
+}
+
+void LatencyTracer::log(const QString &line)
+{
+    if (!m_log.isOpen())
+        return;
+
+    QTextStream stream(&m_log);
+    stream << line << '\n';
+}
+
+qint64 LatencyTracer::percentile(int percent) const
+{
+    if (m_latencies.isEmpty())
+        return 0;
+    return m_latencies.at(qMin(m_latencies.count() - 1, m_latencies.count() * percent / 100));
+}
+
+int LatencyTracer::count() const
+{
+    return m_latencies.count();
+}
+
+QString LatencyTracer::summary() const
+{
+    if (m_latencies.isEmpty())
+        return tr("Type to measure keystroke to frame latency");
+
+    const int count = m_latencies.count();
+    QString summary = tr("%1 keystrokes: median %2 ms, 95% %3 ms, max %4 ms")
+            .arg(count)
+            .arg(milliseconds(percentile(50)), milliseconds(percentile(95)), milliseconds(m_latencies.last()));
+    summary += '\n' + tr("Average edit %1, highlight %2, gutter %3, script %4, render %5 ms")
+            .arg(milliseconds(m_editTotal / count), milliseconds(m_stageTotals[Highlight] / count),
+                 milliseconds(m_stageTotals[Gutter] / count), milliseconds(m_stageTotals[Script] / count),
+                 milliseconds(m_renderTotal / count));
+    if (m_stale > 0)
+        summary += '\n' + tr("%1 keystrokes without a frame").arg(m_stale);
+    return summary;
+}
+
+QVariantList LatencyTracer::histogram() const
+{
+    QVariantList histogram;
+    for (int count : m_buckets)
+        histogram += count;
+    return histogram;
+}
+
+QStringList LatencyTracer::bucketLabels() const
+{
+    QStringList labels;
+    for (int bound : BucketBounds)
+        labels += QString("< %1 ms").arg(bound);
+    labels += QString(">= %1 ms").arg(BucketBounds[BucketCount - 2]);
+    return labels;
+}
+
+QString LatencyTracer::logPath() const
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/latency.log";
+}
+
+LatencyTracer::Scope::Scope(Stage stage) :
+    m_stage(stage),
+    m_active(LatencyTracer::instance()->isEnabled())
+{
+    if (m_active)
+        LatencyTracer::instance()->begin(m_stage);
+}
+
+LatencyTracer::Scope::~Scope()
+{
+    if (m_active)
+        LatencyTracer::instance()->end(m_stage);
+}
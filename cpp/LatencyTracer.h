@@ -0,0 +1,122 @@
+#ifndef LATENCYTRACER_H
+#define LATENCYTRACER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QPointer>
+#include <QQuickWindow>
+#include <QVariantList>
+#include <QVector>
+
+class QEvent;
+
+// Follows keystrokes from the editor's event filter (see ImEventFixer) to
+// the first frame swapped after them. On the way, the time spent in the
+// stages below is added to the latest keystroke, so that a slow frame can
+// be told apart from a slow highlighter or a slow handler. Finished
+// traces go into a histogram shown by CLatencyOverlay and, one line each,
+// into a log file in the cache folder. Does nothing while disabled.
+class LatencyTracer : public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY(bool enabled READ isEnabled WRITE setEnabled NOTIFY enabledChanged)
+    Q_PROPERTY(int count READ count NOTIFY tracesChanged)
+    Q_PROPERTY(QString summary READ summary NOTIFY tracesChanged)
+    Q_PROPERTY(QVariantList histogram READ histogram NOTIFY tracesChanged)
+    Q_PROPERTY(QStringList bucketLabels READ bucketLabels CONSTANT)
+    Q_PROPERTY(QString logPath READ logPath CONSTANT)
+
+public:
+    enum Stage { Highlight, Gutter, Script, StageCount };
+    Q_ENUM(Stage)
+
+    explicit LatencyTracer(QObject *parent = nullptr);
+    ~LatencyTracer();
+
+    static LatencyTracer *instance();
+
+    bool isEnabled() const;
+    void setEnabled(bool enabled);
+
+    // the window whose frames end the traces
+    void setWindow(QQuickWindow *window);
+
+    // starts a trace for key presses and input method commits
+    void input(const QEvent *event);
+
+    // stages nest, the time of the inner one is not counted for the outer
+    Q_INVOKABLE void begin(Stage stage);
+    Q_INVOKABLE void end(Stage stage);
+    Q_INVOKABLE void reset();
+
+    int count() const;
+    QString summary() const;
+    QVariantList histogram() const;
+    QStringList bucketLabels() const;
+    QString logPath() const;
+
+    // times the enclosing block as stage
+    class Scope
+    {
+    public:
+        explicit Scope(Stage stage);
+        ~Scope();
+
+    private:
+        Stage m_stage;
+        bool m_active;
+    };
+
+private:
+    struct Trace
+    {
+        qint64 input;       // nanoseconds since the tracer was created
+        qint64 edited;      // the first stage began, -1 before
+        qint64 stages[StageCount];
+        qint64 synced;
+        qint64 swapped;
+    };
+
+    struct Running
+    {
+        Stage stage;
+        qint64 since;
+    };
+
+    void connectWindow();
+    void pause(qint64 now);
+    void onSynchronizing();
+    void onFrameSwapped();
+    void finish(const QVector<Trace> &traces, int stale);
+    void log(const QString &line);
+    qint64 percentile(int percent) const;
+
+    bool m_enabled;
+    QElapsedTimer m_timer;
+    QPointer<QQuickWindow> m_window;
+    QMetaObject::Connection m_syncConnection;
+    QMetaObject::Connection m_swapConnection;
+
+    // GUI thread, read on the render thread while the GUI thread is
+    // blocked in synchronization
+    QVector<Trace> m_pending;
+    QVector<Running> m_running;
+    // render thread
+    QVector<Trace> m_inFlight;
+
+    QVector<qint64> m_latencies;        // sorted
+    QVector<int> m_buckets;
+    qint64 m_editTotal;
+    qint64 m_stageTotals[StageCount];
+    qint64 m_renderTotal;
+    int m_stale;
+    QFile m_log;
+
+signals:
+    void enabledChanged();
+    void tracesChanged();
+};
+
+#endif // LATENCYTRACER_H
@@ -0,0 +1,314 @@
+#include "LineChanges.h"
+#include "HighlightCache.h"
+
+#include <QTextBlock>
+#include <QTextDocument>
+#include <QtConcurrent>
+#include <algorithm>
+
+// Past this many inserted and removed lines the differing middle of the
+// texts is marked as one change, the diff's memory grows with its square
+static const int MaximumDistance = 1000;
+
+static quint64 lineHash(const QTextBlock &block)
+{
+    const QString text = block.text();
+    return HighlightCache::hash(text.constData(), text.length());
+}
+
+// Replaces count entries of vector at position with replacement
+template <typename T>
+static void splice(QVector<T> &vector, int position, int count, const QVector<T> &replacement)
+{
+    if (count == replacement.count())
+    {
+        std::copy(replacement.constBegin(), replacement.constEnd(), vector.begin() + position);
+        return;
+    }
+
+    QVector<T> result;
+    result.reserve(vector.count() - count + replacement.count());
+    result += vector.mid(0, position);
+    result += replacement;
+    result += vector.mid(position + count);
+    vector = result;
+}
+
+LineChanges::LineChanges(QObject *parent) : QObject(parent)
+{
+    m_timer.setSingleShot(true);
+    m_timer.setInterval(300);
+    QObject::connect(&m_timer, &QTimer::timeout, this, &LineChanges::update);
+    QObject::connect(&m_watcher, &QFutureWatcher<QVector<unsigned char>>::finished,
+                     this, &LineChanges::onDiffFinished);
+}
+
+TextBuffer *LineChanges::buffer() const
+{
+    return m_buffer;
+}
+
+void LineChanges::setBuffer(TextBuffer *buffer)
+{
+    if (m_buffer == buffer)
+        return;
+
+    if (m_buffer)
+        QObject::disconnect(m_buffer, nullptr, this, nullptr);
+
+    m_buffer = buffer;
+    if (m_buffer)
+    {
+        QObject::connect(m_buffer, &TextBuffer::loadingChanged, this, &LineChanges::onLoadingChanged);
+        QObject::connect(m_buffer, &TextBuffer::saved, this, &LineChanges::onSaved);
+        QObject::connect(m_buffer, &TextBuffer::contentsEdited, this, &LineChanges::onContentsEdited);
+    }
+
+    onSaved();
+    emit bufferChanged();
+}
+
+int LineChanges::revision() const
+{
+    return m_revision;
+}
+
+int LineChanges::marker(int lineIndex) const
+{
+    if (lineIndex < 0 || lineIndex >= m_markers.count())
+        return Unchanged;
+
+    return m_markers.at(lineIndex);
+}
+
+void LineChanges::onLoadingChanged()
+{
+    if (!m_buffer->loading())
+        onSaved();
+}
+
+// The document holds what is on disk now
+void LineChanges::onSaved()
+{
+    m_generation++;
+    m_timer.stop();
+    rehashAll();
+    m_savedLines = m_lines;
+    setMarkers(QVector<unsigned char>(m_lines.count(), Unchanged));
+}
+
+void LineChanges::onContentsEdited(int position, int charsRemoved, int charsAdded)
+{
+    QTextDocument *document = m_buffer->textDocument();
+    if (!document || m_buffer->loading())
+        return;
+
+    m_generation++;
+    m_timer.start();
+
+    // loads and resyncs report the whole text as added, a plain rehash is
+    // enough and their lines are not edited ones
+    if (position == 0 && charsRemoved == 0 && charsAdded == m_buffer->length())
+    {
+        rehashAll();
+        setMarkers(QVector<unsigned char>(m_lines.count(), Unchanged));
+        return;
+    }
+
+    // blocks first to last replace first to first + removedLines
+    const int first = document->findBlock(position).blockNumber();
+    const int last = document->findBlock(position + charsAdded).blockNumber();
+    const int removedLines = (last - first) - (document->blockCount() - m_lines.count());
+    if (first < 0 || last < first || removedLines < 0 || first + removedLines >= m_lines.count())
+    {
+        rehashAll();
+        setMarkers(QVector<unsigned char>(m_lines.count(), Unchanged));
+        return;
+    }
+
+    QVector<quint64> hashes;
+    hashes.reserve(last - first + 1);
+    for (QTextBlock block = document->findBlockByNumber(first); block.isValid() && block.blockNumber() <= last;
+         block = block.next())
+        hashes += lineHash(block);
+
+    // until the diff is back, the edited lines count as modified and the
+    // ones beyond the replaced lines as added
+    QVector<unsigned char> markers(hashes.count(), Modified);
+    for (int i = removedLines + 1; i < markers.count(); ++i)
+        markers[i] = Added;
+
+    const bool changed = removedLines > 0 || hashes.count() > 1 || m_markers.at(first) == Unchanged;
+    splice(m_lines, first, removedLines + 1, hashes);
+    splice(m_markers, first, removedLines + 1, markers);
+    if (changed)
+    {
+        m_revision++;
+        emit markersChanged();
+    }
+}
+
+void LineChanges::update()
+{
+    // restarted once the running diff is back
+    if (m_watcher.isRunning())
+        return;
+
+    m_diffGeneration = m_generation;
+    m_watcher.setFuture(QtConcurrent::run(&LineChanges::diff, m_savedLines, m_lines));
+}
+
+void LineChanges::onDiffFinished()
+{
+    if (m_diffGeneration != m_generation)
+    {
+        // the lines changed while it ran
+        if (!m_timer.isActive())
+            update();
+        return;
+    }
+
+    setMarkers(m_watcher.result());
+}
+
+void LineChanges::rehashAll()
+{
+    m_lines.clear();
+
+    QTextDocument *document = m_buffer ? m_buffer->textDocument() : nullptr;
+    if (!document)
+        return;
+
+    m_lines.reserve(document->blockCount());
+    for (QTextBlock block = document->firstBlock(); block.isValid(); block = block.next())
+        m_lines += lineHash(block);
+}
+
+void LineChanges::setMarkers(const QVector<unsigned char> &markers)
+{
+    if (markers == m_markers)
+        return;
+
+    m_markers = markers;
+    m_revision++;
+    emit markersChanged();
+}
+
+// Runs in a worker thread. Lines the two share at their start and end are
+// skipped, the shortest edit script between the rest comes from Myers'
+// greedy algorithm, keeping every step's furthest reaching paths to walk
+// it back. Each run of removed and inserted lines between two common ones
+// marks its first inserted lines as modified, one per removed line, and
+// the others as added; a run that only removes marks the line after it.
+QVector<unsigned char> LineChanges::diff(const QVector<quint64> &saved, const QVector<quint64> &current)
+{
+    QVector<unsigned char> markers(current.count(), Unchanged);
+
+    int prefix = 0;
+    while (prefix < saved.count() && prefix < current.count() && saved.at(prefix) == current.at(prefix))
+        prefix++;
+    int suffix = 0;
+    while (suffix < saved.count() - prefix && suffix < current.count() - prefix
+           && saved.at(saved.count() - 1 - suffix) == current.at(current.count() - 1 - suffix))
+        suffix++;
+
+    const quint64 *a = saved.constData() + prefix;
+    const quint64 *b = current.constData() + prefix;
+    const int n = saved.count() - prefix - suffix;
+    const int m = current.count() - prefix - suffix;
+
+    // common lines of the middle, false for the ones removed or inserted
+    QVector<bool> keptA(n, false);
+    QVector<bool> keptB(m, false);
+
+    const int limit = qMin(n + m, MaximumDistance);
+    const int offset = limit + 1;
+    QVector<int> v(2 * limit + 3, 0);
+    QVector<int> trace;     // v of step d at d * d, for k from -d to d
+    int distance = -1;
+
+    for (int d = 0; d <= limit && distance < 0; ++d)
+    {
+        for (int k = -d; k <= d; k += 2)
+        {
+            int x = (k == -d || (k != d && v.at(offset + k - 1) < v.at(offset + k + 1))) ?
+                        v.at(offset + k + 1) : v.at(offset + k - 1) + 1;
+            int y = x - k;
+            while (x < n && y < m && a[x] == b[y])
+            {
+                ++x;
+                ++y;
+            }
+            v[offset + k] = x;
+            if (x >= n && y >= m)
+            {
+                distance = d;
+                break;
+            }
+        }
+        trace += v.mid(offset - d, 2 * d + 1);
+    }
+
+    if (distance >= 0)
+    {
+        int x = n;
+        int y = m;
+        for (int d = distance; d > 0; --d)
+        {
+            const int *previous = trace.constData() + (d - 1) * (d - 1) + (d - 1);
+            const int k = x - y;
+            const int previousK = (k == -d || (k != d && previous[k - 1] < previous[k + 1])) ? k + 1 : k - 1;
+            const int previousX = previous[previousK];
+            const int previousY = previousX - previousK;
+            while (x > previousX && y > previousY)
+            {
+                --x;
+                --y;
+                keptA[x] = true;
+                keptB[y] = true;
+            }
+            x = previousX;
+            y = previousY;
+        }
+        while (x > 0 && y > 0)
+        {
+            --x;
+            --y;
+            keptA[x] = true;
+            keptB[y] = true;
+        }
+    }
+
+    int i = 0;
+    int j = 0;
+    while (i < n || j < m)
+    {
+        if (i < n && j < m && keptA.at(i) && keptB.at(j))
+        {
+            ++i;
+            ++j;
+            continue;
+        }
+
+        int removed = 0;
+        while (i < n && !keptA.at(i))
+        {
+            ++i;
+            ++removed;
+        }
+        int inserted = 0;
+        while (j < m && !keptB.at(j))
+        {
+            markers[prefix + j] = (inserted < removed) ? Modified : Added;
+            ++j;
+            ++inserted;
+        }
+
+        if (inserted == 0 && removed == 0)
+            break;
+        if (inserted == 0 && !markers.isEmpty())
+            markers[qMin(prefix + j, markers.count() - 1)] = Removed;
+    }
+
+    return markers;
+}
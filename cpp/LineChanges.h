@@ -0,0 +1,71 @@
+#ifndef LINECHANGES_H
+#define LINECHANGES_H
+
+#include <QFutureWatcher>
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+#include "TextBuffer.h"
+
+// Lines of the edited file that differ from the text it was last loaded or
+// saved with, for the line number gutter. Both texts are kept as one hash
+// per line; edits only rehash the lines they touched. A short while after
+// the last edit the two hash lists are diffed on a worker thread (Myers'
+// O(ND) algorithm on what remains between their common start and end), in
+// the meantime the edited lines are marked right away.
+class LineChanges : public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY(TextBuffer* buffer READ buffer WRITE setBuffer NOTIFY bufferChanged)
+    // bumped whenever the markers change, for bindings on marker() to depend on
+    Q_PROPERTY(int revision READ revision NOTIFY markersChanged)
+
+public:
+    enum Marker {
+        Unchanged,
+        Added,
+        Modified,
+        Removed     // lines were removed right before this one, or after the last line
+    };
+    Q_ENUM(Marker)
+
+    explicit LineChanges(QObject *parent = nullptr);
+
+    TextBuffer *buffer() const;
+    void setBuffer(TextBuffer *buffer);
+
+    int revision() const;
+
+    // takes a block number, the gutter's line index
+    Q_INVOKABLE int marker(int lineIndex) const;
+
+private slots:
+    void onLoadingChanged();
+    void onSaved();
+    void onContentsEdited(int position, int charsRemoved, int charsAdded);
+    void update();
+    void onDiffFinished();
+
+private:
+    void rehashAll();
+    void setMarkers(const QVector<unsigned char> &markers);
+    static QVector<unsigned char> diff(const QVector<quint64> &saved, const QVector<quint64> &current);
+
+    TextBuffer *m_buffer = nullptr;
+    QVector<quint64> m_savedLines;
+    QVector<quint64> m_lines;
+    QVector<unsigned char> m_markers;   // one per line of m_lines
+    int m_revision = 0;
+
+    QTimer m_timer;
+    QFutureWatcher<QVector<unsigned char>> m_watcher;
+    int m_generation = 0;           // bumped by every edit
+    int m_diffGeneration = 0;       // the generation m_watcher's diff was started for
+
+signals:
+    void bufferChanged();
+    void markersChanged();
+};
+
+#endif // LINECHANGES_H
@@ -0,0 +1,256 @@
+#include "MappedFile.h"
+
+#include <QDebug>
+#include <QSaveFile>
+#include <QtAlgorithms>
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+static inline char foldCase(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? char(c + ('a' - 'A')) : c;
+}
+
+MappedFile::MappedFile(QObject *parent) : QObject(parent)
+{
+
+}
+
+MappedFile::~MappedFile()
+{
+    unmap();
+}
+
+QString MappedFile::filePath() const
+{
+    return m_filePath;
+}
+
+void MappedFile::setFilePath(const QString &filePath)
+{
+    if (m_filePath == filePath)
+        return;
+
+    unmap();
+    m_filePath = filePath;
+    if (!m_filePath.isEmpty())
+        map();
+
+    emit filePathChanged();
+    emit mappedChanged();
+}
+
+bool MappedFile::mapped() const
+{
+    return m_file.isOpen();
+}
+
+int MappedFile::lineCount() const
+{
+    return m_lineStarts.count();
+}
+
+QString MappedFile::text(int firstLine, int count) const
+{
+    firstLine = qBound(0, firstLine, lineCount());
+    count = qBound(0, count, lineCount() - firstLine);
+    if (count == 0)
+        return QString();
+
+    const qint64 begin = lineStart(firstLine);
+    const qint64 end = lineEnd(firstLine + count - 1);
+    QString text = QString::fromUtf8(reinterpret_cast<const char*>(m_data) + begin, int(end - begin));
+    text.remove(QLatin1Char('\r'));
+    return text;
+}
+
+int MappedFile::find(const QString &text, int fromLine, bool caseSensitive) const
+{
+    QByteArray needle = text.toUtf8();
+    if (needle.isEmpty() || !mapped())
+        return -1;
+
+    if (!caseSensitive)
+    {
+        for (char &c : needle)
+            c = foldCase(c);
+    }
+
+    const qint64 from = lineStart(qBound(0, fromLine, lineCount() - 1));
+    qint64 position = indexOf(needle, from, m_size, caseSensitive);
+    if (position < 0)
+        position = indexOf(needle, 0, qMin(from + needle.length() - 1, m_size), caseSensitive);
+    if (position < 0)
+        return -1;
+
+    return int(std::upper_bound(m_lineStarts.constBegin(), m_lineStarts.constEnd(), position)
+               - m_lineStarts.constBegin()) - 1;
+}
+
+bool MappedFile::replaceLines(int firstLine, int count, const QString &text)
+{
+    if (!mapped() || firstLine < 0 || firstLine >= lineCount())
+        return false;
+
+    count = qBound(0, count, lineCount() - firstLine);
+    const bool toEnd = (firstLine + count >= lineCount());
+    const qint64 begin = lineStart(firstLine);
+    const qint64 end = toEnd ? m_size : lineStart(firstLine + count);
+
+    QSaveFile file(m_filePath);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        qWarning() << "Unable to write" << m_filePath;
+        return false;
+    }
+
+    const char *data = reinterpret_cast<const char*>(m_data);
+    file.write(data, begin);
+    file.write(text.toUtf8());
+    if (!toEnd)
+        file.write("\n", 1);
+    file.write(data + end, m_size - end);
+
+    // the new file replaces the mapped one
+    unmap();
+    const bool written = file.commit();
+    if (!written)
+        qWarning() << "Unable to write" << m_filePath;
+
+    map();
+    emit mappedChanged();
+    return written;
+}
+
+// Offsets every line of data starts at, the first line included
+QVector<qint64> MappedFile::indexLines(const uchar *data, qint64 size)
+{
+    QVector<qint64> starts;
+    starts.reserve(int(qMin<qint64>(size / 32 + 1, 1 << 24)));
+    starts += 0;
+
+    qint64 i = 0;
+#if defined(__SSE2__)
+    // 16 bytes per compare, the mask has a bit set for every newline among them
+    const __m128i newline = _mm_set1_epi8('\n');
+    for (; i + 16 <= size; i += 16)
+    {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        uint mask = uint(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, newline)));
+        while (mask)
+        {
+            starts += i + qCountTrailingZeroBits(mask) + 1;
+            mask &= mask - 1;
+        }
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    // NEON has no byte mask to walk, it skips the blocks without a newline
+    const uint8x16_t newline = vdupq_n_u8('\n');
+    for (; i + 16 <= size; i += 16)
+    {
+        if (vmaxvq_u8(vceqq_u8(vld1q_u8(data + i), newline)) == 0)
+            continue;
+
+        for (int j = 0; j < 16; ++j)
+        {
+            if (data[i + j] == '\n')
+                starts += i + j + 1;
+        }
+    }
+#endif
+    for (; i < size; ++i)
+    {
+        if (data[i] == '\n')
+            starts += i + 1;
+    }
+
+    return starts;
+}
+
+bool MappedFile::map()
+{
+    m_file.setFileName(m_filePath);
+    if (!m_file.open(QIODevice::ReadOnly))
+    {
+        qWarning() << "Unable to open" << m_filePath;
+        return false;
+    }
+
+    // an empty file has nothing to map, but still one empty line
+    m_size = m_file.size();
+    m_data = (m_size > 0) ? m_file.map(0, m_size) : nullptr;
+    if (m_size > 0 && !m_data)
+    {
+        qWarning() << "Unable to map" << m_filePath;
+        m_file.close();
+        m_size = 0;
+        return false;
+    }
+
+    m_lineStarts = indexLines(m_data, m_size);
+    return true;
+}
+
+void MappedFile::unmap()
+{
+    if (m_data)
+        m_file.unmap(m_data);
+    m_data = nullptr;
+    m_size = 0;
+    m_lineStarts.clear();
+    m_file.close();
+}
+
+qint64 MappedFile::lineStart(int line) const
+{
+    return m_lineStarts.at(line);
+}
+
+// Where the text of line ends, before its line break
+qint64 MappedFile::lineEnd(int line) const
+{
+    qint64 end = (line + 1 < lineCount()) ? m_lineStarts.at(line + 1) - 1 : m_size;
+    if (end > lineStart(line) && m_data[end - 1] == '\r')
+        end--;
+    return end;
+}
+
+qint64 MappedFile::indexOf(const QByteArray &needle, qint64 from, qint64 to, bool caseSensitive) const
+{
+    const char *data = reinterpret_cast<const char*>(m_data);
+    const int length = needle.length();
+
+    if (caseSensitive)
+    {
+        // memchr finds the candidates, it is vectorized in every libc worth the name
+        qint64 i = from;
+        while (i + length <= to)
+        {
+            const void *hit = std::memchr(data + i, needle.at(0), size_t(to - length + 1 - i));
+            if (!hit)
+                return -1;
+
+            i = static_cast<const char*>(hit) - data;
+            if (std::memcmp(data + i, needle.constData(), size_t(length)) == 0)
+                return i;
+            ++i;
+        }
+        return -1;
+    }
+
+    for (qint64 i = from; i + length <= to; ++i)
+    {
+        int j = 0;
+        while (j < length && foldCase(data[i + j]) == needle.at(j))
+            ++j;
+        if (j == length)
+            return i;
+    }
+    return -1;
+}
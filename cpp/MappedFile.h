@@ -0,0 +1,64 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <QFile>
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+// Read-only view of a file too large for the editor. The file is mapped
+// into memory instead of read, and only the offsets where its lines start
+// are kept, found with a vectorized newline scan. Lines are decoded from
+// UTF-8 when they are asked for, so the viewer only ever holds the window
+// it shows. Searching runs over the mapped bytes; a range of lines can be
+// replaced, which rewrites the file and maps it again.
+class MappedFile : public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY(QString filePath READ filePath WRITE setFilePath NOTIFY filePathChanged)
+    Q_PROPERTY(bool mapped READ mapped NOTIFY mappedChanged)
+    Q_PROPERTY(int lineCount READ lineCount NOTIFY mappedChanged)
+
+public:
+    // files from this size on open in the viewer instead of the editor
+    static const qint64 LargeFileSize = 4 * 1024 * 1024;
+
+    explicit MappedFile(QObject *parent = nullptr);
+    ~MappedFile();
+
+    QString filePath() const;
+    void setFilePath(const QString &filePath);
+
+    bool mapped() const;
+    int lineCount() const;
+
+    // lines [firstLine, firstLine + count) joined by '\n', without line breaks at the end
+    Q_INVOKABLE QString text(int firstLine, int count) const;
+    // the first line from fromLine on containing text, wrapping around
+    // to the start, -1 if there is none; case folding is ASCII only
+    Q_INVOKABLE int find(const QString &text, int fromLine, bool caseSensitive = false) const;
+    // replaces lines [firstLine, firstLine + count) with text on disk
+    Q_INVOKABLE bool replaceLines(int firstLine, int count, const QString &text);
+
+    static QVector<qint64> indexLines(const uchar *data, qint64 size);
+
+private:
+    bool map();
+    void unmap();
+    qint64 lineStart(int line) const;
+    qint64 lineEnd(int line) const;
+    qint64 indexOf(const QByteArray &needle, qint64 from, qint64 to, bool caseSensitive) const;
+
+    QString m_filePath;
+    QFile m_file;
+    uchar *m_data = nullptr;
+    qint64 m_size = 0;
+    QVector<qint64> m_lineStarts;       // byte offset of every line
+
+signals:
+    void filePathChanged();
+    void mappedChanged();
+};
+
+#endif // MAPPEDFILE_H
@@ -0,0 +1,532 @@
+#include "Minimap.h"
+#include "BlockData.h"
+
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#include <QQuickWindow>
+#include <QSGRendererInterface>
+#include <QSGSimpleTextureNode>
+#include <QTextBlock>
+#include <QTextDocument>
+#include <QtMath>
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+// Columns a tab advances to the next multiple of
+static const int TabColumns = 4;
+
+// QRgb is 0xAARRGGBB, QImage::Format_RGBA8888 keeps the bytes in R, G, B, A order
+static quint32 toRgba8888(QRgb rgb)
+{
+    const uchar bytes[4] = { uchar(qRed(rgb)), uchar(qGreen(rgb)), uchar(qBlue(rgb)), uchar(qAlpha(rgb)) };
+    quint32 pixel;
+    std::memcpy(&pixel, bytes, sizeof(pixel));
+    return pixel;
+}
+
+// OpenGL texture that uploads only the rows it was given since it was last
+// bound. The scene graph's own textures always upload a whole image.
+class MinimapTexture : public QSGTexture
+{
+public:
+    explicit MinimapTexture(const QSize &size) : m_size(size) {}
+
+    ~MinimapTexture()
+    {
+        QOpenGLContext *context = QOpenGLContext::currentContext();
+        if (m_id && context)
+            context->functions()->glDeleteTextures(1, &m_id);
+    }
+
+    // takes the rows [y, y + height) of image
+    void upload(const QImage &image, int y, int height)
+    {
+        m_pendingRows += height;
+        if (m_pendingRows >= m_size.height())
+        {
+            // not bound for a while, the rows would add up past the image
+            m_pending.clear();
+            m_pending += Rows { 0, image.copy() };
+            m_pendingRows = m_size.height();
+            return;
+        }
+        m_pending += Rows { y, image.copy(0, y, image.width(), height) };
+    }
+
+    int textureId() const override { return int(m_id); }
+    QSize textureSize() const override { return m_size; }
+    bool hasAlphaChannel() const override { return false; }
+    bool hasMipmaps() const override { return false; }
+
+    void bind() override
+    {
+        QOpenGLFunctions *gl = QOpenGLContext::currentContext()->functions();
+        const bool created = !m_id;
+        if (created)
+        {
+            gl->glGenTextures(1, &m_id);
+            gl->glBindTexture(GL_TEXTURE_2D, m_id);
+            gl->glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_size.width(), m_size.height(), 0,
+                             GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        }
+        else
+        {
+            gl->glBindTexture(GL_TEXTURE_2D, m_id);
+        }
+        updateBindOptions(created);
+
+        for (const Rows &rows : m_pending)
+            gl->glTexSubImage2D(GL_TEXTURE_2D, 0, 0, rows.y, rows.image.width(), rows.image.height(),
+                                GL_RGBA, GL_UNSIGNED_BYTE, rows.image.constBits());
+        m_pending.clear();
+        m_pendingRows = 0;
+    }
+
+private:
+    struct Rows
+    {
+        int y;
+        QImage image;
+    };
+
+    QSize m_size;
+    GLuint m_id = 0;
+    QVector<Rows> m_pending;
+    int m_pendingRows = 0;
+};
+
+// Owns the texture its two children, the ring before and after its seam,
+// draw from
+class MinimapNode : public QSGNode
+{
+public:
+    MinimapNode()
+    {
+        appendChildNode(&m_top);
+        appendChildNode(&m_bottom);
+        m_top.setFlag(OwnedByParent, false);
+        m_bottom.setFlag(OwnedByParent, false);
+        m_top.setFiltering(QSGTexture::Nearest);
+        m_bottom.setFiltering(QSGTexture::Nearest);
+    }
+
+    ~MinimapNode()
+    {
+        removeAllChildNodes();
+        delete m_texture;
+    }
+
+    QSGTexture *texture() const { return m_texture; }
+
+    void setTexture(QSGTexture *texture)
+    {
+        m_top.setTexture(texture);
+        m_bottom.setTexture(texture);
+        delete m_texture;
+        m_texture = texture;
+    }
+
+    QSGSimpleTextureNode *top() { return &m_top; }
+    QSGSimpleTextureNode *bottom() { return &m_bottom; }
+
+private:
+    QSGSimpleTextureNode m_top;
+    QSGSimpleTextureNode m_bottom;
+    QSGTexture *m_texture = nullptr;
+};
+
+Minimap::Minimap(QQuickItem *parent) : QQuickItem(parent)
+{
+    setFlag(ItemHasContents);
+}
+
+SyntaxHighlighter *Minimap::highlighter() const
+{
+    return m_highlighter;
+}
+
+void Minimap::setHighlighter(SyntaxHighlighter *highlighter)
+{
+    if (m_highlighter == highlighter)
+        return;
+
+    if (m_highlighter)
+        QObject::disconnect(m_highlighter, nullptr, this, nullptr);
+
+    m_highlighter = highlighter;
+    if (m_highlighter)
+    {
+        QObject::connect(m_highlighter, &SyntaxHighlighter::highlighterChanged, this, &Minimap::attach);
+
+        // the highlighter does not rehighlight for these itself
+        QObject::connect(m_highlighter, &SyntaxHighlighter::normalColorChanged, this, &Minimap::invalidate);
+        QObject::connect(m_highlighter, &SyntaxHighlighter::commentColorChanged, this, &Minimap::invalidate);
+        QObject::connect(m_highlighter, &SyntaxHighlighter::numberColorChanged, this, &Minimap::invalidate);
+        QObject::connect(m_highlighter, &SyntaxHighlighter::stringColorChanged, this, &Minimap::invalidate);
+        QObject::connect(m_highlighter, &SyntaxHighlighter::operatorColorChanged, this, &Minimap::invalidate);
+        QObject::connect(m_highlighter, &SyntaxHighlighter::keywordColorChanged, this, &Minimap::invalidate);
+        QObject::connect(m_highlighter, &SyntaxHighlighter::builtInColorChanged, this, &Minimap::invalidate);
+        QObject::connect(m_highlighter, &SyntaxHighlighter::itemColorChanged, this, &Minimap::invalidate);
+        QObject::connect(m_highlighter, &SyntaxHighlighter::propertyColorChanged, this, &Minimap::invalidate);
+    }
+
+    attach();
+    emit highlighterChanged();
+}
+
+QColor Minimap::color() const
+{
+    return m_color;
+}
+
+void Minimap::setColor(const QColor &color)
+{
+    if (m_color == color)
+        return;
+
+    m_color = color;
+    invalidate();
+    emit colorChanged();
+}
+
+int Minimap::pixelsPerLine() const
+{
+    return m_pixelsPerLine;
+}
+
+void Minimap::setPixelsPerLine(int pixelsPerLine)
+{
+    pixelsPerLine = qMax(1, pixelsPerLine);
+    if (m_pixelsPerLine == pixelsPerLine)
+        return;
+
+    m_pixelsPerLine = pixelsPerLine;
+    polish();
+    emit pixelsPerLineChanged();
+}
+
+qreal Minimap::viewportY() const
+{
+    return m_viewportY;
+}
+
+void Minimap::setViewportY(qreal viewportY)
+{
+    if (qFuzzyCompare(m_viewportY, viewportY))
+        return;
+
+    m_viewportY = viewportY;
+    polish();
+    emit viewportChanged();
+}
+
+qreal Minimap::viewportHeight() const
+{
+    return m_viewportHeight;
+}
+
+void Minimap::setViewportHeight(qreal viewportHeight)
+{
+    if (qFuzzyCompare(m_viewportHeight, viewportHeight))
+        return;
+
+    m_viewportHeight = viewportHeight;
+    polish();
+    emit viewportChanged();
+}
+
+qreal Minimap::contentHeight() const
+{
+    return m_contentHeight;
+}
+
+void Minimap::setContentHeight(qreal contentHeight)
+{
+    if (qFuzzyCompare(m_contentHeight, contentHeight))
+        return;
+
+    m_contentHeight = contentHeight;
+    polish();
+    emit viewportChanged();
+}
+
+qreal Minimap::indicatorY() const
+{
+    return m_indicatorY;
+}
+
+qreal Minimap::indicatorHeight() const
+{
+    return m_indicatorHeight;
+}
+
+qreal Minimap::contentYAt(qreal y) const
+{
+    if (!m_document || m_contentHeight <= 0)
+        return 0;
+
+    const qreal line = m_firstLine + y * ratio() / m_pixelsPerLine;
+    const qreal contentY = line / m_document->blockCount() * m_contentHeight - m_viewportHeight / 2;
+    return qBound<qreal>(0, contentY, qMax<qreal>(0, m_contentHeight - m_viewportHeight));
+}
+
+void Minimap::geometryChanged(const QRectF &newGeometry, const QRectF &oldGeometry)
+{
+    QQuickItem::geometryChanged(newGeometry, oldGeometry);
+    if (newGeometry.size() != oldGeometry.size())
+        polish();
+}
+
+void Minimap::attach()
+{
+    QTextDocument *document = (m_highlighter && m_highlighter->highlighter()) ?
+                m_highlighter->highlighter()->document() : nullptr;
+    if (m_document == document)
+        return;
+
+    if (m_document)
+        QObject::disconnect(m_document, &QTextDocument::contentsChange, this, &Minimap::onContentsChange);
+
+    // connected after the highlighter, the contentsChange it sends for
+    // every re-lexed range repaints those lines
+    m_document = document;
+    if (m_document)
+    {
+        QObject::connect(m_document, &QTextDocument::contentsChange, this, &Minimap::onContentsChange);
+        m_lineCount = m_document->blockCount();
+    }
+
+    invalidate();
+}
+
+void Minimap::onContentsChange(int position, int charsRemoved, int charsAdded)
+{
+    Q_UNUSED(charsRemoved)
+
+    const int lineCount = m_document->blockCount();
+    const int first = qMax(m_document->findBlock(position).blockNumber(), 0);
+    int last = m_document->findBlock(position + charsAdded).blockNumber();
+
+    // the lines below moved to other rows
+    if (last < 0 || lineCount != m_lineCount)
+        last = INT_MAX;
+    m_lineCount = lineCount;
+
+    for (int &line : m_rowLines)
+    {
+        if (line >= first && line <= last)
+            line = -1;
+    }
+    polish();
+}
+
+void Minimap::invalidate()
+{
+    m_rowLines.fill(-1);
+    polish();
+}
+
+qreal Minimap::ratio() const
+{
+    return window() ? window()->effectiveDevicePixelRatio() : 1;
+}
+
+// The line at the top: the minimap scrolls through the lines that do not
+// fit as the viewport scrolls through the document
+int Minimap::firstLine() const
+{
+    const int hidden = m_document->blockCount() - m_rowLines.count();
+    const qreal scrollable = m_contentHeight - m_viewportHeight;
+    if (hidden <= 0 || scrollable <= 0)
+        return 0;
+
+    return qRound(hidden * qBound<qreal>(0, m_viewportY / scrollable, 1));
+}
+
+void Minimap::paintLine(const QTextBlock &block, int row)
+{
+    const int width = m_image.width();
+    const int y = row * m_pixelsPerLine;
+    const int textRows = (m_pixelsPerLine > 1) ? m_pixelsPerLine - 1 : 1;
+
+    const quint32 background = toRgba8888(m_color.rgba());
+    for (int i = 0; i < m_pixelsPerLine; ++i)
+    {
+        quint32 *pixels = reinterpret_cast<quint32*>(m_image.scanLine(y + i));
+        std::fill(pixels, pixels + width, background);
+    }
+
+    QMLHighlighter *highlighter = m_highlighter->highlighter();
+    quint32 colors[QMLHighlighter::Error + 1];
+    for (int component = 0; component <= QMLHighlighter::Error; ++component)
+        colors[component] = toRgba8888(highlighter->color(QMLHighlighter::ColorComponent(component)).rgba());
+
+    const QString text = block.text();
+    QVector<unsigned char> components(text.length(), QMLHighlighter::Normal);
+    const BlockData *blockData = static_cast<const BlockData*>(block.userData());
+    if (blockData)
+    {
+        for (const FormatSpan &span : blockData->spans)
+        {
+            const int end = qMin(span.start + span.length, text.length());
+            for (int i = span.start; i < end; ++i)
+                components[i] = span.component;
+        }
+    }
+
+    int column = 0;
+    for (int i = 0; i < text.length() && column < width; ++i)
+    {
+        const QChar character = text.at(i);
+        if (character == QLatin1Char('\t'))
+        {
+            column = (column / TabColumns + 1) * TabColumns;
+            continue;
+        }
+
+        if (!character.isSpace())
+        {
+            for (int j = 0; j < textRows; ++j)
+                reinterpret_cast<quint32*>(m_image.scanLine(y + j))[column] = colors[components.at(i)];
+        }
+        column++;
+    }
+}
+
+// Runs in the GUI thread before every sync: paints the lines that scrolled
+// in or changed into their ring rows
+void Minimap::updatePolish()
+{
+    if (!m_document || !m_highlighter->highlighter() || width() <= 0 || height() <= 0)
+    {
+        m_image = QImage();
+        m_shownLines = 0;
+        update();
+        return;
+    }
+
+    const qreal ratio = this->ratio();
+    const int rows = qMax(1, int(height() * ratio) / m_pixelsPerLine);
+    const QSize size(qMax(1, qCeil(width() * ratio)), rows * m_pixelsPerLine);
+    if (m_image.size() != size)
+    {
+        m_image = QImage(size, QImage::Format_RGBA8888);
+        m_image.fill(m_color);
+        m_rowLines = QVector<int>(rows, -1);
+        m_paintedRows.clear();
+        m_resized = true;
+    }
+
+    const int lineCount = m_document->blockCount();
+    m_firstLine = firstLine();
+    m_shownLines = qMin(rows, lineCount - m_firstLine);
+
+    QTextBlock block = m_document->findBlockByNumber(m_firstLine);
+    for (int line = m_firstLine; line < m_firstLine + m_shownLines && block.isValid(); ++line, block = block.next())
+    {
+        const int row = line % rows;
+        if (m_rowLines.at(row) == line)
+            continue;
+
+        paintLine(block, row);
+        m_rowLines[row] = line;
+        m_paintedRows += row;
+    }
+
+    // no sync for a while, uploading it all is cheaper by then
+    if (m_paintedRows.count() > rows)
+    {
+        m_paintedRows.clear();
+        m_resized = true;
+    }
+
+    const qreal lineHeight = m_pixelsPerLine / ratio;
+    qreal indicatorY = 0;
+    qreal indicatorHeight = m_shownLines * lineHeight;
+    if (m_contentHeight > 0)
+    {
+        indicatorY = (m_viewportY / m_contentHeight * lineCount - m_firstLine) * lineHeight;
+        indicatorHeight = qMin<qreal>(m_viewportHeight / m_contentHeight, 1) * lineCount * lineHeight;
+    }
+    if (!qFuzzyCompare(m_indicatorY, indicatorY) || !qFuzzyCompare(m_indicatorHeight, indicatorHeight))
+    {
+        m_indicatorY = indicatorY;
+        m_indicatorHeight = indicatorHeight;
+        emit indicatorChanged();
+    }
+
+    update();
+}
+
+// Runs in the render thread while the GUI thread waits
+QSGNode *Minimap::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data)
+{
+    Q_UNUSED(data)
+
+    MinimapNode *node = static_cast<MinimapNode*>(oldNode);
+    if (m_image.isNull() || m_shownLines <= 0)
+    {
+        delete node;
+        m_resized = true;
+        return nullptr;
+    }
+
+    if (!node)
+    {
+        node = new MinimapNode;
+        m_resized = true;
+    }
+
+    // other graphics APIs get the whole image again
+    const bool openGL = window()->rendererInterface()->graphicsApi() == QSGRendererInterface::OpenGL;
+    if (m_resized || (!openGL && !m_paintedRows.isEmpty()))
+    {
+        if (openGL)
+        {
+            MinimapTexture *texture = new MinimapTexture(m_image.size());
+            texture->upload(m_image, 0, m_image.height());
+            node->setTexture(texture);
+        }
+        else
+        {
+            node->setTexture(window()->createTextureFromImage(m_image));
+        }
+        m_resized = false;
+    }
+    else if (!m_paintedRows.isEmpty())
+    {
+        // one upload per run of adjacent rows
+        std::sort(m_paintedRows.begin(), m_paintedRows.end());
+        MinimapTexture *texture = static_cast<MinimapTexture*>(node->texture());
+        int i = 0;
+        while (i < m_paintedRows.count())
+        {
+            int end = i + 1;
+            while (end < m_paintedRows.count() && m_paintedRows.at(end) <= m_paintedRows.at(end - 1) + 1)
+                end++;
+
+            const int first = m_paintedRows.at(i);
+            const int count = m_paintedRows.at(end - 1) - first + 1;
+            texture->upload(m_image, first * m_pixelsPerLine, count * m_pixelsPerLine);
+            i = end;
+        }
+    }
+    m_paintedRows.clear();
+
+    // the shown lines start at the ring row of the first one and wrap
+    // around to row 0 past the last row
+    const int rows = m_rowLines.count();
+    const int seam = m_firstLine % rows;
+    const int topLines = qMin(m_shownLines, rows - seam);
+    const int bottomLines = m_shownLines - topLines;
+    const qreal lineHeight = m_pixelsPerLine / ratio();
+    const int imageWidth = m_image.width();
+
+    node->top()->setSourceRect(0, seam * m_pixelsPerLine, imageWidth, topLines * m_pixelsPerLine);
+    node->top()->setRect(0, 0, width(), topLines * lineHeight);
+    node->bottom()->setSourceRect(0, 0, imageWidth, bottomLines * m_pixelsPerLine);
+    node->bottom()->setRect(0, topLines * lineHeight, width(), bottomLines * lineHeight);
+
+    return node;
+}
@@ -0,0 +1,110 @@
+#ifndef MINIMAP_H
+#define MINIMAP_H
+
+#include <QColor>
+#include <QImage>
+#include <QPointer>
+#include <QQuickItem>
+#include <QVector>
+#include "SyntaxHighlighter.h"
+
+class QTextBlock;
+class QTextDocument;
+
+// Overview of the edited document, a few device pixels per line and one
+// per character, coloured from the spans the highlighter's lexer left on
+// every block (see BlockData). Long documents do not fit, the strip then
+// shows the lines around the viewport and scrolls along with it. Lines go
+// to the rows of an image used as a ring: row (line % rows), so scrolling
+// only paints the lines it brings in, and an edit or a re-lex only paints
+// the lines it changed (the lines below it as well when it added or
+// removed some). The image is a single texture and only the rows painted
+// since the last frame are uploaded.
+class Minimap : public QQuickItem
+{
+    Q_OBJECT
+
+    Q_PROPERTY(SyntaxHighlighter* highlighter READ highlighter WRITE setHighlighter NOTIFY highlighterChanged)
+    Q_PROPERTY(QColor color READ color WRITE setColor NOTIFY colorChanged)
+    // device pixels, lines taller than one pixel leave a gap below the text
+    Q_PROPERTY(int pixelsPerLine READ pixelsPerLine WRITE setPixelsPerLine NOTIFY pixelsPerLineChanged)
+
+    // the editor's flickable
+    Q_PROPERTY(qreal viewportY READ viewportY WRITE setViewportY NOTIFY viewportChanged)
+    Q_PROPERTY(qreal viewportHeight READ viewportHeight WRITE setViewportHeight NOTIFY viewportChanged)
+    Q_PROPERTY(qreal contentHeight READ contentHeight WRITE setContentHeight NOTIFY viewportChanged)
+
+    // where the viewport is on the minimap
+    Q_PROPERTY(qreal indicatorY READ indicatorY NOTIFY indicatorChanged)
+    Q_PROPERTY(qreal indicatorHeight READ indicatorHeight NOTIFY indicatorChanged)
+
+public:
+    explicit Minimap(QQuickItem *parent = nullptr);
+
+    SyntaxHighlighter *highlighter() const;
+    void setHighlighter(SyntaxHighlighter *highlighter);
+
+    QColor color() const;
+    void setColor(const QColor &color);
+
+    int pixelsPerLine() const;
+    void setPixelsPerLine(int pixelsPerLine);
+
+    qreal viewportY() const;
+    void setViewportY(qreal viewportY);
+
+    qreal viewportHeight() const;
+    void setViewportHeight(qreal viewportHeight);
+
+    qreal contentHeight() const;
+    void setContentHeight(qreal contentHeight);
+
+    qreal indicatorY() const;
+    qreal indicatorHeight() const;
+
+    // the contentY that centres the viewport on the line at y
+    Q_INVOKABLE qreal contentYAt(qreal y) const;
+
+protected:
+    void geometryChanged(const QRectF &newGeometry, const QRectF &oldGeometry) override;
+    void updatePolish() override;
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data) override;
+
+private slots:
+    void attach();
+    void onContentsChange(int position, int charsRemoved, int charsAdded);
+    void invalidate();
+
+private:
+    qreal ratio() const;
+    int firstLine() const;
+    void paintLine(const QTextBlock &block, int row);
+
+    SyntaxHighlighter *m_highlighter = nullptr;
+    QPointer<QTextDocument> m_document;
+    QColor m_color;
+    int m_pixelsPerLine = 2;
+
+    qreal m_viewportY = 0;
+    qreal m_viewportHeight = 0;
+    qreal m_contentHeight = 0;
+    qreal m_indicatorY = 0;
+    qreal m_indicatorHeight = 0;
+
+    QImage m_image;                 // the ring, pixelsPerLine rows of pixels per line
+    QVector<int> m_rowLines;        // the line painted in each ring row, -1 for none
+    QVector<int> m_paintedRows;     // ring rows painted since the last sync
+    bool m_resized = true;          // the texture has to be made again
+    int m_lineCount = 0;
+    int m_firstLine = 0;            // the line at the top of the minimap
+    int m_shownLines = 0;
+
+signals:
+    void highlighterChanged();
+    void colorChanged();
+    void pixelsPerLineChanged();
+    void viewportChanged();
+    void indicatorChanged();
+};
+
+#endif // MINIMAP_H
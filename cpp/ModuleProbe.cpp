@@ -0,0 +1,293 @@
+#include "ModuleProbe.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QQmlComponent>
+#include <QQmlEngine>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QtConcurrent>
+
+ModuleProbe::ModuleProbe(QObject *parent) :
+    QObject(parent),
+    m_cacheLoaded(false),
+    m_cacheDirty(false),
+    m_pending(0)
+{
+}
+
+void ModuleProbe::probe(const QVariantList &modules)
+{
+    if (running())
+        return;
+
+    loadCache();
+
+    QStringList importPaths;
+    QQmlEngine *engine = qmlEngine(this);
+    if (engine)
+    {
+        foreach (QString path, engine->importPathList()) {
+            if (path.startsWith("qrc:"))
+                path.remove(0, 3);
+            importPaths << path;
+        }
+    }
+
+    QList<QPair<QString, QString>> uncached;
+
+    foreach (const QVariant &entry, modules) {
+        const QVariantMap map = entry.toMap();
+        const QString module = map.value("module").toString();
+        const QString version = map.value("version").toString();
+
+        const QJsonObject cached = m_cache.value(cacheKey(module, version)).toObject();
+        if (!cached.isEmpty())
+            emit probed(module, cached.value("available").toBool(), cached.value("version").toString());
+        else
+            uncached.append(qMakePair(module, version));
+    }
+
+    if (uncached.isEmpty())
+    {
+        emit finished();
+        return;
+    }
+
+    m_pending = uncached.count();
+    m_notFound.clear();
+    emit runningChanged();
+
+    // Every probe only touches the file system, so they can all run in parallel
+    // on the global thread pool without ever creating a QML object
+    for (int i = 0; i < uncached.count(); i++)
+    {
+        QFutureWatcher<ModuleProbeResult> *watcher = new QFutureWatcher<ModuleProbeResult>(this);
+        connect(watcher, &QFutureWatcher<ModuleProbeResult>::finished, this, [this, watcher]() {
+            handleResult(watcher->result());
+            watcher->deleteLater();
+        });
+        watcher->setFuture(QtConcurrent::run(&ModuleProbe::scan,
+                                             uncached.at(i).first,
+                                             uncached.at(i).second,
+                                             importPaths));
+    }
+}
+
+void ModuleProbe::clearCache()
+{
+    m_cache = QJsonObject();
+    m_cacheLoaded = true;
+    m_cacheDirty = false;
+    QFile::remove(cacheFilePath());
+}
+
+bool ModuleProbe::running() const
+{
+    return m_pending > 0;
+}
+
+ModuleProbeResult ModuleProbe::scan(const QString &module, const QString &version,
+                                    const QStringList &importPaths)
+{
+    ModuleProbeResult result;
+    result.module = module;
+    result.requestedVersion = version;
+
+    const int majorVersion = version.section('.', 0, 0).toInt();
+    const int minorVersion = version.section('.', 1, 1).toInt();
+    const QStringList dirs = candidateDirs(module, majorVersion);
+
+    foreach (const QString &importPath, importPaths) {
+        foreach (const QString &dir, dirs) {
+            const QString moduleDir = importPath + QDir::separator() + dir;
+            if (!QFileInfo::exists(moduleDir + QDir::separator() + "qmldir"))
+                continue;
+
+            // the unversioned directory may hold another major version,
+            // keep looking and leave the rest to the import probe
+            const QString highest = highestVersion(moduleDir, module, majorVersion);
+            if (highest.isEmpty())
+                continue;
+
+            // an older minor version does not have the types the
+            // requested one added, another import path may have a newer one
+            result.found = true;
+            result.version = highest;
+            if (highest.section('.', 1, 1).toInt() >= minorVersion)
+            {
+                result.available = true;
+                return result;
+            }
+        }
+    }
+
+    return result;
+}
+
+// Same lookup order the QML engine uses for "import A.B.C 2.x":
+// A/B/C.2, A/B.2/C, A.2/B/C, A/B/C
+QStringList ModuleProbe::candidateDirs(const QString &module, int majorVersion)
+{
+    const QStringList parts = module.split('.');
+    QStringList dirs;
+
+    for (int i = parts.count() - 1; i >= 0; i--)
+    {
+        QStringList versioned = parts;
+        versioned[i] += QString(".%1").arg(majorVersion);
+        dirs << versioned.join(QDir::separator());
+    }
+
+    dirs << parts.join(QDir::separator());
+    return dirs;
+}
+
+QString ModuleProbe::highestVersion(const QString &moduleDir, const QString &module, int majorVersion)
+{
+    int highestMinor = -1;
+
+    // C++ plugins list their exports ("QtQuick/Item 2.15") in plugins.qmltypes
+    QFile typesFile(moduleDir + QDir::separator() + "plugins.qmltypes");
+    if (typesFile.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        const QRegularExpression exportPattern(
+                    QString("\"%1/\\w+ (\\d+)\\.(\\d+)\"").arg(QRegularExpression::escape(module)));
+        QRegularExpressionMatchIterator it = exportPattern.globalMatch(QString::fromUtf8(typesFile.readAll()));
+        while (it.hasNext()) {
+            const QRegularExpressionMatch match = it.next();
+            if (match.captured(1).toInt() == majorVersion)
+                highestMinor = qMax(highestMinor, match.captured(2).toInt());
+        }
+    }
+
+    // QML-only modules version their types in the qmldir itself
+    if (highestMinor < 0)
+    {
+        QFile qmldirFile(moduleDir + QDir::separator() + "qmldir");
+        if (qmldirFile.open(QIODevice::ReadOnly | QIODevice::Text))
+        {
+            const QRegularExpression typePattern("^\\s*(?:singleton\\s+)?\\w+\\s+(\\d+)\\.(\\d+)\\s+\\S+\\.(?:qml|js)\\s*$");
+            while (!qmldirFile.atEnd()) {
+                const QRegularExpressionMatch match = typePattern.match(QString::fromUtf8(qmldirFile.readLine()));
+                if (match.hasMatch() && match.captured(1).toInt() == majorVersion)
+                    highestMinor = qMax(highestMinor, match.captured(2).toInt());
+            }
+        }
+    }
+
+    if (highestMinor < 0)
+        return QString();
+
+    return QString("%1.%2").arg(majorVersion).arg(highestMinor);
+}
+
+void ModuleProbe::handleResult(const ModuleProbeResult &result)
+{
+    if (result.found)
+    {
+        QJsonObject entry;
+        entry.insert("available", result.available);
+        entry.insert("version", result.version);
+        m_cache.insert(cacheKey(result.module, result.requestedVersion), entry);
+        m_cacheDirty = true;
+
+        emit probed(result.module, result.available, result.version);
+    }
+    else
+    {
+        m_notFound.append(result);
+    }
+
+    if (--m_pending == 0)
+        finishProbing();
+}
+
+void ModuleProbe::probeBuiltIn(const ModuleProbeResult &notFound)
+{
+    ModuleProbeResult result = notFound;
+
+    // Modules compiled into the engine (QtQml) have no qmldir. Compiling an
+    // import-only component resolves the import without creating an object.
+    QQmlEngine *engine = qmlEngine(this);
+    if (engine)
+    {
+        QQmlComponent component(engine);
+        component.setData(QString("import QtQml 2.0\nimport %1 %2\nQtObject {}\n")
+                          .arg(result.module, result.requestedVersion).toUtf8(), QUrl());
+        result.available = component.isReady();
+    }
+
+    result.version = result.requestedVersion;
+
+    QJsonObject entry;
+    entry.insert("available", result.available);
+    entry.insert("version", result.version);
+    m_cache.insert(cacheKey(result.module, result.requestedVersion), entry);
+    m_cacheDirty = true;
+
+    emit probed(result.module, result.available, result.version);
+}
+
+void ModuleProbe::finishProbing()
+{
+    foreach (const ModuleProbeResult &result, m_notFound)
+        probeBuiltIn(result);
+    m_notFound.clear();
+
+    saveCache();
+
+    emit runningChanged();
+    emit finished();
+}
+
+// bumped whenever what a probe finds changes, older caches are left behind
+static const int CacheVersion = 2;
+
+QString ModuleProbe::cacheFilePath() const
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) +
+            QDir::separator() + QString("modules-%1-%2.json").arg(qVersion()).arg(CacheVersion);
+}
+
+void ModuleProbe::loadCache()
+{
+    if (m_cacheLoaded)
+        return;
+
+    m_cacheLoaded = true;
+
+    QFile file(cacheFilePath());
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    m_cache = QJsonDocument::fromJson(file.readAll()).object();
+}
+
+void ModuleProbe::saveCache()
+{
+    if (!m_cacheDirty)
+        return;
+
+    QDir().mkpath(QFileInfo(cacheFilePath()).absolutePath());
+
+    QSaveFile file(cacheFilePath());
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        qWarning() << "Unable to write module cache" << cacheFilePath();
+        return;
+    }
+
+    file.write(QJsonDocument(m_cache).toJson(QJsonDocument::Compact));
+    if (file.commit())
+        m_cacheDirty = false;
+}
+
+QString ModuleProbe::cacheKey(const QString &module, const QString &version)
+{
+    return module + " " + version;
+}
@@ -0,0 +1,63 @@
+#ifndef MODULEPROBE_H
+#define MODULEPROBE_H
+
+#include <QObject>
+#include <QFutureWatcher>
+#include <QJsonObject>
+#include <QStringList>
+#include <QVariantList>
+
+struct ModuleProbeResult
+{
+    QString module;
+    QString requestedVersion;
+    QString version;        // the highest one installed, may be lower than requested
+    bool available = false;
+    // false when no qmldir exporting the requested major version was found,
+    // the module may still be built in or export nothing we can read
+    bool found = false;
+};
+
+class ModuleProbe : public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY(bool running READ running NOTIFY runningChanged)
+
+public:
+    explicit ModuleProbe(QObject *parent = nullptr);
+
+    // modules: list of { module: "QtQuick.Controls", version: "2.0" }
+    Q_INVOKABLE void probe(const QVariantList &modules);
+    Q_INVOKABLE void clearCache();
+
+    bool running() const;
+
+private:
+    static ModuleProbeResult scan(const QString &module, const QString &version,
+                                  const QStringList &importPaths);
+    static QStringList candidateDirs(const QString &module, int majorVersion);
+    static QString highestVersion(const QString &moduleDir, const QString &module, int majorVersion);
+
+    void handleResult(const ModuleProbeResult &result);
+    void probeBuiltIn(const ModuleProbeResult &result);
+    void finishProbing();
+
+    QString cacheFilePath() const;
+    void loadCache();
+    void saveCache();
+    static QString cacheKey(const QString &module, const QString &version);
+
+    QJsonObject m_cache;
+    bool m_cacheLoaded;
+    bool m_cacheDirty;
+    int m_pending;
+    QList<ModuleProbeResult> m_notFound;
+
+signals:
+    void probed(QString module, bool available, QString version);
+    void finished();
+    void runningChanged();
+};
+
+#endif // MODULEPROBE_H
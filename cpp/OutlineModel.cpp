@@ -0,0 +1,738 @@
+#include "OutlineModel.h"
+#include "BracketIndex.h"
+
+#include <QStringList>
+#include <QTextBlock>
+#include <QTextDocument>
+#include <QTimer>
+
+typedef OutlineModel::Node Node;
+
+// Walks the tokens of [from, to) across blocks
+class TokenStream
+{
+public:
+    TokenStream(QTextDocument *document, int from, int to) :
+        m_block(document->findBlock(from)),
+        m_data(nullptr),
+        m_index(0),
+        m_to(to)
+    {
+        m_data = BracketIndex::blockData(m_block);
+        if (m_data)
+        {
+            const int offset = from - m_block.position();
+            while (m_index < m_data->tokens.count() && m_data->tokens.at(m_index).offset < offset)
+                m_index++;
+        }
+        skipEmptyBlocks();
+    }
+
+    bool atEnd() const
+    {
+        return !m_block.isValid() || position() >= m_to;
+    }
+
+    const Token &token() const
+    {
+        return m_data->tokens.at(m_index);
+    }
+
+    QChar symbol() const
+    {
+        return atEnd() ? QChar() : token().symbol;
+    }
+
+    bool isIdentifier() const
+    {
+        return !atEnd() && token().isIdentifier();
+    }
+
+    int position() const
+    {
+        return m_block.position() + m_data->tokens.at(m_index).offset;
+    }
+
+    int line() const
+    {
+        return m_block.blockNumber();
+    }
+
+    QString text() const
+    {
+        return m_block.text().mid(token().offset, token().length);
+    }
+
+    void next()
+    {
+        m_index++;
+        skipEmptyBlocks();
+    }
+
+private:
+    void skipEmptyBlocks()
+    {
+        while (m_block.isValid() && (!m_data || m_index >= m_data->tokens.count()))
+        {
+            m_block = m_block.next();
+            m_data = BracketIndex::blockData(m_block);
+            m_index = 0;
+        }
+    }
+
+    QTextBlock m_block;
+    const BlockData *m_data;
+    int m_index;
+    int m_to;
+};
+
+// Recursive descent over the statements of an object body. It only has
+// to be good enough for an outline: anything it does not recognize is
+// skipped up to the end of the statement.
+class OutlineParser
+{
+public:
+    OutlineParser(QTextDocument *document, int from, int to) :
+        m_document(document),
+        m_stream(document, from, to)
+    {
+    }
+
+    void parseBody(Node *parent)
+    {
+        while (!m_stream.atEnd())
+        {
+            if (m_stream.symbol() == '}')
+            {
+                m_stream.next();
+                return;
+            }
+            parseStatement(parent);
+        }
+    }
+
+    // Statements of a body from where the stream starts, up to the first
+    // one past after that starts where one of starts (in document order,
+    // -1 for none) does. Returns its index, starts.count() when the body
+    // ended before.
+    int parseMembers(Node *parent, int after, const QVector<int> &starts)
+    {
+        int next = 0;
+        while (!m_stream.atEnd() && m_stream.symbol() != '}')
+        {
+            const int position = m_stream.position();
+            if (position > after)
+            {
+                while (next < starts.count() && starts.at(next) < position)
+                    next++;
+                if (next < starts.count() && starts.at(next) == position)
+                    return next;
+            }
+            parseStatement(parent);
+        }
+
+        return starts.count();
+    }
+
+private:
+    void parseStatement(Node *parent)
+    {
+        if (!m_stream.isIdentifier())
+        {
+            skipStatement();
+            return;
+        }
+
+        switch (m_stream.token().keyword) {
+        case Token::Readonly:
+        case Token::Default:
+        case Token::Required:
+            m_stream.next();
+            return;
+        case Token::Import:
+        case Token::Pragma:
+            skipStatement();
+            return;
+        case Token::Property:
+            parseProperty(parent);
+            return;
+        case Token::Signal:
+        case Token::Function:
+            parseDeclaration(parent, m_stream.token().keyword == Token::Signal ? Node::Signal : Node::Function);
+            return;
+        default:
+            break;
+        }
+
+        const int position = m_stream.position();
+        QString name;
+        bool handler = false;
+        bool lastWasIdentifier = false;
+        while (m_stream.isIdentifier() || m_stream.symbol() == '.')
+        {
+            // "Behavior on width" reads as one name
+            if (m_stream.isIdentifier() && lastWasIdentifier)
+                name += ' ';
+            lastWasIdentifier = m_stream.isIdentifier();
+            handler = m_stream.token().keyword == Token::Handler;
+            name += m_stream.text();
+            m_stream.next();
+        }
+
+        if (m_stream.symbol() == '{')
+        {
+            parseObject(parent, name, QString(), position);
+            return;
+        }
+
+        if (m_stream.symbol() != ':')
+        {
+            skipStatement();
+            return;
+        }
+        m_stream.next();
+
+        if (name == QLatin1String("id") && m_stream.isIdentifier())
+        {
+            parent->detail = m_stream.text();
+            parent->idCursor = QTextCursor(m_document);
+            parent->idCursor.setPosition(position);
+            skipStatement();
+        }
+        else if (handler)
+        {
+            addNode(parent, Node::Handler, name, QString(), position);
+            skipStatement();
+        }
+        else if (m_stream.symbol() == '[')
+        {
+            parseObjectList(parent, name);
+        }
+        else if (!parseObjectBinding(parent, name))
+        {
+            skipStatement();
+        }
+    }
+
+    // property <type> <name>[: value]
+    void parseProperty(Node *parent)
+    {
+        const int position = m_stream.position();
+        const int line = m_stream.line();
+        m_stream.next();
+
+        QStringList words;
+        while (m_stream.isIdentifier() && m_stream.line() == line)
+        {
+            words += m_stream.text();
+            m_stream.next();
+        }
+
+        if (words.count() >= 2)
+            addNode(parent, Node::Property, words.last(), words.first(), position);
+
+        if (m_stream.symbol() == ':')
+        {
+            m_stream.next();
+            if (words.isEmpty() || !parseObjectBinding(parent, words.last()))
+                skipStatement();
+        }
+        else if (m_stream.line() == line)
+        {
+            skipStatement();
+        }
+    }
+
+    void parseDeclaration(Node *parent, Node::Kind kind)
+    {
+        const int position = m_stream.position();
+        m_stream.next();
+        if (m_stream.isIdentifier())
+            addNode(parent, kind, m_stream.text(), QString(), position);
+        skipStatement();
+    }
+
+    // name: Type { ... }
+    bool parseObjectBinding(Node *parent, const QString &binding)
+    {
+        if (!m_stream.isIdentifier() || !m_stream.token().capitalized)
+            return false;
+
+        TokenStream lookahead = m_stream;
+        const int position = lookahead.position();
+        QString type;
+        while (lookahead.isIdentifier() || lookahead.symbol() == '.')
+        {
+            type += lookahead.text();
+            lookahead.next();
+        }
+
+        if (lookahead.symbol() != '{')
+            return false;
+
+        m_stream = lookahead;
+        parseObject(parent, type, binding, position);
+        return true;
+    }
+
+    // name: [ Type { ... }, Type { ... } ]
+    void parseObjectList(Node *parent, const QString &binding)
+    {
+        m_stream.next();
+        while (!m_stream.atEnd() && m_stream.symbol() != ']' && m_stream.symbol() != '}')
+        {
+            if (!parseObjectBinding(parent, binding))
+                m_stream.next();
+        }
+
+        if (m_stream.symbol() == ']')
+            m_stream.next();
+    }
+
+    void parseObject(Node *parent, const QString &type, const QString &binding, int position)
+    {
+        Node *node = addNode(parent, Node::Object, type, QString(), position);
+        node->binding = binding;
+        node->brace = QTextCursor(m_document);
+        node->brace.setPosition(m_stream.position());
+        m_stream.next();
+        parseBody(node);
+
+        // objects without an id show what they are bound to instead
+        if (node->detail.isEmpty())
+            node->detail = binding;
+    }
+
+    // Up to the end of the line, or further while brackets are open
+    void skipStatement()
+    {
+        int nesting = 0;
+        int line = m_stream.line();
+        while (!m_stream.atEnd())
+        {
+            const QChar symbol = m_stream.symbol();
+            if (nesting <= 0)
+            {
+                if (m_stream.line() != line || symbol == '}')
+                    return;
+                if (symbol == ';')
+                {
+                    m_stream.next();
+                    return;
+                }
+            }
+
+            if (symbol == '(' || symbol == '[' || symbol == '{')
+                nesting++;
+            else if (symbol == ')' || symbol == ']' || symbol == '}')
+                nesting--;
+
+            line = m_stream.line();
+            m_stream.next();
+        }
+    }
+
+    Node *addNode(Node *parent, Node::Kind kind, const QString &name, const QString &detail, int position)
+    {
+        Node *node = new Node;
+        node->kind = kind;
+        node->name = name;
+        node->detail = detail;
+        node->cursor = QTextCursor(m_document);
+        node->cursor.setPosition(position);
+        node->parent = parent;
+        parent->children.append(node);
+        return node;
+    }
+
+    QTextDocument *m_document;
+    TokenStream m_stream;
+};
+
+Node::~Node()
+{
+    qDeleteAll(children);
+}
+
+OutlineModel::OutlineModel(QObject *parent) : QAbstractItemModel(parent),
+    m_root(new Node)
+{
+
+}
+
+OutlineModel::~OutlineModel()
+{
+    delete m_root;
+}
+
+SyntaxHighlighter *OutlineModel::highlighter() const
+{
+    return m_highlighter;
+}
+
+void OutlineModel::setHighlighter(SyntaxHighlighter *highlighter)
+{
+    if (m_highlighter == highlighter)
+        return;
+
+    if (m_highlighter)
+        QObject::disconnect(m_highlighter, &SyntaxHighlighter::highlighterChanged, this, &OutlineModel::attach);
+
+    m_highlighter = highlighter;
+    if (m_highlighter)
+        QObject::connect(m_highlighter, &SyntaxHighlighter::highlighterChanged, this, &OutlineModel::attach);
+
+    attach();
+    emit highlighterChanged();
+}
+
+void OutlineModel::attach()
+{
+    QTextDocument *document = (m_highlighter && m_highlighter->highlighter()) ?
+                m_highlighter->highlighter()->document() : nullptr;
+    if (m_document == document)
+        return;
+
+    if (m_document)
+        QObject::disconnect(m_document, &QTextDocument::contentsChange, this, &OutlineModel::onContentsChange);
+
+    beginResetModel();
+    delete m_root;
+    m_root = new Node;
+    m_document = document;
+    endResetModel();
+
+    if (m_document)
+    {
+        QObject::connect(m_document, &QTextDocument::contentsChange, this, &OutlineModel::onContentsChange);
+        m_dirtyStart = QTextCursor(m_document);
+        m_dirtyEnd = QTextCursor(m_document);
+        m_dirty = false;
+        markDirty(0, m_document->characterCount() - 1);
+        scheduleUpdate();
+    }
+}
+
+QModelIndex OutlineModel::index(int row, int column, const QModelIndex &parent) const
+{
+    const Node *parentNode = nodeAt(parent);
+    if (row < 0 || row >= parentNode->children.count() || column != 0)
+        return QModelIndex();
+
+    return createIndex(row, column, parentNode->children.at(row));
+}
+
+QModelIndex OutlineModel::parent(const QModelIndex &child) const
+{
+    if (!child.isValid())
+        return QModelIndex();
+
+    return indexOf(nodeAt(child)->parent);
+}
+
+int OutlineModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.column() > 0)
+        return 0;
+
+    return nodeAt(parent)->children.count();
+}
+
+int OutlineModel::columnCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent)
+    return 1;
+}
+
+QVariant OutlineModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid())
+        return QVariant();
+
+    const Node *node = nodeAt(index);
+    switch (role) {
+    case Qt::DisplayRole:
+    case NameRole:
+        return node->name;
+    case KindRole:
+        switch (node->kind) {
+        case Node::Object: return QStringLiteral("object");
+        case Node::Property: return QStringLiteral("property");
+        case Node::Signal: return QStringLiteral("signal");
+        case Node::Handler: return QStringLiteral("handler");
+        case Node::Function: return QStringLiteral("function");
+        }
+        break;
+    case DetailRole:
+        return node->detail;
+    case PositionRole:
+        return node->cursor.position();
+    case LineRole:
+        return node->cursor.blockNumber() + 1;
+    }
+
+    return QVariant();
+}
+
+QHash<int, QByteArray> OutlineModel::roleNames() const
+{
+    QHash<int, QByteArray> roles;
+    roles[NameRole] = "name";
+    roles[KindRole] = "kind";
+    roles[DetailRole] = "detail";
+    roles[PositionRole] = "position";
+    roles[LineRole] = "line";
+    return roles;
+}
+
+void OutlineModel::onContentsChange(int position, int charsRemoved, int charsAdded)
+{
+    Q_UNUSED(position)
+    Q_UNUSED(charsRemoved)
+    Q_UNUSED(charsAdded)
+
+    // the highlighter has re-lexed the change by now, update asks it which
+    // blocks got other tokens; formats alone (marks, squiggles) give none
+    scheduleUpdate();
+}
+
+void OutlineModel::markDirty(int start, int end)
+{
+    const int last = m_document->characterCount() - 1;
+    start = qBound(0, start, last);
+    end = qBound(0, end, last);
+
+    if (m_dirty)
+    {
+        start = qMin(start, m_dirtyStart.position());
+        end = qMax(end, m_dirtyEnd.position());
+    }
+
+    m_dirtyStart.setPosition(start);
+    m_dirtyEnd.setPosition(end);
+    m_dirty = true;
+}
+
+void OutlineModel::scheduleUpdate()
+{
+    if (m_updatePending)
+        return;
+
+    m_updatePending = true;
+    QTimer::singleShot(0, this, &OutlineModel::update);
+}
+
+void OutlineModel::update()
+{
+    m_updatePending = false;
+    if (!m_document)
+        return;
+
+    int changeStart = 0;
+    int changeEnd = 0;
+    QMLHighlighter *highlighter = m_highlighter ? m_highlighter->highlighter() : nullptr;
+    if (highlighter && highlighter->takeTokenChanges(changeStart, changeEnd))
+        markDirty(changeStart, changeEnd);
+
+    if (!m_dirty)
+        return;
+    m_dirty = false;
+
+    const int start = m_dirtyStart.position();
+    const int end = m_dirtyEnd.position();
+
+    Node *node = m_root;
+    while (Node *child = objectEnclosing(node, start, end))
+        node = child;
+
+    int from = 0;
+    int to = m_document->characterCount();
+    if (node != m_root)
+    {
+        from = node->brace.position() + 1;
+        to = m_highlighter->matchingBracket(node->brace.position());
+    }
+
+    // The statements before the member preceding the change parse as they
+    // did. Objects bound to a property start after their statement does,
+    // so parsing starts at a member that is not one.
+    const QVector<Node *> &children = node->children;
+    int first = childrenStartingBy(node, start) - 2;
+    while (first >= 0 && !children.at(first)->binding.isEmpty())
+        first--;
+    if (first >= 0)
+        from = children.at(first)->cursor.position();
+    else
+        first = 0;
+
+    // members parsing can stop at once it is past the change, a bound
+    // object there may just have lost its binding
+    QVector<int> starts;
+    starts.reserve(children.count() - first);
+    for (int i = first; i < children.count(); i++)
+        starts += children.at(i)->binding.isEmpty() ? children.at(i)->cursor.position() : -1;
+
+    Node fresh;
+    OutlineParser parser(m_document, from, to);
+    const int count = parser.parseMembers(&fresh, end, starts);
+    const int stop = (count < starts.count()) ? starts.at(count) : to;
+
+    // an id outside the reparsed members is still there
+    if (node != m_root)
+    {
+        const int idPosition = node->idCursor.isNull() ? -1 : node->idCursor.position();
+        if (!fresh.detail.isEmpty())
+            setDetail(node, fresh.detail, fresh.idCursor);
+        else if (idPosition >= from && idPosition <= stop)
+            setDetail(node, QString(), QTextCursor());
+    }
+
+    mergeChildren(node, fresh.children, first, count);
+}
+
+// Object child of node whose braces still enclose [start, end]
+Node *OutlineModel::objectEnclosing(Node *node, int start, int end) const
+{
+    const int count = childrenStartingBy(node, start);
+    if (count == 0)
+        return nullptr;
+
+    Node *child = node->children.at(count - 1);
+    if (child->kind != Node::Object || child->brace.position() >= start)
+        return nullptr;
+
+    // -1 as well when the '{' itself is gone
+    const int closing = m_highlighter->matchingBracket(child->brace.position());
+    return (closing >= end) ? child : nullptr;
+}
+
+// Number of children of node starting at or before position
+int OutlineModel::childrenStartingBy(const Node *node, int position)
+{
+    const QVector<Node *> &children = node->children;
+
+    // children are in document order
+    int low = 0;
+    int high = children.count();
+    while (low < high)
+    {
+        const int middle = (low + high) / 2;
+        if (children.at(middle)->cursor.position() <= position)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    return low;
+}
+
+// Moves the freshly parsed children of fresh into target
+void OutlineModel::merge(Node *target, Node *fresh)
+{
+    if (target != m_root)
+        setDetail(target, fresh->detail, fresh->idCursor);
+
+    mergeChildren(target, fresh->children, 0, target->children.count());
+}
+
+// Replaces the children [first, first + count) of target with incoming,
+// keeping the nodes (and model indexes) of the unchanged ones at both ends
+void OutlineModel::mergeChildren(Node *target, QVector<Node *> &incoming, int first, int count)
+{
+    QVector<Node *> &current = target->children;
+
+    auto same = [](const Node *a, const Node *b) {
+        return a->kind == b->kind && a->name == b->name;
+    };
+
+    int prefix = 0;
+    while (prefix < count && prefix < incoming.count() && same(current.at(first + prefix), incoming.at(prefix)))
+        prefix++;
+
+    int suffix = 0;
+    while (suffix < count - prefix && suffix < incoming.count() - prefix
+           && same(current.at(first + count - 1 - suffix), incoming.at(incoming.count() - 1 - suffix)))
+        suffix++;
+
+    const QModelIndex parentIndex = indexOf(target);
+
+    const int removed = count - prefix - suffix;
+    if (removed > 0)
+    {
+        beginRemoveRows(parentIndex, first + prefix, first + prefix + removed - 1);
+        for (int i = first + prefix; i < first + prefix + removed; i++)
+            delete current.at(i);
+        current.remove(first + prefix, removed);
+        endRemoveRows();
+    }
+
+    const int added = incoming.count() - prefix - suffix;
+    if (added > 0)
+    {
+        beginInsertRows(parentIndex, first + prefix, first + prefix + added - 1);
+        for (int i = prefix; i < prefix + added; i++)
+        {
+            Node *node = incoming.at(i);
+            node->parent = target;
+            current.insert(first + i, node);
+            incoming[i] = nullptr;
+        }
+        endInsertRows();
+    }
+
+    // kept nodes take over the new positions and merge their own children
+    for (int i = 0; i < incoming.count(); i++)
+    {
+        if (i >= prefix && i < prefix + added)
+            continue;
+
+        Node *node = current.at(first + i);
+        Node *update = incoming.at(i);
+
+        const bool positionChanged = node->cursor.position() != update->cursor.position();
+        node->cursor = update->cursor;
+        node->brace = update->brace;
+        node->binding = update->binding;
+        if (node->kind == Node::Property && node->detail != update->detail)
+        {
+            node->detail = update->detail;
+            const QModelIndex index = indexOf(node);
+            emit dataChanged(index, index);
+        }
+        else if (positionChanged)
+        {
+            const QModelIndex index = indexOf(node);
+            emit dataChanged(index, index, { PositionRole, LineRole });
+        }
+
+        if (node->kind == Node::Object)
+            merge(node, update);
+    }
+}
+
+// The id of an object, or what it is bound to when it has none
+void OutlineModel::setDetail(Node *target, const QString &detail, const QTextCursor &idCursor)
+{
+    target->idCursor = idCursor;
+
+    const QString shown = detail.isEmpty() ? target->binding : detail;
+    if (target->detail != shown)
+    {
+        target->detail = shown;
+        const QModelIndex index = indexOf(target);
+        emit dataChanged(index, index);
+    }
+}
+
+Node *OutlineModel::nodeAt(const QModelIndex &index) const
+{
+    return index.isValid() ? static_cast<Node *>(index.internalPointer()) : m_root;
+}
+
+QModelIndex OutlineModel::indexOf(Node *node) const
+{
+    if (!node || node == m_root || !node->parent)
+        return QModelIndex();
+
+    return createIndex(node->parent->children.indexOf(node), 0, node);
+}
@@ -0,0 +1,91 @@
+#ifndef OUTLINEMODEL_H
+#define OUTLINEMODEL_H
+
+#include <QAbstractItemModel>
+#include <QTextCursor>
+#include <QVector>
+#include "SyntaxHighlighter.h"
+
+// Object tree of the edited QML file: objects with their ids, declared
+// properties, signals, signal handlers and functions. It is parsed from
+// the tokens QMLHighlighter leaves in BlockData, so nothing is lexed
+// twice. After an edit only the blocks whose tokens changed are looked
+// at: in the innermost object still enclosing them, the members from the
+// one before the change up to the first one parsed the same as before are
+// reparsed and merged into the existing tree, unchanged rows keep their
+// indexes.
+class OutlineModel : public QAbstractItemModel
+{
+    Q_OBJECT
+
+    Q_PROPERTY(SyntaxHighlighter* highlighter READ highlighter WRITE setHighlighter NOTIFY highlighterChanged)
+
+public:
+    enum Roles {
+        NameRole = Qt::UserRole + 1,
+        KindRole,
+        DetailRole,
+        PositionRole,
+        LineRole
+    };
+
+    explicit OutlineModel(QObject *parent = nullptr);
+    ~OutlineModel();
+
+    SyntaxHighlighter *highlighter() const;
+    void setHighlighter(SyntaxHighlighter *highlighter);
+
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &child) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    struct Node
+    {
+        enum Kind { Object, Property, Signal, Handler, Function };
+
+        ~Node();
+
+        Kind kind = Object;
+        QString name;
+        QString detail;         // id of objects, type of properties
+        QString binding;        // property objects are bound to, if any
+        QTextCursor cursor;     // start of the declaration
+        QTextCursor brace;      // '{' of objects
+        QTextCursor idCursor;   // "id" of objects that have one
+        Node *parent = nullptr;
+        QVector<Node *> children;
+    };
+
+private slots:
+    void attach();
+    void onContentsChange(int position, int charsRemoved, int charsAdded);
+    void update();
+
+private:
+    Node *nodeAt(const QModelIndex &index) const;
+    QModelIndex indexOf(Node *node) const;
+    Node *objectEnclosing(Node *node, int start, int end) const;
+    static int childrenStartingBy(const Node *node, int position);
+    void merge(Node *target, Node *fresh);
+    void mergeChildren(Node *target, QVector<Node *> &incoming, int first, int count);
+    void setDetail(Node *target, const QString &detail, const QTextCursor &idCursor);
+    void markDirty(int start, int end);
+    void scheduleUpdate();
+
+    SyntaxHighlighter *m_highlighter = nullptr;
+    QTextDocument *m_document = nullptr;
+    Node *m_root;
+
+    QTextCursor m_dirtyStart;
+    QTextCursor m_dirtyEnd;
+    bool m_dirty = false;
+    bool m_updatePending = false;
+
+signals:
+    void highlighterChanged();
+};
+
+#endif // OUTLINEMODEL_H
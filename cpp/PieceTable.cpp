@@ -0,0 +1,223 @@
+#include "PieceTable.h"
+
+// Past this many pieces lookups get slow enough that flattening the
+// table back into a single original piece is cheaper
+static const int MaxPieces = 2048;
+
+PieceTable::PieceTable() :
+    m_length(0),
+    m_lookupPiece(0),
+    m_lookupStart(0)
+{
+}
+
+void PieceTable::reset(const QString &original)
+{
+    m_original = original;
+    m_added.clear();
+    m_pieces.clear();
+    m_length = original.length();
+
+    if (m_length > 0)
+    {
+        Piece piece = { Original, 0, m_length };
+        m_pieces.append(piece);
+    }
+
+    invalidateLookup();
+}
+
+int PieceTable::length() const
+{
+    return m_length;
+}
+
+QChar PieceTable::at(int position) const
+{
+    if (position < 0 || position >= m_length)
+        return QChar();
+
+    int pieceStart = 0;
+    const int index = findPiece(position, &pieceStart);
+    return data(m_pieces.at(index))[position - pieceStart];
+}
+
+QString PieceTable::text(int position, int count) const
+{
+    QString result;
+    result.reserve(qMax(0, qMin(count, m_length - position)));
+
+    forEachChunk(position, count, [&result](const QChar *chunk, int chunkLength) {
+        result.append(chunk, chunkLength);
+        return true;
+    });
+
+    return result;
+}
+
+QString PieceTable::toString() const
+{
+    return text(0, m_length);
+}
+
+void PieceTable::insert(int position, const QString &text)
+{
+    if (text.isEmpty())
+        return;
+
+    position = qBound(0, position, m_length);
+
+    int pieceStart = 0;
+    const int index = findPiece(position, &pieceStart);
+
+    const int addedStart = m_added.length();
+    m_added.append(text);
+    m_length += text.length();
+
+    // Consecutive keystrokes land right behind the previous insertion,
+    // both in the document and in the add buffer: grow that piece
+    if (position == pieceStart && index > 0)
+    {
+        Piece &previous = m_pieces[index - 1];
+        if (previous.source == Added && previous.start + previous.length == addedStart)
+        {
+            m_lookupPiece = index - 1;
+            m_lookupStart = pieceStart - previous.length;
+            previous.length += text.length();
+            return;
+        }
+    }
+
+    const Piece inserted = { Added, addedStart, text.length() };
+
+    if (index == m_pieces.count() || position == pieceStart)
+    {
+        m_pieces.insert(index, inserted);
+    }
+    else
+    {
+        Piece &piece = m_pieces[index];
+        const int offset = position - pieceStart;
+        const Piece tail = { piece.source, piece.start + offset, piece.length - offset };
+        piece.length = offset;
+
+        m_pieces.insert(index + 1, inserted);
+        m_pieces.insert(index + 2, tail);
+    }
+
+    // pieces before the edit are untouched, so the lookup stays valid
+    m_lookupPiece = index;
+    m_lookupStart = pieceStart;
+
+    compactIfFragmented();
+}
+
+void PieceTable::remove(int position, int count)
+{
+    position = qBound(0, position, m_length);
+    count = qMin(count, m_length - position);
+    if (count <= 0)
+        return;
+
+    int pieceStart = 0;
+    int index = findPiece(position, &pieceStart);
+    const int firstIndex = index;
+    const int offset = position - pieceStart;
+    int remaining = count;
+
+    m_length -= count;
+    m_lookupPiece = firstIndex;
+    m_lookupStart = pieceStart;
+
+    if (offset > 0)
+    {
+        Piece &piece = m_pieces[index];
+
+        // removal strictly inside one piece splits it in two
+        if (offset + remaining < piece.length)
+        {
+            const Piece tail = { piece.source,
+                                 piece.start + offset + remaining,
+                                 piece.length - offset - remaining };
+            piece.length = offset;
+            m_pieces.insert(index + 1, tail);
+            compactIfFragmented();
+            return;
+        }
+
+        remaining -= piece.length - offset;
+        piece.length = offset;
+        index++;
+    }
+
+    const int removeFrom = index;
+    while (remaining > 0 && index < m_pieces.count())
+    {
+        Piece &piece = m_pieces[index];
+        if (remaining >= piece.length)
+        {
+            remaining -= piece.length;
+            index++;
+        }
+        else
+        {
+            piece.start += remaining;
+            piece.length -= remaining;
+            remaining = 0;
+        }
+    }
+
+    m_pieces.remove(removeFrom, index - removeFrom);
+}
+
+const QChar *PieceTable::data(const Piece &piece) const
+{
+    const QString &buffer = (piece.source == Original) ? m_original : m_added;
+    return buffer.constData() + piece.start;
+}
+
+// Returns the index of the piece containing position (m_pieces.count()
+// at the very end of the text) and stores where that piece starts
+int PieceTable::findPiece(int position, int *pieceStart) const
+{
+    int index = m_lookupPiece;
+    int start = m_lookupStart;
+
+    if (index > m_pieces.count())
+    {
+        index = 0;
+        start = 0;
+    }
+
+    while (index > 0 && position < start)
+    {
+        index--;
+        start -= m_pieces.at(index).length;
+    }
+
+    while (index < m_pieces.count() && position >= start + m_pieces.at(index).length)
+    {
+        start += m_pieces.at(index).length;
+        index++;
+    }
+
+    m_lookupPiece = index;
+    m_lookupStart = start;
+
+    *pieceStart = start;
+    return index;
+}
+
+void PieceTable::invalidateLookup()
+{
+    m_lookupPiece = 0;
+    m_lookupStart = 0;
+}
+
+void PieceTable::compactIfFragmented()
+{
+    if (m_pieces.count() <= MaxPieces)
+        return;
+
+    reset(toString());
+}
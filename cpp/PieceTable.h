@@ -0,0 +1,87 @@
+#ifndef PIECETABLE_H
+#define PIECETABLE_H
+
+#include <QString>
+#include <QVector>
+
+// Text stored as a sequence of pieces pointing into two buffers: the
+// original file content (never modified) and an append-only buffer with
+// everything typed since. Edits only split or add pieces, the content
+// itself is never copied.
+class PieceTable
+{
+public:
+    PieceTable();
+
+    void reset(const QString &original = QString());
+
+    int length() const;
+    QChar at(int position) const;
+    QString text(int position, int count) const;
+    QString toString() const;
+
+    void insert(int position, const QString &text);
+    void remove(int position, int count);
+
+    // Calls visit(const QChar *data, int length) for every contiguous chunk
+    // in [position, position + count); stops early when visit returns false
+    template <typename Visitor>
+    void forEachChunk(int position, int count, Visitor visit) const;
+
+private:
+    enum Source { Original, Added };
+
+    struct Piece
+    {
+        Source source;
+        int start;
+        int length;
+    };
+
+    const QChar *data(const Piece &piece) const;
+    int findPiece(int position, int *pieceStart) const;
+    void invalidateLookup();
+    void compactIfFragmented();
+
+    QString m_original;
+    QString m_added;
+    QVector<Piece> m_pieces;
+    int m_length;
+
+    // last lookup, sequential access (typing, scanning) stays O(1)
+    mutable int m_lookupPiece;
+    mutable int m_lookupStart;
+};
+
+template <typename Visitor>
+void PieceTable::forEachChunk(int position, int count, Visitor visit) const
+{
+    if (position < 0)
+    {
+        count += position;
+        position = 0;
+    }
+    count = qMin(count, m_length - position);
+    if (count <= 0)
+        return;
+
+    int pieceStart = 0;
+    int index = findPiece(position, &pieceStart);
+
+    while (count > 0 && index < m_pieces.count())
+    {
+        const Piece &piece = m_pieces.at(index);
+        const int offset = position - pieceStart;
+        const int chunkLength = qMin(piece.length - offset, count);
+
+        if (!visit(data(piece) + offset, chunkLength))
+            return;
+
+        position += chunkLength;
+        count -= chunkLength;
+        pieceStart += piece.length;
+        index++;
+    }
+}
+
+#endif // PIECETABLE_H
@@ -0,0 +1,697 @@
+#include "ProjectArchive.h"
+
+#include <QByteArray>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QList>
+#include <QSaveFile>
+#include <QScopedPointer>
+#include <QtConcurrent>
+#include <QtEndian>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+const int BlockSize = 512;
+const int ReadSize = 64 * 1024;
+// chunks deflated or inflated ahead of the one being written or read
+const int ChunksInFlight = 8;
+// a chunk claiming more than this is damaged
+const quint32 MaxChunkSize = 16 * ProjectArchive::ChunkSize;
+// the largest size the octal field of a tar header holds
+const qint64 MaxOctalSize = Q_INT64_C(077777777777);
+// pax records are a few paths and hashes
+const qint64 MaxPaxSize = 64 * 1024;
+
+// gzip member: fixed header with FEXTRA set, XLEN, the 'QC' subfield holding
+// the zlib Adler-32 and the deflate stream's size, the stream, CRC-32 and size
+const int SubfieldSize = 8;
+const int MemberHeaderSize = 10 + 2 + 4 + SubfieldSize;
+const int MemberTrailerSize = 8;
+
+const QByteArray HashKey("QMLCREATOR.sha256");
+
+struct Crc32Table
+{
+    quint32 entries[256];
+
+    Crc32Table()
+    {
+        for (quint32 i = 0; i < 256; ++i)
+        {
+            quint32 crc = i;
+            for (int bit = 0; bit < 8; ++bit)
+                crc = (crc & 1) ? (crc >> 1) ^ 0xedb88320u : crc >> 1;
+            entries[i] = crc;
+        }
+    }
+};
+
+quint32 crc32(const QByteArray &data)
+{
+    static const Crc32Table table;
+
+    quint32 crc = 0xffffffffu;
+    const uchar *bytes = reinterpret_cast<const uchar*>(data.constData());
+    for (int i = 0; i < data.size(); ++i)
+        crc = table.entries[(crc ^ bytes[i]) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+
+void appendLittleEndian16(QByteArray &data, quint16 value)
+{
+    uchar bytes[2];
+    qToLittleEndian(value, bytes);
+    data.append(reinterpret_cast<const char*>(bytes), 2);
+}
+
+void appendLittleEndian32(QByteArray &data, quint32 value)
+{
+    uchar bytes[4];
+    qToLittleEndian(value, bytes);
+    data.append(reinterpret_cast<const char*>(bytes), 4);
+}
+
+// Runs in a pool thread
+QByteArray deflateChunk(const QByteArray &chunk)
+{
+    // qCompress gives the size, a zlib header, the deflate stream and the Adler-32
+    const QByteArray zlib = qCompress(chunk);
+    const int streamSize = zlib.size() - 4 - 2 - 4;
+
+    QByteArray member;
+    member.reserve(MemberHeaderSize + streamSize + MemberTrailerSize);
+    const char header[10] = { '\x1f', '\x8b', 8, 4, 0, 0, 0, 0, 0, '\xff' };
+    member.append(header, 10);
+    appendLittleEndian16(member, 4 + SubfieldSize);
+    member.append("QC", 2);
+    appendLittleEndian16(member, SubfieldSize);
+    member.append(zlib.constData() + zlib.size() - 4, 4);
+    appendLittleEndian32(member, quint32(streamSize));
+    member.append(zlib.constData() + 6, streamSize);
+    appendLittleEndian32(member, crc32(chunk));
+    appendLittleEndian32(member, quint32(chunk.size()));
+    return member;
+}
+
+struct Member
+{
+    QByteArray stream;
+    QByteArray adler32;
+    quint32 crc32 = 0;
+    quint32 size = 0;
+};
+
+enum ReadResult { Read, End, Damaged };
+
+ReadResult readMember(QIODevice &device, Member *member)
+{
+    const QByteArray header = device.read(MemberHeaderSize);
+    if (header.isEmpty())
+        return End;
+
+    const uchar *bytes = reinterpret_cast<const uchar*>(header.constData());
+    if (header.size() != MemberHeaderSize ||
+            bytes[0] != 0x1f || bytes[1] != 0x8b || bytes[2] != 8 || bytes[3] != 4 ||
+            qFromLittleEndian<quint16>(bytes + 10) != 4 + SubfieldSize ||
+            bytes[12] != 'Q' || bytes[13] != 'C' ||
+            qFromLittleEndian<quint16>(bytes + 14) != SubfieldSize)
+        return Damaged;
+
+    const quint32 streamSize = qFromLittleEndian<quint32>(bytes + 20);
+    if (streamSize > MaxChunkSize)
+        return Damaged;
+
+    member->adler32 = header.mid(16, 4);
+    member->stream = device.read(streamSize);
+    const QByteArray trailer = device.read(MemberTrailerSize);
+    if (member->stream.size() != int(streamSize) || trailer.size() != MemberTrailerSize)
+        return Damaged;
+
+    member->crc32 = qFromLittleEndian<quint32>(trailer.constData());
+    member->size = qFromLittleEndian<quint32>(trailer.constData() + 4);
+    return (member->size > 0 && member->size <= MaxChunkSize) ? Read : Damaged;
+}
+
+// Runs in a pool thread, an empty chunk means the member is damaged
+QByteArray inflateChunk(const Member &member)
+{
+    // qUncompress wants back what qCompress gave
+    QByteArray zlib;
+    zlib.reserve(4 + 2 + member.stream.size() + 4);
+    uchar size[4];
+    qToBigEndian(member.size, size);
+    zlib.append(reinterpret_cast<const char*>(size), 4);
+    zlib.append("\x78\x9c", 2);
+    zlib.append(member.stream);
+    zlib.append(member.adler32);
+
+    const QByteArray chunk = qUncompress(zlib);
+    if (chunk.size() != int(member.size) || crc32(chunk) != member.crc32)
+        return QByteArray();
+    return chunk;
+}
+
+// Cuts the tar stream into chunks and writes them deflated, in order
+class ChunkWriter
+{
+public:
+    explicit ChunkWriter(QIODevice *device) : m_device(device)
+    {
+    }
+
+    bool write(const QByteArray &data)
+    {
+        m_chunk += data;
+        if (m_chunk.size() >= ProjectArchive::ChunkSize)
+        {
+            submit(m_chunk.left(ProjectArchive::ChunkSize));
+            m_chunk = m_chunk.mid(ProjectArchive::ChunkSize);
+        }
+        return m_written;
+    }
+
+    bool finish()
+    {
+        if (!m_chunk.isEmpty())
+            submit(m_chunk);
+        m_chunk.clear();
+        while (!m_pending.isEmpty())
+            writeFirst();
+        return m_written;
+    }
+
+private:
+    void submit(const QByteArray &chunk)
+    {
+        m_pending += QtConcurrent::run(deflateChunk, chunk);
+        if (m_pending.count() >= ChunksInFlight)
+            writeFirst();
+    }
+
+    void writeFirst()
+    {
+        const QByteArray member = m_pending.takeFirst().result();
+        if (m_device->write(member) != member.size())
+            m_written = false;
+    }
+
+    QIODevice *m_device;
+    QByteArray m_chunk;
+    QList<QFuture<QByteArray>> m_pending;
+    bool m_written = true;
+};
+
+void setOctal(char *field, int size, qint64 value)
+{
+    std::snprintf(field, size_t(size), "%0*llo", size - 1, static_cast<unsigned long long>(value));
+}
+
+qint64 octal(const char *field, int size)
+{
+    int i = 0;
+    while (i < size && field[i] == ' ')
+        ++i;
+
+    qint64 value = 0;
+    for (; i < size && field[i] >= '0' && field[i] <= '7'; ++i)
+        value = value * 8 + (field[i] - '0');
+    return value;
+}
+
+uint headerChecksum(const char *header)
+{
+    // the checksum field itself counts as spaces
+    uint sum = 8 * uint(' ');
+    for (int i = 0; i < BlockSize; ++i)
+    {
+        if (i < 148 || i >= 156)
+            sum += uchar(header[i]);
+    }
+    return sum;
+}
+
+QByteArray tarHeader(const QByteArray &name, char type, qint64 size, qint64 mtime)
+{
+    QByteArray header(BlockSize, '\0');
+    char *h = header.data();
+    std::memcpy(h, name.constData(), size_t(qMin(name.size(), 100)));
+    setOctal(h + 100, 8, type == '5' ? 0755 : 0644);
+    setOctal(h + 108, 8, 0);
+    setOctal(h + 116, 8, 0);
+    setOctal(h + 124, 12, size > MaxOctalSize ? 0 : size);
+    setOctal(h + 136, 12, mtime);
+    h[156] = type;
+    std::memcpy(h + 257, "ustar", 6);
+    std::memcpy(h + 263, "00", 2);
+    std::snprintf(h + 148, 8, "%06o", headerChecksum(h));
+    h[155] = ' ';
+    return header;
+}
+
+QByteArray paxRecord(const QByteArray &key, const QByteArray &value)
+{
+    // the length at the front counts its own digits
+    const int length = key.size() + value.size() + 3;
+    int total = length;
+    while (total != length + QByteArray::number(total).size())
+        total = length + QByteArray::number(total).size();
+    return QByteArray::number(total) + ' ' + key + '=' + value + '\n';
+}
+
+bool pad(ChunkWriter &out, qint64 size)
+{
+    const int rest = int(size % BlockSize);
+    return rest == 0 || out.write(QByteArray(BlockSize - rest, '\0'));
+}
+
+// pax header with the full name (and hash), then the ustar header
+bool writeEntry(ChunkWriter &out, const QByteArray &name, char type, qint64 size, qint64 mtime,
+                const QByteArray &hash)
+{
+    QByteArray records = paxRecord("path", name);
+    if (!hash.isEmpty())
+        records += paxRecord(HashKey, hash);
+    if (size > MaxOctalSize)
+        records += paxRecord("size", QByteArray::number(size));
+
+    return out.write(tarHeader("PaxHeader", 'x', records.size(), mtime)) &&
+            out.write(records) && pad(out, records.size()) &&
+            out.write(tarHeader(name, type, size, mtime));
+}
+
+bool writeFile(ChunkWriter &out, const QFileInfo &info, const QByteArray &name)
+{
+    QFile file(info.filePath());
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    if (!file.open(QIODevice::ReadOnly) || !hash.addData(&file))
+    {
+        qWarning() << "Unable to read" << info.filePath();
+        return false;
+    }
+
+    // hashed first, the hash goes in front of the data
+    const qint64 size = file.size();
+    if (!writeEntry(out, name, '0', size, info.lastModified().toSecsSinceEpoch(), hash.result().toHex()) ||
+            !file.seek(0))
+        return false;
+
+    qint64 written = 0;
+    for (QByteArray block = file.read(ReadSize); !block.isEmpty(); block = file.read(ReadSize))
+    {
+        if (!out.write(block))
+            return false;
+        written += block.size();
+    }
+
+    if (written != size)
+    {
+        qWarning() << info.filePath() << "changed while it was archived";
+        return false;
+    }
+    return pad(out, size);
+}
+
+// Extracts the tar stream fed to it chunk by chunk, straight into the files
+class TarReader
+{
+public:
+    explicit TarReader(const QString &dirPath) : m_dirPath(dirPath), m_hash(QCryptographicHash::Sha256)
+    {
+    }
+
+    // false once the archive turns out damaged
+    bool feed(const QByteArray &data)
+    {
+        m_buffer += data;
+        int offset = 0;
+        while (!m_finished)
+        {
+            const int available = m_buffer.size() - offset;
+            const char *bytes = m_buffer.constData() + offset;
+            if (m_left > 0)
+            {
+                const int count = int(qMin<qint64>(available, m_left));
+                if (count == 0)
+                    break;
+
+                if (m_kind == File)
+                {
+                    m_hash.addData(bytes, count);
+                    if (m_file->write(bytes, count) != count)
+                        return false;
+                }
+                else if (m_kind == Pax)
+                {
+                    m_pax.append(bytes, count);
+                }
+
+                offset += count;
+                m_left -= count;
+                if (m_left == 0 && !endEntry())
+                    return false;
+            }
+            else if (m_padding > 0)
+            {
+                const int count = qMin(available, m_padding);
+                if (count == 0)
+                    break;
+                offset += count;
+                m_padding -= count;
+            }
+            else
+            {
+                if (available < BlockSize)
+                    break;
+                if (!startEntry(bytes))
+                    return false;
+                offset += BlockSize;
+                if (m_left == 0 && !endEntry())
+                    return false;
+            }
+        }
+
+        m_buffer.remove(0, offset);
+        return true;
+    }
+
+    // the end of the archive was found, it was not cut short
+    bool finished() const
+    {
+        return m_finished;
+    }
+
+private:
+    enum Kind { None, Pax, File, Skip };
+
+    bool startEntry(const char *header)
+    {
+        bool empty = true;
+        for (int i = 0; i < BlockSize && empty; ++i)
+            empty = (header[i] == '\0');
+        if (empty)
+        {
+            m_finished = true;
+            return true;
+        }
+
+        if (uint(octal(header + 148, 8)) != headerChecksum(header))
+            return damaged("a header");
+
+        const char type = header[156];
+        const qint64 size = (m_paxSize >= 0 && type != 'x') ? m_paxSize : octal(header + 124, 12);
+        m_left = size;
+        m_padding = int((BlockSize - size % BlockSize) % BlockSize);
+        m_kind = Skip;
+
+        if (type == 'x')
+        {
+            if (size > MaxPaxSize)
+                return damaged("a pax header");
+            m_kind = Pax;
+            m_pax.clear();
+            return true;
+        }
+
+        QByteArray name = m_paxPath;
+        if (name.isEmpty())
+        {
+            name = QByteArray(header, int(qstrnlen(header, 100)));
+            if (header[345] != '\0')
+                name.prepend(QByteArray(header + 345, int(qstrnlen(header + 345, 155))) + '/');
+        }
+        const QByteArray hash = m_paxHash;
+        m_paxPath.clear();
+        m_paxHash.clear();
+        m_paxSize = -1;
+
+        if (type != '0' && type != '\0' && type != '5')
+            return true;
+
+        QString relativePath;
+        if (!relativeFilePath(QString::fromUtf8(name), &relativePath))
+            return damaged(name);
+
+        const QString path = m_dirPath + QLatin1Char('/') + relativePath;
+        if (type == '5')
+            return QDir().mkpath(path);
+
+        // files come with their hash, or the archive is not ours
+        if (hash.isEmpty() || relativePath.isEmpty())
+            return damaged(name);
+
+        QDir().mkpath(QFileInfo(path).path());
+        m_file.reset(new QSaveFile(path));
+        if (!m_file->open(QIODevice::WriteOnly))
+        {
+            qWarning() << "Unable to write" << path;
+            return false;
+        }
+        m_hash.reset();
+        m_expectedHash = hash;
+        m_kind = File;
+        return true;
+    }
+
+    bool endEntry()
+    {
+        const Kind kind = m_kind;
+        m_kind = None;
+
+        if (kind == Pax)
+        {
+            readPaxRecords();
+        }
+        else if (kind == File)
+        {
+            if (m_hash.result().toHex() != m_expectedHash)
+            {
+                m_file->cancelWriting();
+                return damaged(m_file->fileName());
+            }
+            if (!m_file->commit())
+            {
+                qWarning() << "Unable to write" << m_file->fileName();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void readPaxRecords()
+    {
+        int position = 0;
+        while (position < m_pax.size())
+        {
+            const int space = m_pax.indexOf(' ', position);
+            const int length = (space > position) ? m_pax.mid(position, space - position).toInt() : 0;
+            if (length <= 0 || position + length > m_pax.size())
+                return;
+
+            const QByteArray record = m_pax.mid(space + 1, position + length - space - 2);
+            const int equals = record.indexOf('=');
+            const QByteArray key = record.left(equals);
+            const QByteArray value = record.mid(equals + 1);
+            if (key == "path")
+                m_paxPath = value;
+            else if (key == HashKey)
+                m_paxHash = value;
+            else if (key == "size")
+                m_paxSize = value.toLongLong();
+
+            position += length;
+        }
+    }
+
+    // the part of name below the project's directory, false if it leads out of it
+    bool relativeFilePath(const QString &name, QString *relativePath)
+    {
+        QStringList parts = name.split(QLatin1Char('/'), Qt::SkipEmptyParts);
+        if (parts.isEmpty())
+            return false;
+
+        const QString root = parts.takeFirst();
+        if (m_root.isEmpty())
+            m_root = root;
+        else if (root != m_root)
+            return false;
+
+        for (const QString &part : parts)
+        {
+            if (part == QLatin1String(".") || part == QLatin1String("..") ||
+                    part.contains(QLatin1Char('\\')) || part.contains(QLatin1Char(':')))
+                return false;
+        }
+
+        *relativePath = parts.join(QLatin1Char('/'));
+        return true;
+    }
+
+    bool damaged(const QString &what)
+    {
+        qWarning() << "Damaged archive entry:" << what;
+        return false;
+    }
+
+    QString m_dirPath;
+    QString m_root;
+    QByteArray m_buffer;
+    bool m_finished = false;
+
+    // the current entry
+    Kind m_kind = None;
+    qint64 m_left = 0;
+    int m_padding = 0;
+    QByteArray m_pax;
+    QScopedPointer<QSaveFile> m_file;
+    QCryptographicHash m_hash;
+    QByteArray m_expectedHash;
+
+    // from the pax header, for the next entry
+    QByteArray m_paxPath;
+    QByteArray m_paxHash;
+    qint64 m_paxSize = -1;
+};
+
+bool extractTo(QFile &archive, const QString &dirPath, const ProjectArchive::Progress &progress)
+{
+    TarReader tar(dirPath);
+    QList<QFuture<QByteArray>> pending;
+    bool end = false;
+    while (true)
+    {
+        // a few chunks inflate while the one before them is written out
+        while (!end && pending.count() < ChunksInFlight)
+        {
+            Member member;
+            switch (readMember(archive, &member))
+            {
+            case Read:
+                pending += QtConcurrent::run(inflateChunk, member);
+                break;
+            case End:
+                end = true;
+                break;
+            case Damaged:
+                qWarning() << archive.fileName() << "is damaged or not a project archive";
+                return false;
+            }
+        }
+
+        if (pending.isEmpty() || tar.finished())
+            break;
+
+        const QByteArray chunk = pending.takeFirst().result();
+        if (chunk.isEmpty())
+        {
+            qWarning() << archive.fileName() << "has a damaged chunk";
+            return false;
+        }
+        if (!tar.feed(chunk) || !progress())
+            return false;
+    }
+
+    return tar.finished();
+}
+
+} // namespace
+
+bool ProjectArchive::write(const QString &dirPath, const QString &archivePath, const Progress &progress)
+{
+    QSaveFile archive(archivePath);
+    if (!archive.open(QIODevice::WriteOnly))
+    {
+        qWarning() << "Unable to write" << archivePath;
+        return false;
+    }
+
+    const QDir dir(dirPath);
+    const QByteArray root = dir.dirName().toUtf8();
+    ChunkWriter out(&archive);
+    if (!writeEntry(out, root + '/', '5', 0, QFileInfo(dirPath).lastModified().toSecsSinceEpoch(), QByteArray()))
+        return false;
+
+    QDirIterator it(dirPath, QDir::Dirs | QDir::Files | QDir::NoDotAndDotDot | QDir::Hidden,
+                    QDirIterator::Subdirectories);
+    while (it.hasNext())
+    {
+        it.next();
+        const QFileInfo info = it.fileInfo();
+        if (info.isSymLink())
+            continue;
+
+        const QByteArray name = root + '/' + dir.relativeFilePath(it.filePath()).toUtf8();
+        if (info.isDir())
+        {
+            if (!writeEntry(out, name + '/', '5', 0, info.lastModified().toSecsSinceEpoch(), QByteArray()))
+                return false;
+        }
+        else if (!writeFile(out, info, name) || !progress())
+        {
+            return false;
+        }
+    }
+
+    // two empty blocks end the archive
+    if (!out.write(QByteArray(2 * BlockSize, '\0')) || !out.finish())
+        return false;
+    return archive.commit();
+}
+
+bool ProjectArchive::extract(const QString &archivePath, const QString &dirPath, const Progress &progress)
+{
+    if (QFileInfo::exists(dirPath))
+    {
+        qWarning() << "Unable to extract to" << dirPath << "which exists";
+        return false;
+    }
+
+    QFile archive(archivePath);
+    if (!archive.open(QIODevice::ReadOnly))
+    {
+        qWarning() << "Unable to read" << archivePath;
+        return false;
+    }
+
+    // left over if the app was killed while extracting
+    const QFileInfo target(dirPath);
+    const QString partPath = target.path() + QLatin1String("/.") + target.fileName() + QLatin1String(".part");
+    QDir(partPath).removeRecursively();
+    if (!QDir().mkpath(partPath))
+    {
+        qWarning() << "Unable to create" << partPath;
+        return false;
+    }
+
+    const bool extracted = extractTo(archive, partPath, progress) && QDir().rename(partPath, dirPath);
+    if (!extracted)
+        QDir(partPath).removeRecursively();
+    return extracted;
+}
+
+int ProjectArchive::chunkCount(const QString &archivePath)
+{
+    QFile archive(archivePath);
+    if (!archive.open(QIODevice::ReadOnly))
+        return 0;
+
+    int count = 0;
+    while (true)
+    {
+        const QByteArray header = archive.read(MemberHeaderSize);
+        if (header.size() != MemberHeaderSize)
+            break;
+
+        const quint32 streamSize = qFromLittleEndian<quint32>(header.constData() + 20);
+        if (!archive.seek(archive.pos() + streamSize + MemberTrailerSize))
+            break;
+        count++;
+    }
+    return count;
+}
@@ -0,0 +1,37 @@
+#ifndef PROJECTARCHIVE_H
+#define PROJECTARCHIVE_H
+
+#include <QString>
+#include <functional>
+
+// Moves projects between devices as .tar.gz files. The tar stream is cut
+// into chunks that are deflated in parallel (with qCompress, the zlib Qt
+// already carries) and written as separate gzip members, which any gunzip
+// reads as one stream. Each member has an extra field with the zlib
+// checksum and the compressed size, so that the members of our own
+// archives can be found and inflated without a streaming inflater; every
+// file has its SHA-256 in a pax header and is checked as it is extracted.
+// Neither side holds more than a few chunks in memory.
+class ProjectArchive
+{
+public:
+    // called after every file written or chunk read, false cancels
+    typedef std::function<bool ()> Progress;
+
+    // writes the files under dirPath to archivePath, inside a directory
+    // named after dirPath; the archive only appears once it is complete
+    static bool write(const QString &dirPath, const QString &archivePath, const Progress &progress);
+
+    // extracts archivePath into dirPath, which must not exist yet; the
+    // files go to a hidden directory next to it that is renamed when all
+    // of them have been checked
+    static bool extract(const QString &archivePath, const QString &dirPath, const Progress &progress);
+
+    // how often extract calls progress, without inflating anything
+    static int chunkCount(const QString &archivePath);
+
+    // the uncompressed size of a chunk
+    static const int ChunkSize = 1024 * 1024;
+};
+
+#endif // PROJECTARCHIVE_H
@@ -17,14 +17,57 @@
 ****************************************************************************/
 
 #include "ProjectManager.h"
+#include "MappedFile.h"
 
 #include <QDebug>
 
 ProjectManager::ProjectManager(QObject *parent) :
-    QObject(parent)
+    ProjectManager(new DiskFileSystem(rootPath()), parent)
 {
-    QDir().mkpath(baseFolderPath(Projects));
-    QDir().mkpath(baseFolderPath(Examples));
+}
+
+ProjectManager::ProjectManager(FileSystem *fileSystem, QObject *parent) :
+    QObject(parent),
+    m_baseFolder(Projects),
+    m_baseFoldersReady(false),
+    m_fileSystem(fileSystem),
+    m_exampleResources(new ResourceFileSystem(":/qml/examples")),
+    m_examplesKnown(false),
+    m_examplesOnDisk(false),
+    m_restoreJob(0),
+    m_jobQueue(new FileJobQueue(this))
+{
+    QObject::connect(m_jobQueue, &FileJobQueue::jobsChanged, this, &ProjectManager::jobsChanged);
+    QObject::connect(m_jobQueue, &FileJobQueue::progressed, this, &ProjectManager::jobProgressed);
+    QObject::connect(m_jobQueue, &FileJobQueue::finished, this,
+                     [this](int id, bool succeeded, bool canceled, const QString &description,
+                            const QStringList &changedDirectories) {
+        if (!succeeded && !canceled)
+            emit error(QString("Unable to %1").arg(description));
+        for (const QString &dirPath : changedDirectories)
+            emit listingChanged(dirPath);
+        // a failed or canceled job may have changed some of them
+        for (const QString &path : m_changedPaths.take(id))
+            emit filesChanged(path);
+        if (m_restoreJob == id)
+            m_restoreJob = 0;
+        m_examplesKnown = false;
+        emit readOnlyChanged();
+        emit jobFinished(id, succeeded);
+    });
+}
+
+void ProjectManager::ensureBaseFolders()
+{
+    // Created on first use rather than in the constructor, the singleton
+    // is instantiated while the first screen is being built
+    if (m_baseFoldersReady)
+        return;
+
+    m_fileSystem->makePath(folderName(Projects));
+    m_fileSystem->makePath(folderName(Examples));
+    m_fileSystem->makePath(folderName(Archives));
+    m_baseFoldersReady = true;
 }
 
 ProjectManager::BaseFolder ProjectManager::baseFolder()
@@ -38,18 +81,25 @@ void ProjectManager::setBaseFolder(BaseFolder baseFolder)
     {
         m_baseFolder = baseFolder;
         emit baseFolderChanged();
+        emit readOnlyChanged();
     }
 }
 
+bool ProjectManager::readOnly()
+{
+    return locate(m_baseFolder).fileSystem->isReadOnly();
+}
+
 QStringList ProjectManager::projects()
 {
-    QDir dir(baseFolderPath(m_baseFolder));
+    ensureBaseFolders();
+
+    const Location location = locate(m_baseFolder);
     QStringList projects;
-    QFileInfoList folders = dir.entryInfoList(QDir::AllDirs | QDir::NoDotAndDotDot);
 
-    foreach(QFileInfo folder, folders) {
-        QString folderName = folder.fileName();
-        projects.push_back(folderName);
+    foreach (const FileSystem::Entry &entry, location.fileSystem->entries(location.path)) {
+        if (entry.isDir)
+            projects.push_back(entry.name);
     }
 
     return projects;
@@ -57,17 +107,13 @@ QStringList ProjectManager::projects()
 
 void ProjectManager::createProject(QString projectName)
 {
-    QDir dir(baseFolderPath(Projects));
-    if (dir.mkpath(projectName))
+    ensureBaseFolders();
+
+    const Location location = locate(Projects, projectName);
+    if (location.fileSystem->makePath(location.path))
     {
-        QFile file(baseFolderPath(Projects) + QDir::separator() + projectName + QDir::separator() + "main.qml");
-        if (file.open(QIODevice::WriteOnly | QIODevice::Text))
-        {
-            QString fileContent = "// Project \"" + projectName + "\"\n" + newFileContent("main");
-            QTextStream textStream(&file);
-            textStream<<fileContent;
-        }
-        else
+        QString fileContent = "// Project \"" + projectName + "\"\n" + newFileContent("main");
+        if (!location.fileSystem->write(FileSystem::joinPath(location.path, "main.qml"), fileContent.toUtf8()))
         {
             qWarning() << "Unable to create file \"main.qml\"";
             emit error(QString("Unable to create file \"main.qml\""));
@@ -75,52 +121,114 @@ void ProjectManager::createProject(QString projectName)
     }
     else
     {
-        qWarning() << "Failed to create folder" << dir.absolutePath();
+        qWarning() << "Failed to create folder" << location.fileSystem->filePath(location.path);
         emit error(QString("Unable to create folder \"%1\".").arg(projectName));
     }
 }
 
-void ProjectManager::removeProject(QString projectName)
+int ProjectManager::removeProject(QString projectName)
 {
-    QDir dir(baseFolderPath(m_baseFolder) + QDir::separator() + projectName);
-    dir.removeRecursively();
+    return enqueue(QString("delete project \"%1\"").arg(projectName),
+                   { { FileJobQueue::Remove, locate(m_baseFolder, projectName), Location() } });
+}
+
+int ProjectManager::duplicateProject(QString projectName, QString newProjectName)
+{
+    ensureBaseFolders();
+
+    return enqueue(QString("copy project \"%1\"").arg(projectName),
+                   { { FileJobQueue::Copy, locate(m_baseFolder, projectName), locate(Projects, newProjectName) } });
 }
 
 bool ProjectManager::projectExists(QString projectName)
 {
-    QFileInfo checkFile(baseFolderPath(Projects) + QDir::separator() + projectName);
-    return checkFile.exists();
+    const Location location = locate(Projects, projectName);
+    return location.fileSystem->exists(location.path);
 }
 
-void ProjectManager::restoreExamples()
+int ProjectManager::restoreExamples()
 {
-    QDir deviceExamplesDir(baseFolderPath(Examples));
-    deviceExamplesDir.removeRecursively();
-    deviceExamplesDir.mkpath(baseFolderPath(Examples));
+    ensureBaseFolders();
 
-    QDir qrcExamplesDir(":/qml/examples");
-    QFileInfoList folders = qrcExamplesDir.entryInfoList(QDir::AllDirs | QDir::NoDotAndDotDot);
+    const Location examples = { m_fileSystem.data(), folderName(Examples) };
+    const Location resources = { m_exampleResources.data(), QString() };
+    const int id = enqueue(QString("restore the examples"),
+                           { { FileJobQueue::Remove, examples, Location() },
+                             { FileJobQueue::Copy, resources, examples } });
 
-    foreach(QFileInfo folder, folders) {
-        QString folderName = folder.fileName();
-        deviceExamplesDir.mkpath(folderName);
+    // half removed or half copied until the job is done
+    if (id != 0)
+    {
+        m_restoreJob = id;
+        emit readOnlyChanged();
+    }
+    return id;
+}
 
-        QDir qrcExampleDir(":/qml/examples/" + folderName);
+// the directory projects() lists, as listingChanged reports it
+QString ProjectManager::projectsPath()
+{
+    return listingPath(locate(m_baseFolder));
+}
 
-        QFileInfoList files = qrcExampleDir.entryInfoList(QDir::Files);
+int ProjectManager::exportProject(QString projectName)
+{
+    ensureBaseFolders();
 
-        foreach(QFileInfo file, files) {
-            QString fileName = file.fileName();
-            QFile::copy(file.absoluteFilePath(), baseFolderPath(Examples) + QDir::separator() + folderName + QDir::separator() + fileName);
+    return enqueue(QString("export project \"%1\"").arg(projectName),
+                   { { FileJobQueue::Archive, locate(m_baseFolder, projectName),
+                       locate(Archives, projectName + ".tar.gz") } });
+}
 
-            QFile::setPermissions(baseFolderPath(Examples) + QDir::separator() + folderName + QDir::separator() + fileName,
-                                  QFileDevice::ReadOwner | QFileDevice::WriteOwner |
-                                  QFileDevice::ReadUser  | QFileDevice::WriteUser  |
-                                  QFileDevice::ReadGroup | QFileDevice::WriteGroup |
-                                  QFileDevice::ReadOther | QFileDevice::WriteOther
-                                  );
-        }
+// extracts an archive of the Archives folder as a new project, named
+// after the archive and numbered if that project exists
+int ProjectManager::importProject(QString archiveName)
+{
+    ensureBaseFolders();
+
+    QString projectName = archiveName;
+    if (projectName.endsWith(".tar.gz"))
+        projectName.chop(7);
+
+    const QString baseName = projectName;
+    for (int number = 2; projectExists(projectName); number++)
+        projectName = QString("%1 %2").arg(baseName).arg(number);
+
+    return enqueue(QString("import \"%1\"").arg(archiveName),
+                   { { FileJobQueue::Extract, locate(Archives, archiveName), locate(Projects, projectName) } });
+}
+
+QStringList ProjectManager::archives()
+{
+    ensureBaseFolders();
+
+    const Location location = locate(Archives);
+    QStringList archives;
+    foreach (const FileSystem::Entry &entry, location.fileSystem->entries(location.path)) {
+        if (!entry.isDir && entry.name.endsWith(".tar.gz"))
+            archives.push_back(entry.name);
+    }
+    return archives;
+}
+
+QString ProjectManager::archivesPath()
+{
+    return listingPath(locate(Archives));
+}
+
+// what importFile takes from the Archives folder, next to the archives
+QStringList ProjectManager::importableFiles()
+{
+    ensureBaseFolders();
+
+    const Location location = locate(Archives);
+    QStringList files;
+    foreach (const FileSystem::Entry &entry, location.fileSystem->entries(location.path)) {
+        const QString suffix = QFileInfo(entry.name).suffix();
+        if (!entry.isDir && (suffix == "qml" || suffix == "js"))
+            files.push_back(entry.name);
     }
+    return files;
 }
 
 QString ProjectManager::projectName()
@@ -153,26 +261,17 @@ void ProjectManager::setSubDir(QString dir)
 
 QVariantList ProjectManager::files()
 {
-    QDir dir(baseFolderPath(m_baseFolder) +
-             QDir::separator() + m_projectName + QDir::separator() + m_subdir);
+    const Location location = currentLocation();
     QVariantList projectFiles;
-    QFileInfoList files = dir.entryInfoList(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot);
 
-    foreach(QFileInfo file, files) {
-        qDebug() << file.absolutePath();
-        if (!file.isDir() && (file.suffix() == "qml" || file.suffix() == "js"))
+    foreach (const FileSystem::Entry &entry, location.fileSystem->entries(location.path)) {
+        const QString suffix = QFileInfo(entry.name).suffix();
+        if (entry.isDir || suffix == "qml" || suffix == "js")
         {
             QVariantMap fileEntry;
-            QString fileName = file.fileName();
-            fileEntry.insert("name", fileName);
-            fileEntry.insert("isDir", false);
+            fileEntry.insert("name", entry.name);
+            fileEntry.insert("isDir", entry.isDir);
             projectFiles.push_back(fileEntry);
-        } else if (file.isDir()) {
-            QVariantMap dirEntry;
-            QString fileName = file.fileName();
-            dirEntry.insert("name", fileName);
-            dirEntry.insert("isDir", true);
-            projectFiles.push_back(dirEntry);
         }
     }
 
@@ -181,56 +280,45 @@ QVariantList ProjectManager::files()
 
 void ProjectManager::createFile(QString fileName, QString fileExtension)
 {
-    QFile file(baseFolderPath(m_baseFolder) +
-               QDir::separator() + m_projectName +
-               QDir::separator() + m_subdir +
-               QDir::separator() + fileName + "." + fileExtension);
-    if (file.open(QIODevice::WriteOnly | QIODevice::Text))
-    {
-        QTextStream textStream(&file);
-        textStream<<newFileContent(fileExtension);
-    }
-    else
-    {
+    const Location location = currentLocation(fileName + "." + fileExtension);
+    if (!location.fileSystem->write(location.path, newFileContent(fileExtension).toUtf8()))
         emit error(QString("Unable to create file \"%1.%2\"").arg(fileName, fileExtension));
-    }
 }
 
-void ProjectManager::removeFile(QString fileName)
+int ProjectManager::removeFile(QString fileName)
+{
+    qDebug() << "Removing" << filePath(fileName);
+    return enqueue(QString("delete \"%1\"").arg(fileName),
+                   { { FileJobQueue::Remove, currentLocation(fileName), Location() } });
+}
+
+// renames, or moves when newFileName has directories in it, relative to the current subdir
+int ProjectManager::moveFile(QString fileName, QString newFileName)
 {
-    const QString filePath =
-            baseFolderPath(m_baseFolder) +
-            QDir::separator() + m_projectName +
-            QDir::separator() + m_subdir +
-            QDir::separator() + fileName;
-    qDebug() << "Removing" << filePath;
+    return enqueue(QString("move \"%1\" to \"%2\"").arg(fileName, newFileName),
+                   { { FileJobQueue::Move, currentLocation(fileName), currentLocation(newFileName) } });
+}
 
-    const bool isDir = QFileInfo(filePath).isDir();
-    if (isDir) {
-        QDir(filePath).removeRecursively();
-    } else {
-       QDir().remove(filePath);
-    }
+// copies a file or directory from outside the project into the current subdir
+int ProjectManager::importFile(QString sourcePath)
+{
+    const QFileInfo source(QDir::cleanPath(sourcePath));
+    DiskFileSystem outside(source.absolutePath());
+    return enqueue(QString("import \"%1\"").arg(source.fileName()),
+                   { { FileJobQueue::Copy, { &outside, source.fileName() }, currentLocation(source.fileName()) } });
 }
 
 void ProjectManager::createDir(QString dirName)
 {
-    const QString fullPath =
-            baseFolderPath(m_baseFolder) +
-            QDir::separator() + m_projectName +
-            QDir::separator() + m_subdir +
-            QDir::separator() + dirName;
-    qDebug() << "Creating dir" << fullPath;
-    QDir().mkpath(fullPath);
+    const Location location = currentLocation(dirName);
+    qDebug() << "Creating dir" << location.fileSystem->filePath(location.path);
+    location.fileSystem->makePath(location.path);
 }
 
 bool ProjectManager::fileExists(QString fileName)
 {
-    QFileInfo checkFile(baseFolderPath(m_baseFolder) +
-                        QDir::separator() + m_projectName +
-                        QDir::separator() + m_subdir +
-                        QDir::separator() + fileName);
-    return checkFile.exists();
+    const Location location = currentLocation(fileName);
+    return location.fileSystem->exists(location.path);
 }
 
 QString ProjectManager::fileName()
@@ -247,13 +335,8 @@ void ProjectManager::setFileName(QString fileName)
 {
     if (m_fileName != fileName)
     {
-        QFileInfo fileInfo(baseFolderPath(m_baseFolder) +
-                           QDir::separator() + m_projectName +
-                           QDir::separator() + m_subdir +
-                           QDir::separator() + fileName);
-
         m_fileName = fileName;
-        m_fileFormat = fileInfo.suffix();
+        m_fileFormat = QFileInfo(fileName).suffix();
 
         emit fileNameChanged();
         emit fileFormatChanged();
@@ -262,33 +345,244 @@ void ProjectManager::setFileName(QString fileName)
 
 QString ProjectManager::getFilePath()
 {
-    return "file:///" + baseFolderPath(m_baseFolder) +
-            QDir::separator() + m_projectName +
-            QDir::separator() + m_subdir +
-            QDir::separator() + m_fileName;
+    const Location location = currentLocation(m_fileName);
+    return location.fileSystem->url(location.path).toString();
 }
 
 QString ProjectManager::getFileContent()
 {
-    QFile file(baseFolderPath(m_baseFolder) +
-               QDir::separator() + m_projectName +
-               QDir::separator() + m_subdir +
-               QDir::separator() + m_fileName);
-    file.open(QIODevice::ReadOnly | QIODevice::Text);
-    QTextStream textStream(&file);
-    QString fileContent = textStream.readAll().trimmed();
-    return fileContent;
+    const Location location = currentLocation(m_fileName);
+    return QString::fromUtf8(location.fileSystem->read(location.path)).trimmed();
 }
 
 void ProjectManager::saveFileContent(QString content)
 {
-    QFile file(baseFolderPath(m_baseFolder) +
-               QDir::separator() + m_projectName +
-               QDir::separator() + m_subdir +
-               QDir::separator() + m_fileName);
-    file.open(QIODevice::WriteOnly | QIODevice::Text);
-    QTextStream textStream(&file);
-    textStream<<content;
+    const Location location = currentLocation(m_fileName);
+    if (location.fileSystem->write(location.path, content.toUtf8()))
+        emit fileSaved(location.fileSystem->filePath(location.path));
+}
+
+bool ProjectManager::loadBuffer(TextBuffer *buffer)
+{
+    if (!buffer)
+        return false;
+
+    // the buffer reads files on disk itself, for the edit history kept next to them
+    const Location location = currentLocation(m_fileName);
+    if (location.fileSystem->isLocal())
+        return buffer->load(location.fileSystem->filePath(location.path));
+
+    bool read = false;
+    const QByteArray content = location.fileSystem->read(location.path, &read);
+    if (read)
+        buffer->loadText(QString::fromUtf8(content).trimmed());
+    return read;
+}
+
+void ProjectManager::saveBuffer(TextBuffer *buffer)
+{
+    if (!buffer)
+        return;
+
+    const Location location = currentLocation(m_fileName);
+    if (location.fileSystem->isReadOnly())
+    {
+        emit error(QString("Unable to save file \"%1\", restore the examples to edit them").arg(m_fileName));
+        return;
+    }
+
+    const bool saved = location.fileSystem->isLocal() ?
+                buffer->save(location.fileSystem->filePath(location.path)) :
+                location.fileSystem->write(location.path, buffer->text().toUtf8());
+    if (saved)
+        emit fileSaved(location.fileSystem->filePath(location.path));
+    else
+        emit error(QString("Unable to save file \"%1\"").arg(m_fileName));
+}
+
+bool ProjectManager::isLargeFile()
+{
+    // the viewer maps the file, it has to be on disk
+    const Location location = currentLocation(m_fileName);
+    return location.fileSystem->isLocal() &&
+            location.fileSystem->size(location.path) >= MappedFile::LargeFileSize;
+}
+
+// file of the current project and subdir
+QString ProjectManager::filePath(QString fileName)
+{
+    const Location location = currentLocation(fileName);
+    return location.fileSystem->filePath(location.path);
+}
+
+// the directory files() lists, as listingChanged reports it
+QString ProjectManager::currentDirPath()
+{
+    return listingPath(currentLocation());
+}
+
+int ProjectManager::jobCount()
+{
+    return m_jobQueue->count();
+}
+
+qreal ProjectManager::jobProgress()
+{
+    return m_jobQueue->progress();
+}
+
+void ProjectManager::cancelJob(int id)
+{
+    m_jobQueue->cancel(id);
+}
+
+void ProjectManager::cancelAllJobs()
+{
+    m_jobQueue->cancelAll();
+}
+
+// Queues the operations when all their files are on disk, or else runs
+// them right away through the file systems and returns 0
+int ProjectManager::enqueue(QString description, const QVector<Operation> &operations)
+{
+    QVector<FileJobQueue::Step> steps;
+    QStringList changedPaths;
+    QStringList removedPaths;
+    bool local = true;
+    foreach (const Operation &operation, operations) {
+        FileSystem *source = operation.source.fileSystem;
+        FileSystem *target = operation.target.fileSystem;
+        const bool sourceWritten = !target || operation.operation == FileJobQueue::Move;
+        if ((sourceWritten && source->isReadOnly()) || (target && target->isReadOnly()))
+        {
+            emit error(QString("Unable to %1, it is read-only").arg(description));
+            return 0;
+        }
+
+        // copies and moves go nowhere that exists, unless an earlier step
+        // removes it; an export replaces its archive
+        const bool createsTarget = operation.operation == FileJobQueue::Copy ||
+                operation.operation == FileJobQueue::Move;
+        if (createsTarget && target->exists(operation.target.path) &&
+                !removedPaths.contains(target->filePath(operation.target.path)))
+        {
+            emit error(QString("Unable to %1, \"%2\" exists")
+                       .arg(description, QFileInfo(operation.target.path).fileName()));
+            return 0;
+        }
+        if (!target)
+            removedPaths << source->filePath(operation.source.path);
+
+        local = local && source->isLocal() && (!target || target->isLocal());
+        // what open editors of these files no longer match
+        changedPaths << (target ? target->filePath(operation.target.path) : source->filePath(operation.source.path));
+        if (operation.operation == FileJobQueue::Move)
+            changedPaths << source->filePath(operation.source.path);
+        steps.push_back({ operation.operation, source->filePath(operation.source.path),
+                          target ? target->filePath(operation.target.path) : QString() });
+    }
+
+    if (local)
+    {
+        const int id = m_jobQueue->enqueue(description, steps);
+        m_changedPaths.insert(id, changedPaths);
+        return id;
+    }
+
+    bool succeeded = true;
+    QStringList changedDirectories;
+    foreach (const Operation &operation, operations) {
+        FileSystem *source = operation.source.fileSystem;
+        FileSystem *target = operation.target.fileSystem;
+        const QString &sourcePath = operation.source.path;
+        const QString &targetPath = operation.target.path;
+
+        switch (operation.operation)
+        {
+        case FileJobQueue::Remove:
+            succeeded = !source->exists(sourcePath) || source->remove(sourcePath);
+            break;
+        case FileJobQueue::Copy:
+            // never into what is there, so no half copies are left behind
+            if (target->exists(targetPath))
+            {
+                succeeded = false;
+                break;
+            }
+            succeeded = FileSystem::copy(*source, sourcePath, *target, targetPath);
+            if (!succeeded)
+                target->remove(targetPath);
+            break;
+        case FileJobQueue::Move:
+            succeeded = (source == target) ? source->rename(sourcePath, targetPath) :
+                                             FileSystem::copy(*source, sourcePath, *target, targetPath) &&
+                                             source->remove(sourcePath);
+            break;
+        case FileJobQueue::Archive:
+        case FileJobQueue::Extract:
+            // archives are streamed from and to files on disk
+            succeeded = false;
+            break;
+        }
+
+        // as the job queue reports them
+        QList<Location> locations = { operation.source };
+        if (target)
+            locations += operation.target;
+        foreach (const Location &location, locations) {
+            const Location parent = { location.fileSystem, FileSystem::joinPath(location.path, "..") };
+            changedDirectories << listingPath(parent) << listingPath(location);
+        }
+
+        if (!succeeded)
+            break;
+    }
+
+    if (!succeeded)
+        emit error(QString("Unable to %1").arg(description));
+    changedDirectories.removeDuplicates();
+    for (const QString &dirPath : changedDirectories)
+        emit listingChanged(dirPath);
+    for (const QString &path : changedPaths)
+        emit filesChanged(path);
+    m_examplesKnown = false;
+    emit readOnlyChanged();
+    emit jobFinished(0, succeeded);
+    return 0;
+}
+
+// Until the examples are restored to disk they open from the resources
+ProjectManager::Location ProjectManager::locate(BaseFolder folder, QString path)
+{
+    if (folder == Examples && !examplesOnDisk())
+        return { m_exampleResources.data(), FileSystem::cleanPath(path) };
+
+    return { m_fileSystem.data(), FileSystem::joinPath(folderName(folder), path) };
+}
+
+// Every job may have restored or removed them, nothing else can
+bool ProjectManager::examplesOnDisk()
+{
+    if (m_restoreJob != 0)
+        return false;
+
+    if (!m_examplesKnown)
+    {
+        m_examplesOnDisk = !m_fileSystem->entries(folderName(Examples)).isEmpty();
+        m_examplesKnown = true;
+    }
+    return m_examplesOnDisk;
+}
+
+// fileName in the current project and subdir, the subdir itself without one
+ProjectManager::Location ProjectManager::currentLocation(QString fileName)
+{
+    return locate(m_baseFolder, m_projectName + "/" + m_subdir + "/" + fileName);
+}
+
+QString ProjectManager::listingPath(const Location &location)
+{
+    return QDir::cleanPath(location.fileSystem->filePath(location.path));
 }
 
 QQmlApplicationEngine *ProjectManager::m_qmlEngine = Q_NULLPTR;
@@ -312,34 +606,32 @@ QObject *ProjectManager::projectManagerProvider(QQmlEngine *engine, QJSEngine *s
     return projectManager;
 }
 
-QString ProjectManager::baseFolderPath(BaseFolder folder)
+// Looked up once, every path is relative to it from there on
+QString ProjectManager::rootPath()
 {
-    QString folderName;
-
-    switch (folder)
-    {
-    case Projects:
-        folderName = "Projects";
-        break;
-    case Examples:
-        folderName = "Examples";
-        break;
-    }
-
 #ifndef UBUNTU_CLICK
-    QString folderPath = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation) +
+    static const QString path = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation) +
 #else
-    QString folderPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) +
+    static const QString path = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) +
 #endif
-                         QDir::separator() +
-                         "QML Projects";
+                                QDir::separator() +
+                                "QML Projects";
+    return path;
+}
 
-    if (!folderName.isEmpty())
+QString ProjectManager::folderName(BaseFolder folder)
+{
+    switch (folder)
     {
-        folderPath += QDir::separator() + folderName;
+    case Projects:
+        return "Projects";
+    case Examples:
+        return "Examples";
+    case Archives:
+        return "Archives";
     }
 
-    return folderPath;
+    return QString();
 }
 
 QString ProjectManager::newFileContent(QString fileType)
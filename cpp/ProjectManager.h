@@ -22,11 +22,16 @@
 #include <QObject>
 #include <QFile>
 #include <QFileInfo>
+#include <QHash>
 #include <QDir>
 #include <QIODevice>
 #include <QStandardPaths>
 #include <QTextStream>
 #include <QQmlApplicationEngine>
+#include <QScopedPointer>
+#include "FileJobQueue.h"
+#include "FileSystem.h"
+#include "TextBuffer.h"
 
 class ProjectManager : public QObject
 {
@@ -38,20 +43,37 @@ class ProjectManager : public QObject
     Q_PROPERTY(QString subDir READ subDir WRITE setSubDir NOTIFY subDirChanged)
     Q_PROPERTY(QString fileName READ fileName WRITE setFileName NOTIFY fileNameChanged)
     Q_PROPERTY(QString fileFormat READ fileFormat NOTIFY fileFormatChanged)
+    Q_PROPERTY(bool readOnly READ readOnly NOTIFY readOnlyChanged)
+    Q_PROPERTY(int jobCount READ jobCount NOTIFY jobsChanged)
+    Q_PROPERTY(qreal jobProgress READ jobProgress NOTIFY jobsChanged)
 
 public:
     explicit ProjectManager(QObject *parent = 0);
+    // projects, examples and archives live in fileSystem instead of the
+    // documents folder, which the manager takes ownership of
+    explicit ProjectManager(FileSystem *fileSystem, QObject *parent = 0);
 
-    enum BaseFolder { Projects, Examples };
+    enum BaseFolder { Projects, Examples, Archives };
 
     // project management
     BaseFolder baseFolder();
     void setBaseFolder(BaseFolder baseFolder);
+    // the examples are read-only while they open from the resources, until restored
+    bool readOnly();
     Q_INVOKABLE QStringList projects();
     Q_INVOKABLE void createProject(QString projectName);
-    Q_INVOKABLE void removeProject(QString projectName);
+    Q_INVOKABLE int removeProject(QString projectName);
+    Q_INVOKABLE int duplicateProject(QString projectName, QString newProjectName);
     Q_INVOKABLE bool projectExists(QString projectName);
-    Q_INVOKABLE void restoreExamples();
+    Q_INVOKABLE int restoreExamples();
+    Q_INVOKABLE QString projectsPath();
+
+    // project archives, exported to and imported from the Archives folder
+    Q_INVOKABLE int exportProject(QString projectName);
+    Q_INVOKABLE int importProject(QString archiveName);
+    Q_INVOKABLE QStringList archives();
+    Q_INVOKABLE QString archivesPath();
+    Q_INVOKABLE QStringList importableFiles();
 
     // current subdir
     QString subDir();
@@ -62,9 +84,21 @@ public:
     void setProjectName(QString projectName);
     Q_INVOKABLE QVariantList files();
     Q_INVOKABLE void createFile(QString fileName, QString fileExtension);
-    Q_INVOKABLE void removeFile(QString fileName);
+    Q_INVOKABLE int removeFile(QString fileName);
+    Q_INVOKABLE int moveFile(QString fileName, QString newFileName);
+    Q_INVOKABLE int importFile(QString sourcePath);
     Q_INVOKABLE void createDir(QString dirName);
     Q_INVOKABLE bool fileExists(QString projectName);
+    Q_INVOKABLE QString filePath(QString fileName);
+    Q_INVOKABLE QString currentDirPath();
+
+    // background file operations, the methods above that return a job id
+    // queue one; listingChanged tells which listings to read again after,
+    // filesChanged which open files are no longer what is on disk
+    int jobCount();
+    qreal jobProgress();
+    Q_INVOKABLE void cancelJob(int id);
+    Q_INVOKABLE void cancelAllJobs();
 
     // current file
     QString fileName();
@@ -73,6 +107,10 @@ public:
     Q_INVOKABLE QString getFilePath();
     Q_INVOKABLE QString getFileContent();
     Q_INVOKABLE void saveFileContent(QString content);
+    Q_INVOKABLE bool loadBuffer(TextBuffer *buffer);
+    Q_INVOKABLE void saveBuffer(TextBuffer *buffer);
+    // too large for the editor, it opens in the viewer (see MappedFile)
+    Q_INVOKABLE bool isLargeFile();
 
     // QML engine stuff
     static void setQmlEngine(QQmlApplicationEngine *engine);
@@ -84,9 +122,43 @@ public:
 private:
     // project management
     BaseFolder m_baseFolder;
-    QString baseFolderPath(BaseFolder folder);
+    bool m_baseFoldersReady;
+    void ensureBaseFolders();
+    static QString rootPath();
+    static QString folderName(BaseFolder folder);
     QString newFileContent(QString fileType);
 
+    // all paths go through these
+    QScopedPointer<FileSystem> m_fileSystem;
+    QScopedPointer<FileSystem> m_exampleResources;
+
+    struct Location
+    {
+        FileSystem *fileSystem;
+        QString path;
+    };
+    Location locate(BaseFolder folder, QString path = QString());
+    // whether the examples were restored, looked up again once a job is
+    // done; not while the job restoring them runs
+    bool examplesOnDisk();
+    bool m_examplesKnown;
+    bool m_examplesOnDisk;
+    int m_restoreJob;
+    Location currentLocation(QString fileName = QString());
+    QString listingPath(const Location &location);
+
+    // background file operations
+    struct Operation
+    {
+        FileJobQueue::Operation operation;
+        Location source;
+        Location target;
+    };
+    int enqueue(QString description, const QVector<Operation> &operations);
+    FileJobQueue *m_jobQueue;
+    // by job id, what filesChanged reports when the job is done
+    QHash<int, QStringList> m_changedPaths;
+
     // current project
     QString m_projectName;
 
@@ -102,11 +174,20 @@ private:
 
 signals:
     void baseFolderChanged();
+    void readOnlyChanged();
     void projectNameChanged();
     void subDirChanged();
     void fileNameChanged();
     void fileFormatChanged();
     void error(QString description);
+    void jobsChanged();
+    void jobProgressed(int id, int done, int total);
+    void jobFinished(int id, bool succeeded);
+    void listingChanged(QString dirPath);
+    // path, or what is below it, was removed or replaced by a job
+    void filesChanged(QString path);
+    // the current file was written by saveBuffer or saveFileContent
+    void fileSaved(QString path);
 };
 
 #endif // PROJECTMANAGER_H
@@ -17,23 +17,87 @@
 ****************************************************************************/
 
 #include "QMLHighlighter.h"
+#include "LatencyTracer.h"
+#include <QTextDocument>
+#include <algorithm>
 
-bool QMLHighlighter::m_cacheLoaded = false;
-QSet<QString> QMLHighlighter::m_keywordsCache = QSet<QString>();
-QSet<QString> QMLHighlighter::m_jsIdsCache = QSet<QString>();
-QSet<QString> QMLHighlighter::m_qmlIdsCache = QSet<QString>();
-QSet<QString> QMLHighlighter::m_propertiesCache = QSet<QString>();
+// Block states, the lexer's state in the low bits, the embedded lexer's
+// state and the quote of the string it is in above them, the bracket
+// level on top
+enum {
+    StartState = 0,
+    CommentState = 4,
+    EmbeddedState = 5,      // in a string lexed as the embedded language
+    BindingState = 6,       // in a binding to an embedding property, its value goes on
+    StateMask = 15,
+    NestedShift = 4,
+    QuoteShift = 8,
+    LevelShift = 10
+};
+
+// adjacent ranges of the same colour become one setFormat call
+static void appendSpan(QVector<FormatSpan> &spans, int start, int count, unsigned char component)
+{
+    if (!spans.isEmpty()) {
+        FormatSpan &last = spans.last();
+        if (last.component == component && last.start + last.length == start) {
+            last.length += count;
+            return;
+        }
+    }
+    spans += FormatSpan { start, count, component };
+}
+
+// strings, comments and directives of the top level language, the parts
+// of the text CodeFormatter leaves alone
+static void appendLiteral(BlockData *blockData, int start, int count, unsigned char component)
+{
+    if (blockData)
+        blockData->literals += FormatSpan { start, count, component };
+}
+
+// the first quote at or after from not preceded by a backslash, -1 if none
+static int closingQuote(const QString &text, QChar quote, int from)
+{
+    int end = text.indexOf(quote, from);
+    while (end > 0 && text.at(end - 1) == QLatin1Char('\\'))
+        end = text.indexOf(quote, end + 1);
+    return end;
+}
+
+static Token::Keyword keywordOf(const QStringRef &word)
+{
+    if (word.length() > 2 && word.startsWith(QLatin1String("on")) && word.at(2).isUpper())
+        return Token::Handler;
+    if (word == QLatin1String("property"))
+        return Token::Property;
+    if (word == QLatin1String("signal"))
+        return Token::Signal;
+    if (word == QLatin1String("function"))
+        return Token::Function;
+    if (word == QLatin1String("id"))
+        return Token::Id;
+    if (word == QLatin1String("readonly"))
+        return Token::Readonly;
+    if (word == QLatin1String("default"))
+        return Token::Default;
+    if (word == QLatin1String("required"))
+        return Token::Required;
+    if (word == QLatin1String("import"))
+        return Token::Import;
+    if (word == QLatin1String("pragma"))
+        return Token::Pragma;
+    return Token::NoKeyword;
+}
 
 QMLHighlighter::QMLHighlighter(QTextDocument *parent) : QSyntaxHighlighter(parent)
+    , m_language(&Language::qml())
+    , m_brackets(parent)
+    , m_blockCount(0)
+    , m_tokensChanged(false)
     , m_markCaseSensitivity(Qt::CaseInsensitive)
 {
-    if (!m_cacheLoaded) {
-        loadDictionary(":/resources/dictionaries/keywords.txt", m_keywordsCache);
-        loadDictionary(":/resources/dictionaries/javascript.txt", m_jsIdsCache);
-        loadDictionary(":/resources/dictionaries/qml.txt", m_qmlIdsCache);
-        loadDictionary(":/resources/dictionaries/properties.txt", m_propertiesCache);
-        m_cacheLoaded = true;
-    }
+
 }
 
 void QMLHighlighter::setColor(ColorComponent component, const QColor &color)
@@ -41,132 +105,311 @@ void QMLHighlighter::setColor(ColorComponent component, const QColor &color)
     m_colors[component] = color;
 }
 
-void QMLHighlighter::highlightBlock(const QString &text)
+QColor QMLHighlighter::color(ColorComponent component) const
 {
-    enum {
-        StartState = 0,
-        NumberState = 1,
-        IdentifierState = 2,
-        StringState = 3,
-        CommentState = 4
-    };
+    return m_colors.value(component);
+}
 
-    QList<int> bracketPositions;
+void QMLHighlighter::highlightBlock(const QString &text)
+{
+    LatencyTracer::Scope trace(LatencyTracer::Highlight);
 
     int blockState = previousBlockState();
-    int bracketLevel = blockState >> 4;
-    int state = blockState & 15;
+    int bracketLevel = blockState >> LevelShift;
+    int state = blockState & ((1 << LevelShift) - 1);
     if (blockState < 0) {
         bracketLevel = 0;
         state = StartState;
     }
 
-    int start = 0;
-    int i = 0;
-    while (i <= text.length()) {
-        QChar ch = (i < text.length()) ? text.at(i) : QChar();
-        QChar next = (i < text.length() - 1) ? text.at(i + 1) : QChar();
+    // reuse the block's data, this runs for every block on each rehighlight
+    BlockData *blockData = static_cast<BlockData *>(currentBlockUserData());
+    if (!blockData) {
+        blockData = new BlockData;
+        setCurrentBlockUserData(blockData);
+    }
 
-        switch (state) {
+    // blocks added or removed take the tokens of their neighbours along
+    const quint64 textHash = HighlightCache::hash(text);
+    if (blockData->textHash != textHash || blockData->lexerState != state
+            || document()->blockCount() != m_blockCount) {
+        noteTokenChange(currentBlock());
+        blockData->textHash = textHash;
+        blockData->lexerState = state;
+        m_blockCount = document()->blockCount();
+    }
 
-        case StartState:
-            start = i;
-            if (ch.isSpace()) {
-                ++i;
-            } else if (ch.isDigit()) {
-                ++i;
-                state = NumberState;
-            } else if (ch.isLetter() || ch == '_') {
-                ++i;
-                state = IdentifierState;
-            } else if (ch == '\'' || ch == '\"') {
+    if (applyCachedBlock(textHash, blockData)) {
+        decorate(text, blockData);
+        m_brackets.blockChanged(currentBlock());
+        return;
+    }
+
+    blockData->brackets.clear();
+    blockData->tokens.clear();
+    blockData->spans.clear();
+    blockData->literals.clear();
+    blockData->depthBefore = bracketLevel;
+    blockData->minDepth = bracketLevel;
+
+    state = lex(*m_language, text, 0, text.length(), state, blockData->spans, blockData, bracketLevel);
+    applySpans(blockData->spans);
+
+    blockData->endsInComment = ((state & StateMask) == CommentState);
+    blockData->foldOffset = -1;
+    int unclosed = 0;
+    foreach (const Bracket &bracket, blockData->brackets) {
+        if (bracket.opening) {
+            if (unclosed++ == 0)
+                blockData->foldOffset = bracket.offset;
+        } else if (unclosed > 0) {
+            unclosed--;
+        }
+    }
+    if (unclosed == 0)
+        blockData->foldOffset = -1;
+
+    decorate(text, blockData);
+
+    setCurrentBlockState(state | (bracketLevel << LevelShift));
+    m_brackets.blockChanged(currentBlock());
+}
+
+// The lexer every language shares, driven by the language's character
+// class table. Lexes text[from, to) starting in state and returns the
+// state at its end. Colours go to spans; brackets, tokens and the bracket
+// level are only kept for the top level language, blockData is null for
+// the strings lexed as an embedded language.
+int QMLHighlighter::lex(const Language &language, const QString &text, int from, int to, int state,
+                        QVector<FormatSpan> &spans, BlockData *blockData, int &bracketLevel)
+{
+    const QChar *data = text.constData();
+    const Language *embedded = blockData ? language.embedded() : nullptr;
+    const QVector<Language::KeywordSet> &keywordSets = language.keywordSets();
+    const QVector<QSet<QString>> &words = language.words();
+
+    bool inBinding = false;         // strings are lexed as the embedded language
+    bool afterProperty = false;     // an embedding property was the last token
+    bool lineStart = true;
+    QChar last;                     // last operator or punctuation, null after anything else
+    int start = from;
+    int i = from;
+
+    switch (state & StateMask) {
+    case CommentState: {
+        // a block comment coming from the previous block
+        const int end = text.indexOf(QLatin1String("*/"), from);
+        if (end >= 0 && end + 2 <= to) {
+            i = end + 2;
+            appendSpan(spans, start, i - start, Comment);
+            appendLiteral(blockData, start, i - start, Comment);
+            state = StartState;
+        }
+        break;
+    }
+    case EmbeddedState: {
+        if (!embedded) {
+            state = StartState;
+            break;
+        }
+
+        const QChar quote = (state >> QuoteShift) ? QLatin1Char('\'') : QLatin1Char('"');
+        const int nestedState = (state >> NestedShift) & StateMask;
+        const int end = closingQuote(text, quote, from);
+        if (end < 0 || end >= to) {
+            const int nestedEnd = lex(*embedded, text, from, to, nestedState, spans, nullptr, bracketLevel);
+            appendLiteral(blockData, from, to - from, String);
+            return EmbeddedState | (nestedEnd << NestedShift) | (state & (1 << QuoteShift));
+        }
+        lex(*embedded, text, from, end, nestedState, spans, nullptr, bracketLevel);
+        appendSpan(spans, end, 1, String);
+        appendLiteral(blockData, from, end + 1 - from, String);
+        i = end + 1;
+        inBinding = true;
+        lineStart = false;
+        state = StartState;
+        break;
+    }
+    case BindingState:
+        inBinding = true;
+        state = StartState;
+        break;
+    default:
+        state = StartState;
+        break;
+    }
+
+    while (state == StartState && i < to) {
+        start = i;
+        const QChar ch = data[i];
+        const unsigned short chClass = language.charClass(ch);
+
+        if (chClass & SpaceChar) {
+            do {
                 ++i;
-                state = StringState;
-            } else if (ch == '/' && next == '*') {
+            } while (i < to && (language.charClass(data[i]) & SpaceChar));
+            continue;
+        }
+
+        const bool wasAfterProperty = afterProperty;
+        const bool wasLineStart = lineStart;
+        afterProperty = false;
+        lineStart = false;
+        last = QChar();
+
+        if (chClass & DigitChar) {
+            do {
                 ++i;
+            } while (i < to && (language.charClass(data[i]) & NumberChar));
+            appendSpan(spans, start, i - start, Number);
+        } else if (chClass & IdentifierStartChar) {
+            do {
                 ++i;
-                state = CommentState;
-            } else if (ch == '/' && next == '/') {
-                i = text.length();
-                setFormat(start, text.length(), m_colors[Comment]);
-            } else {
-                if (!QString("(){}[]").contains(ch))
-                    setFormat(start, 1, m_colors[Operator]);
-                if (ch =='{' || ch == '}') {
-                    bracketPositions += i;
-                    if (ch == '{')
-                        bracketLevel++;
-                    else
-                        bracketLevel--;
+            } while (i < to && (language.charClass(data[i]) & IdentifierChar));
+
+            const QStringRef word = text.midRef(start, i - start);
+            if (blockData)
+                blockData->tokens += Token { start, i - start, QChar(), keywordOf(word), ch.isUpper() };
+            afterProperty = embedded && language.embeds(word);
+
+            const QString token = QString::fromRawData(data + start, i - start);
+            for (int set = 0; set < keywordSets.count(); set++) {
+                const Language::KeywordSet &keywordSet = keywordSets.at(set);
+                if (words.at(set).contains(token)
+                        || (keywordSet.extra == Language::KeywordSet::QmlComponents && m_qmlIds.contains(token))
+                        || (keywordSet.extra == Language::KeywordSet::JsComponents && m_jsIds.contains(token))) {
+                    appendSpan(spans, start, i - start, keywordSet.component);
+                    break;
                 }
-                ++i;
-                state = StartState;
             }
-            break;
-
-        case NumberState:
-            if (ch.isSpace() || !ch.isDigit()) {
-                setFormat(start, i - start, m_colors[Number]);
-                state = StartState;
+        } else if (chClass & QuoteChar) {
+            const int end = closingQuote(text, ch, i + 1);
+            if (inBinding && (ch == QLatin1Char('"') || ch == QLatin1Char('\''))) {
+                // the string's content is code of the embedded language
+                appendSpan(spans, start, 1, String);
+                if (end < 0 || end >= to) {
+                    const int nestedState = lex(*embedded, text, i + 1, to, StartState, spans, nullptr, bracketLevel);
+                    appendLiteral(blockData, start, to - start, String);
+                    return EmbeddedState | (nestedState << NestedShift)
+                            | ((ch == QLatin1Char('\'') ? 1 : 0) << QuoteShift);
+                }
+                lex(*embedded, text, i + 1, end, StartState, spans, nullptr, bracketLevel);
+                appendSpan(spans, end, 1, String);
+                i = end + 1;
+            } else if (end < 0 || end >= to) {
+                // strings left open stay uncoloured
+                i = to;
             } else {
-                ++i;
+                i = end + 1;
+                appendSpan(spans, start, i - start, String);
             }
-            break;
-
-        case IdentifierState:
-            if (ch.isSpace() || !(ch.isDigit() || ch.isLetter() || ch == '_')) {
-                QString token = text.mid(start, i - start).trimmed();
-                if (m_keywordsCache.contains(token))
-                    setFormat(start, i - start, m_colors[Keyword]);
-                else if (m_qmlIdsCache.contains(token) || m_qmlIds.contains(token))
-                    setFormat(start, i - start, m_colors[Item]);
-                else if (m_propertiesCache.contains(token))
-                    setFormat(start, i - start, m_colors[Property]);
-                else if (m_jsIdsCache.contains(token) || m_jsIds.contains(token))
-                    setFormat(start, i - start, m_colors[BuiltIn]);
-                state = StartState;
+            appendLiteral(blockData, start, i - start, String);
+        } else if (ch == QLatin1Char('/') && i + 1 < to && data[i + 1] == QLatin1Char('*') && language.comments()) {
+            const int end = text.indexOf(QLatin1String("*/"), i + 2);
+            if (end < 0 || end + 2 > to) {
+                i = to;
+                state = CommentState;
             } else {
-                ++i;
+                i = end + 2;
+                appendSpan(spans, start, i - start, Comment);
+                appendLiteral(blockData, start, i - start, Comment);
             }
-            break;
-
-        case StringState:
-            if (ch == text.at(start)) {
-                QChar prev = (i > 0) ? text.at(i - 1) : QChar();
-                if (prev != '\\') {
-                    ++i;
-                    setFormat(start, i - start, m_colors[String]);
-                    state = StartState;
-                } else {
-                    ++i;
+        } else if (ch == QLatin1Char('/') && i + 1 < to && data[i + 1] == QLatin1Char('/') && language.comments()) {
+            i = to;
+            appendSpan(spans, start, to - start, Comment);
+            appendLiteral(blockData, start, to - start, Comment);
+        } else if ((chClass & DirectiveChar) && wasLineStart) {
+            i = to;
+            appendSpan(spans, start, to - start, Keyword);
+            appendLiteral(blockData, start, to - start, Keyword);
+        } else {
+            if (!(chClass & BracketChar))
+                appendSpan(spans, start, 1, Operator);
+            if (blockData) {
+                if (chClass & PunctuationChar)
+                    blockData->tokens += Token { i, 1, ch, Token::NoKeyword, false };
+                if (ch == QLatin1Char('{')) {
+                    bracketLevel++;
+                    blockData->brackets += Bracket { i, bracketLevel, true };
+                } else if (ch == QLatin1Char('}')) {
+                    blockData->brackets += Bracket { i, bracketLevel, false };
+                    bracketLevel--;
+                    blockData->minDepth = qMin(blockData->minDepth, bracketLevel);
                 }
-            } else {
-                ++i;
             }
-            break;
+            if (ch == QLatin1Char(':') && wasAfterProperty)
+                inBinding = true;
+            else if (ch == QLatin1Char(';') || ch == QLatin1Char('{') || ch == QLatin1Char('}'))
+                inBinding = false;
+            last = ch;
+            ++i;
+        }
+    }
 
-        case CommentState:
-            if (ch == '*' && next == '/') {
-                ++i;
-                ++i;
-                setFormat(start, i - start, m_colors[Comment]);
-                state = StartState;
-            } else {
-                ++i;
-            }
-            break;
+    if (state == CommentState) {
+        appendSpan(spans, start, to - start, Comment);
+        appendLiteral(blockData, start, to - start, Comment);
+        return CommentState;
+    }
 
-        default:
-            state = StartState;
-            break;
+    // a binding whose value goes on in the next block
+    if (inBinding && (last == QLatin1Char(':') || last == QLatin1Char('+')))
+        return BindingState;
+
+    return StartState;
+}
+
+// Takes the block's lexer results from m_cachedBlocks if its entry was
+// made for the same text and the same incoming state
+bool QMLHighlighter::applyCachedBlock(quint64 textHash, BlockData *blockData)
+{
+    const int number = currentBlock().blockNumber();
+    if (number >= m_cachedBlocks.count())
+        return false;
+
+    const HighlightCache::Block &cached = m_cachedBlocks.at(number);
+    if (cached.previousState != previousBlockState() || cached.textHash != textHash)
+        return false;
+
+    blockData->depthBefore = cached.depthBefore;
+    blockData->minDepth = cached.minDepth;
+    blockData->brackets = cached.brackets;
+    blockData->tokens = cached.tokens;
+    blockData->spans = cached.spans;
+    blockData->literals = cached.literals;
+    blockData->foldOffset = cached.foldOffset;
+    blockData->endsInComment = cached.endsInComment;
+
+    applySpans(cached.spans);
+
+    setCurrentBlockState(cached.state);
+    return true;
+}
+
+void QMLHighlighter::applySpans(const QVector<FormatSpan> &spans)
+{
+    foreach (const FormatSpan &span, spans)
+        setFormat(span.start, span.length, m_colors[ColorComponent(span.component)]);
+}
+
+// Formats laid over the lexer's colours
+void QMLHighlighter::decorate(const QString &text, const BlockData *blockData)
+{
+    // squiggles under the words compile errors were reported at
+    foreach (int column, blockData->errorColumns) {
+        if (column >= text.length())
+            column = qMax(0, text.length() - 1);
+        int end = column + 1;
+        while (end < text.length() && (text.at(end).isLetterOrNumber() || text.at(end) == '_'))
+            ++end;
+        for (int i = column; i < end; ++i) {
+            QTextCharFormat errorFormat = format(i);
+            errorFormat.setUnderlineStyle(QTextCharFormat::WaveUnderline);
+            errorFormat.setUnderlineColor(m_colors[Error]);
+            setFormat(i, 1, errorFormat);
         }
     }
 
-    if (state == CommentState)
-        setFormat(start, text.length(), m_colors[Comment]);
-    else
-        state = StartState;
-
     if (!m_markString.isEmpty()) {
         int pos = 0;
         int len = m_markString.length();
@@ -181,9 +424,6 @@ void QMLHighlighter::highlightBlock(const QString &text)
             ++pos;
         }
     }
-
-    blockState = (state & 15) | (bracketLevel << 4);
-    setCurrentBlockState(blockState);
 }
 
 void QMLHighlighter::mark(const QString &str, Qt::CaseSensitivity caseSensitivity)
@@ -193,15 +433,6 @@ void QMLHighlighter::mark(const QString &str, Qt::CaseSensitivity caseSensitivit
     rehighlight();
 }
 
-void QMLHighlighter::loadDictionary(QString filepath, QSet<QString> &dictionary) {
-    QFile file(filepath);
-    file.open(QIODevice::ReadOnly | QIODevice::Text);
-    QTextStream textStream(&file);
-    while (!textStream.atEnd()) {
-        dictionary<<textStream.readLine().trimmed();
-    }
-}
-
 void QMLHighlighter::addQmlComponent(QString componentName)
 {
     m_qmlIds<<componentName;
@@ -211,3 +442,84 @@ void QMLHighlighter::addJsComponent(QString componentName)
 {
     m_jsIds<<componentName;
 }
+
+const BracketIndex &QMLHighlighter::brackets() const
+{
+    return m_brackets;
+}
+
+void QMLHighlighter::setLanguage(const Language &language)
+{
+    if (m_language == &language)
+        return;
+
+    // every block gets other tokens on the next rehighlight
+    m_language = &language;
+    if (document()) {
+        noteTokenChange(document()->firstBlock());
+        noteTokenChange(document()->lastBlock());
+    }
+}
+
+const Language &QMLHighlighter::language() const
+{
+    return *m_language;
+}
+
+void QMLHighlighter::setCachedBlocks(const QVector<HighlightCache::Block> &blocks)
+{
+    m_cachedBlocks = blocks;
+}
+
+quint64 QMLHighlighter::cacheSeed() const
+{
+    QStringList qmlIds = m_qmlIds.values();
+    QStringList jsIds = m_jsIds.values();
+    std::sort(qmlIds.begin(), qmlIds.end());
+    std::sort(jsIds.begin(), jsIds.end());
+
+    // bump along with changes to the lexer or the dictionaries
+    static const quint64 LexerVersion = 2;
+    quint64 seed = HighlightCache::hash(QString::fromLatin1(m_language->name()), LexerVersion);
+    seed = HighlightCache::hash(qmlIds.join('\n'), seed);
+    return HighlightCache::hash(jsIds.join('\n'), seed);
+}
+
+bool QMLHighlighter::takeTokenChanges(int &from, int &to)
+{
+    if (!m_tokensChanged)
+        return false;
+
+    from = m_tokenChangeStart.position();
+    to = m_tokenChangeEnd.position();
+    m_tokensChanged = false;
+    return true;
+}
+
+void QMLHighlighter::noteTokenChange(const QTextBlock &block)
+{
+    const int start = block.position();
+    const int end = start + block.length() - 1;
+    if (m_tokenChangeStart.document() != document()) {
+        m_tokenChangeStart = QTextCursor(document());
+        m_tokenChangeEnd = QTextCursor(document());
+    }
+
+    if (m_tokensChanged) {
+        m_tokenChangeStart.setPosition(qMin(start, m_tokenChangeStart.position()));
+        m_tokenChangeEnd.setPosition(qMax(end, m_tokenChangeEnd.position()));
+    } else {
+        m_tokenChangeStart.setPosition(start);
+        m_tokenChangeEnd.setPosition(end);
+        m_tokensChanged = true;
+    }
+}
+
+bool QMLHighlighter::endsInLiteral(int blockState)
+{
+    if (blockState < 0)
+        return false;
+
+    const int state = blockState & StateMask;
+    return state == CommentState || state == EmbeddedState;
+}
@@ -20,7 +20,11 @@
 #define QMLHIGHLIGHTER_H
 
 #include <QSyntaxHighlighter>
+#include <QTextCursor>
 #include <QTextStream>
+#include "BracketIndex.h"
+#include "HighlightCache.h"
+#include "Language.h"
 
 class QMLHighlighter : public QSyntaxHighlighter
 {
@@ -37,29 +41,62 @@ public:
         BuiltIn,
         Marker,
         Item,
-        Property
+        Property,
+        Error
     };
 
     QMLHighlighter(QTextDocument *parent = 0);
     void setColor(ColorComponent component, const QColor &color);
+    QColor color(ColorComponent component) const;
     void mark(const QString &str, Qt::CaseSensitivity caseSensitivity);
     void addQmlComponent(QString componentName);
     void addJsComponent(QString componentName);
+    const BracketIndex &brackets() const;
+
+    // takes effect on the next rehighlight
+    void setLanguage(const Language &language);
+    const Language &language() const;
+
+    // Lexer results of the text about to be highlighted, blocks whose text
+    // and incoming state still match their entry skip the lexing. Only
+    // meant to be set around a load, everything else rehighlights too
+    // little to be worth the validation.
+    void setCachedBlocks(const QVector<HighlightCache::Block> &blocks);
+    // what the colours depend on besides the text
+    quint64 cacheSeed() const;
+
+    // a block ending in blockState leaves a comment or an embedded string open
+    static bool endsInLiteral(int blockState);
+
+    // Range of the blocks whose tokens may have changed since the last
+    // call, false if none did. Rehighlighting that only changes formats
+    // (marks, error squiggles) leaves it empty. For one reader, the
+    // document's OutlineModel.
+    bool takeTokenChanges(int &from, int &to);
 
 protected:
     void highlightBlock(const QString &text);
 
 private:
-    void loadDictionary(QString filepath, QSet<QString> &dictionary);
-    static bool m_cacheLoaded;
-    static QSet<QString> m_keywordsCache;
-    static QSet<QString> m_jsIdsCache;
-    static QSet<QString> m_qmlIdsCache;
-    static QSet<QString> m_propertiesCache;
+    int lex(const Language &language, const QString &text, int from, int to, int state,
+            QVector<FormatSpan> &spans, BlockData *blockData, int &bracketLevel);
+    bool applyCachedBlock(quint64 textHash, BlockData *blockData);
+    void applySpans(const QVector<FormatSpan> &spans);
+    void decorate(const QString &text, const BlockData *blockData);
+    void noteTokenChange(const QTextBlock &block);
 
     QSet<QString> m_jsIds;
     QSet<QString> m_qmlIds;
 
+    const Language *m_language;
+    BracketIndex m_brackets;
+    QVector<HighlightCache::Block> m_cachedBlocks;
+
+    int m_blockCount;
+    bool m_tokensChanged;
+    QTextCursor m_tokenChangeStart;
+    QTextCursor m_tokenChangeEnd;
+
     QHash<ColorComponent, QColor> m_colors;
     QString m_markString;
     Qt::CaseSensitivity m_markCaseSensitivity;
@@ -0,0 +1,55 @@
+#include "StartupTimeline.h"
+
+#include <QDebug>
+
+StartupTimeline::StartupTimeline(QObject *parent) :
+    QObject(parent),
+    m_lastMark(0),
+    m_firstFrameShown(false)
+{
+    m_timer.start();
+}
+
+StartupTimeline *StartupTimeline::instance()
+{
+    static StartupTimeline timeline;
+    return &timeline;
+}
+
+void StartupTimeline::mark(const QString &label)
+{
+    const qint64 now = m_timer.elapsed();
+    qInfo().noquote() << QString("Startup +%1 ms (%2 ms): %3")
+                         .arg(now, 5)
+                         .arg(now - m_lastMark, 4)
+                         .arg(label);
+    m_lastMark = now;
+}
+
+qint64 StartupTimeline::elapsed() const
+{
+    return m_timer.elapsed();
+}
+
+void StartupTimeline::watchFirstFrame(QQuickWindow *window)
+{
+    if (!window || m_firstFrameShown)
+        return;
+
+    // frameSwapped is emitted on the render thread, the context object
+    // makes sure the handler runs queued on the GUI thread
+    m_frameConnection = QObject::connect(window, &QQuickWindow::frameSwapped, this, [this]() {
+        if (m_firstFrameShown)
+            return;
+
+        QObject::disconnect(m_frameConnection);
+        m_firstFrameShown = true;
+        mark("first frame swapped");
+        emit firstFrameSwapped();
+    }, Qt::QueuedConnection);
+}
+
+bool StartupTimeline::firstFrameShown() const
+{
+    return m_firstFrameShown;
+}
@@ -0,0 +1,36 @@
+#ifndef STARTUPTIMELINE_H
+#define STARTUPTIMELINE_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QQuickWindow>
+
+class StartupTimeline : public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY(bool firstFrameShown READ firstFrameShown NOTIFY firstFrameSwapped)
+
+public:
+    explicit StartupTimeline(QObject *parent = nullptr);
+
+    static StartupTimeline *instance();
+
+    // logs "+<ms> ms <label>" relative to process start
+    Q_INVOKABLE void mark(const QString &label);
+    Q_INVOKABLE qint64 elapsed() const;
+
+    void watchFirstFrame(QQuickWindow *window);
+    bool firstFrameShown() const;
+
+private:
+    QElapsedTimer m_timer;
+    qint64 m_lastMark;
+    bool m_firstFrameShown;
+    QMetaObject::Connection m_frameConnection;
+
+signals:
+    void firstFrameSwapped();
+};
+
+#endif // STARTUPTIMELINE_H
@@ -0,0 +1,153 @@
+#include "SuspendController.h"
+
+#include <QMetaProperty>
+#include <QSet>
+
+// a writable bool property, invalid when there is none
+static QMetaProperty boolProperty(const QObject *object, const char *name)
+{
+    const QMetaObject *metaObject = object->metaObject();
+    const int index = metaObject->indexOfProperty(name);
+    if (index < 0)
+        return QMetaProperty();
+
+    const QMetaProperty property = metaObject->property(index);
+    if (property.userType() != QMetaType::Bool || !property.isWritable())
+        return QMetaProperty();
+    return property;
+}
+
+SuspendController::SuspendController(QObject *parent) :
+    QObject(parent),
+    m_suspended(false)
+{
+
+}
+
+SuspendController::~SuspendController()
+{
+    resumeAll();
+}
+
+QQuickItem *SuspendController::target() const
+{
+    return m_target;
+}
+
+void SuspendController::setTarget(QQuickItem *target)
+{
+    if (m_target == target)
+        return;
+
+    resumeAll();
+    m_target = target;
+    if (m_suspended)
+        suspendAll();
+
+    emit targetChanged();
+}
+
+bool SuspendController::suspended() const
+{
+    return m_suspended;
+}
+
+void SuspendController::setSuspended(bool suspended)
+{
+    if (m_suspended == suspended)
+        return;
+
+    m_suspended = suspended;
+    if (m_suspended)
+        suspendAll();
+    else
+        resumeAll();
+
+    emit suspendedChanged();
+}
+
+int SuspendController::count() const
+{
+    return m_held.count();
+}
+
+void SuspendController::refresh()
+{
+    if (m_suspended)
+        suspendAll();
+}
+
+void SuspendController::suspend(QObject *object)
+{
+    // Animation, ParticleSystem, AnimatedImage and AnimatedSprite can be
+    // paused and pick up where they were, pausing a stopped one warns
+    const QMetaProperty paused = boolProperty(object, "paused");
+    if (paused.isValid())
+    {
+        const QMetaProperty running = boolProperty(object, "running");
+        const QMetaProperty playing = boolProperty(object, "playing");
+        const bool active = running.isValid() ? running.read(object).toBool() :
+                            playing.isValid() ? playing.read(object).toBool() : true;
+        if (active && !paused.read(object).toBool() && paused.write(object, true))
+            m_held += Held { object, Paused };
+        return;
+    }
+
+    // Timer and SpriteSequence only start over
+    const QMetaProperty running = boolProperty(object, "running");
+    if (running.isValid() && running.read(object).toBool() && running.write(object, false))
+        m_held += Held { object, Stopped };
+}
+
+void SuspendController::suspendAll()
+{
+    if (!m_target)
+        return;
+
+    const int held = m_held.count();
+
+    // items created by a Repeater or a Loader are not always QObject
+    // children of the item they are shown in, walk both trees
+    QSet<QObject *> seen;
+    QVector<QObject *> objects { m_target };
+    while (!objects.isEmpty())
+    {
+        QObject *object = objects.takeLast();
+        if (seen.contains(object))
+            continue;
+        seen.insert(object);
+
+        suspend(object);
+        for (QObject *child : object->children())
+            objects += child;
+        if (QQuickItem *item = qobject_cast<QQuickItem *>(object))
+        {
+            for (QQuickItem *child : item->childItems())
+                objects += child;
+        }
+    }
+
+    if (m_held.count() != held)
+        emit countChanged();
+}
+
+void SuspendController::resumeAll()
+{
+    if (m_held.isEmpty())
+        return;
+
+    for (const Held &held : m_held)
+    {
+        QObject *object = held.object;
+        if (!object)
+            continue;
+
+        if (held.hold == Paused)
+            object->setProperty("paused", false);
+        else
+            object->setProperty("running", true);
+    }
+
+    m_held.clear();
+    emit countChanged();
+}
@@ -0,0 +1,62 @@
+#ifndef SUSPENDCONTROLLER_H
+#define SUSPENDCONTROLLER_H
+
+#include <QObject>
+#include <QPointer>
+#include <QQuickItem>
+#include <QVector>
+
+// Stops what keeps the objects below target busy while nobody can see
+// them: running animations, particle systems and animated images are
+// paused, timers and sprites are stopped. Resuming restarts exactly what
+// was suspended, so an example that stopped a timer itself in the
+// meantime keeps it stopped. Objects created while suspended are caught
+// by refresh().
+class SuspendController : public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY(QQuickItem* target READ target WRITE setTarget NOTIFY targetChanged)
+    Q_PROPERTY(bool suspended READ suspended WRITE setSuspended NOTIFY suspendedChanged)
+    // objects currently held
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+public:
+    explicit SuspendController(QObject *parent = nullptr);
+    ~SuspendController();
+
+    QQuickItem *target() const;
+    void setTarget(QQuickItem *target);
+
+    bool suspended() const;
+    void setSuspended(bool suspended);
+
+    int count() const;
+
+    // suspends what started since, while suspended
+    Q_INVOKABLE void refresh();
+
+private:
+    enum Hold { Paused, Stopped };
+
+    struct Held
+    {
+        QPointer<QObject> object;
+        Hold hold;
+    };
+
+    void suspend(QObject *object);
+    void suspendAll();
+    void resumeAll();
+
+    QPointer<QQuickItem> m_target;
+    bool m_suspended;
+    QVector<Held> m_held;
+
+signals:
+    void targetChanged();
+    void suspendedChanged();
+    void countChanged();
+};
+
+#endif // SUSPENDCONTROLLER_H
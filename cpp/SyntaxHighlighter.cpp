@@ -17,6 +17,9 @@
 ****************************************************************************/
 
 #include "SyntaxHighlighter.h"
+#include "HighlightCache.h"
+
+#include <QtConcurrent>
 
 SyntaxHighlighter::SyntaxHighlighter(QObject *parent) :
     QObject(parent),
@@ -30,6 +33,7 @@ void SyntaxHighlighter::setHighlighter(QObject *textArea)
     QQuickTextDocument *quickTextDocument = qvariant_cast<QQuickTextDocument*>(textArea->property("textDocument"));
     QTextDocument *document = quickTextDocument->textDocument();
     m_highlighter = new QMLHighlighter(document);
+    m_highlighter->setLanguage(Language::forFileFormat(m_fileFormat));
 
     m_highlighter->setColor(QMLHighlighter::Normal, m_normalColor);
     m_highlighter->setColor(QMLHighlighter::Comment, m_commentColor);
@@ -41,8 +45,10 @@ void SyntaxHighlighter::setHighlighter(QObject *textArea)
     m_highlighter->setColor(QMLHighlighter::Marker, m_markerColor);
     m_highlighter->setColor(QMLHighlighter::Item, m_itemColor);
     m_highlighter->setColor(QMLHighlighter::Property, m_propertyColor);
+    m_highlighter->setColor(QMLHighlighter::Error, m_errorColor);
 
     m_highlighter->rehighlight();
+    emit highlighterChanged();
 }
 
 void SyntaxHighlighter::rehighlight() {
@@ -62,6 +68,118 @@ void SyntaxHighlighter::addJsComponent(QString componentName)
         m_highlighter->addJsComponent(componentName);
 }
 
+QMLHighlighter *SyntaxHighlighter::highlighter() const
+{
+    return m_highlighter;
+}
+
+QString SyntaxHighlighter::fileFormat() const
+{
+    return m_fileFormat;
+}
+
+void SyntaxHighlighter::setFileFormat(const QString &fileFormat)
+{
+    if (m_fileFormat == fileFormat)
+        return;
+
+    m_fileFormat = fileFormat;
+    if (m_highlighter)
+    {
+        const Language &language = Language::forFileFormat(m_fileFormat);
+        if (&language != &m_highlighter->language())
+        {
+            m_highlighter->setLanguage(language);
+            m_highlighter->rehighlight();
+        }
+    }
+
+    emit fileFormatChanged();
+}
+
+TextBuffer *SyntaxHighlighter::buffer() const
+{
+    return m_buffer;
+}
+
+void SyntaxHighlighter::setBuffer(TextBuffer *buffer)
+{
+    if (m_buffer == buffer)
+        return;
+
+    if (m_buffer)
+        QObject::disconnect(m_buffer, nullptr, this, nullptr);
+
+    m_buffer = buffer;
+    if (m_buffer)
+    {
+        QObject::connect(m_buffer, &TextBuffer::loadingChanged, this, &SyntaxHighlighter::onLoadingChanged);
+        QObject::connect(m_buffer, &TextBuffer::saved, this, &SyntaxHighlighter::onSaved);
+    }
+
+    emit bufferChanged();
+}
+
+// The buffer already holds the new text when loading starts, so a cache
+// entry for it can be handed to the highlighter before the document is
+// filled. Files that had none get one once they are highlighted.
+void SyntaxHighlighter::onLoadingChanged()
+{
+    if (!m_highlighter)
+        return;
+
+    if (m_buffer->loading())
+    {
+        m_cacheKey = HighlightCache::hash(m_buffer->text(), m_highlighter->cacheSeed());
+        const QVector<HighlightCache::Block> blocks = HighlightCache::load(m_cacheKey);
+        m_cacheHit = !blocks.isEmpty();
+        m_highlighter->setCachedBlocks(blocks);
+    }
+    else
+    {
+        m_highlighter->setCachedBlocks(QVector<HighlightCache::Block>());
+        if (!m_cacheHit)
+            storeCache(m_cacheKey);
+    }
+}
+
+void SyntaxHighlighter::onSaved()
+{
+    if (!m_highlighter)
+        return;
+
+    const quint64 key = HighlightCache::hash(m_buffer->text(), m_highlighter->cacheSeed());
+    if (!HighlightCache::contains(key))
+        storeCache(key);
+}
+
+void SyntaxHighlighter::storeCache(quint64 key)
+{
+    const QByteArray data = HighlightCache::serialize(m_highlighter->document());
+    if (data.isEmpty())
+        return;
+
+    // compressing and writing stays off the GUI thread
+    QtConcurrent::run([key, data]() {
+        HighlightCache::store(key, data);
+    });
+}
+
+int SyntaxHighlighter::bracketDepth(int position) const
+{
+    return m_highlighter ? m_highlighter->brackets().depthAt(position) : 0;
+}
+
+int SyntaxHighlighter::matchingBracket(int position) const
+{
+    return m_highlighter ? m_highlighter->brackets().matchingBracket(position) : -1;
+}
+
+int SyntaxHighlighter::enclosingBlockStart(int position) const
+{
+    return m_highlighter ? m_highlighter->brackets().enclosingBlockStart(position) : -1;
+}
+
 QColor SyntaxHighlighter::normalColor()
 {
     return m_normalColor;
@@ -112,6 +230,11 @@ QColor SyntaxHighlighter::propertyColor()
     return m_propertyColor;
 }
 
+QColor SyntaxHighlighter::errorColor()
+{
+    return m_errorColor;
+}
+
 void SyntaxHighlighter::setNormalColor(QColor color)
 {
     if (m_normalColor != color)
@@ -241,3 +364,16 @@ void SyntaxHighlighter::setPropertyColor(QColor color)
         emit propertyColorChanged();
     }
 }
+
+void SyntaxHighlighter::setErrorColor(QColor color)
+{
+    if (m_errorColor != color)
+    {
+        m_errorColor = color;
+
+        if (m_highlighter)
+            m_highlighter->setColor(QMLHighlighter::Error, m_errorColor);
+
+        emit errorColorChanged();
+    }
+}
@@ -22,6 +22,7 @@
 #include <QObject>
 #include <QQuickTextDocument>
 #include "QMLHighlighter.h"
+#include "TextBuffer.h"
 
 class SyntaxHighlighter : public QObject
 {
@@ -37,6 +38,11 @@ class SyntaxHighlighter : public QObject
     Q_PROPERTY(QColor markerColor    MEMBER m_markerColor    READ markerColor    WRITE setMarkerColor    NOTIFY markerColorChanged)
     Q_PROPERTY(QColor itemColor      MEMBER m_itemColor      READ itemColor      WRITE setItemColor      NOTIFY itemColorChanged)
     Q_PROPERTY(QColor propertyColor  MEMBER m_propertyColor  READ propertyColor  WRITE setPropertyColor  NOTIFY propertyColorChanged)
+    Q_PROPERTY(QColor errorColor     MEMBER m_errorColor     READ errorColor     WRITE setErrorColor     NOTIFY errorColorChanged)
+    // suffix of the edited file, picks the language (see Language::forFileFormat)
+    Q_PROPERTY(QString fileFormat READ fileFormat WRITE setFileFormat NOTIFY fileFormatChanged)
+    // loads go through the highlight cache, saves refresh it
+    Q_PROPERTY(TextBuffer* buffer READ buffer WRITE setBuffer NOTIFY bufferChanged)
 
 public:
     explicit SyntaxHighlighter(QObject *parent = 0);
@@ -45,6 +51,19 @@ public:
     Q_INVOKABLE void addQmlComponent(QString componentName);
     Q_INVOKABLE void addJsComponent(QString componentName);
 
+    // bracket index queries, all positions are document positions
+    Q_INVOKABLE int bracketDepth(int position) const;
+    Q_INVOKABLE int matchingBracket(int position) const;
+    Q_INVOKABLE int enclosingBlockStart(int position) const;
+
+    QMLHighlighter *highlighter() const;
+
+    QString fileFormat() const;
+    void setFileFormat(const QString &fileFormat);
+
+    TextBuffer *buffer() const;
+    void setBuffer(TextBuffer *buffer);
+
     QColor normalColor();
     QColor commentColor();
     QColor numberColor();
@@ -55,6 +74,7 @@ public:
     QColor markerColor();
     QColor itemColor();
     QColor propertyColor();
+    QColor errorColor();
 
     void setNormalColor(QColor color);
     void setCommentColor(QColor color);
@@ -66,9 +86,20 @@ public:
     void setMarkerColor(QColor color);
     void setItemColor(QColor color);
     void setPropertyColor(QColor color);
+    void setErrorColor(QColor color);
+
+private slots:
+    void onLoadingChanged();
+    void onSaved();
 
 private:
+    void storeCache(quint64 key);
+
     QMLHighlighter *m_highlighter;
+    QString m_fileFormat = QStringLiteral("qml");
+    TextBuffer *m_buffer = nullptr;
+    quint64 m_cacheKey = 0;
+    bool m_cacheHit = false;
 
     QColor m_normalColor;
     QColor m_commentColor;
@@ -80,6 +111,7 @@ private:
     QColor m_markerColor;
     QColor m_itemColor;
     QColor m_propertyColor;
+    QColor m_errorColor;
 
 signals:
     void normalColorChanged();
@@ -92,6 +124,10 @@ signals:
     void markerColorChanged();
     void itemColorChanged();
     void propertyColorChanged();
+    void errorColorChanged();
+    void highlighterChanged();
+    void fileFormatChanged();
+    void bufferChanged();
 };
 
 
@@ -0,0 +1,285 @@
+#include "TextBuffer.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QTextCursor>
+#include <QTextDocument>
+#include <QTextStream>
+
+// Chunk size used to feed a freshly loaded file into the document
+static const int LoadChunkSize = 64 * 1024;
+
+TextBuffer::TextBuffer(QObject *parent) : QObject(parent),
+    m_history(new EditHistory(this))
+{
+
+}
+
+QObject *TextBuffer::document()
+{
+    return m_document;
+}
+
+void TextBuffer::setDocument(QObject *p)
+{
+    QQuickTextDocument *pointer = qobject_cast<QQuickTextDocument*>(p);
+
+    if (!pointer) {
+        qWarning() << "Provided pointer is not of type QQuickTextDocument";
+        return;
+    }
+
+    if (m_document == pointer)
+        return;
+
+    if (m_document) {
+        QObject::disconnect(m_document->textDocument(), &QTextDocument::contentsChange,
+                            this, &TextBuffer::onContentsChange);
+    }
+
+    m_document = pointer;
+    // EditHistory replaces the document's own undo stack
+    m_document->textDocument()->setUndoRedoEnabled(false);
+    QObject::connect(m_document->textDocument(), &QTextDocument::contentsChange,
+                     this, &TextBuffer::onContentsChange);
+    resync();
+    emit documentChanged();
+}
+
+QTextDocument *TextBuffer::textDocument() const
+{
+    return m_document ? m_document->textDocument() : nullptr;
+}
+
+bool TextBuffer::load(const QString &filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        qWarning() << "Unable to open" << filePath;
+        return false;
+    }
+
+    QTextStream textStream(&file);
+    replaceContent(textStream.readAll().trimmed());
+
+    if (m_history->persistent())
+        m_history->restore(filePath);
+
+    setLastEdit(0, 0, m_table.length());
+    return true;
+}
+
+void TextBuffer::loadText(const QString &text, QDataStream *history)
+{
+    replaceContent(text);
+
+    if (history)
+        m_history->read(*history);
+
+    setLastEdit(0, 0, m_table.length());
+}
+
+void TextBuffer::replaceContent(const QString &text)
+{
+    m_table.reset(text);
+
+    QTextDocument *document = textDocument();
+    if (document)
+    {
+        // Feed the document straight from the buffer, without undo history
+        // and without a round trip of the whole text through QML
+        m_loading = true;
+        emit loadingChanged();
+
+        QTextCursor cursor(document);
+        cursor.beginEditBlock();
+        cursor.select(QTextCursor::Document);
+        cursor.removeSelectedText();
+        m_table.forEachChunk(0, m_table.length(), [&cursor](const QChar *chunk, int length) {
+            for (int offset = 0; offset < length; offset += LoadChunkSize)
+                cursor.insertText(QString::fromRawData(chunk + offset, qMin(LoadChunkSize, length - offset)));
+            return true;
+        });
+        cursor.endEditBlock();
+
+        m_loading = false;
+        emit loadingChanged();
+    }
+
+    m_history->clear();
+}
+
+bool TextBuffer::save(const QString &filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        qWarning() << "Unable to write" << filePath;
+        return false;
+    }
+
+    QTextStream textStream(&file);
+    m_table.forEachChunk(0, m_table.length(), [&textStream](const QChar *chunk, int length) {
+        textStream << QString::fromRawData(chunk, length);
+        return true;
+    });
+    textStream.flush();
+
+    if (textStream.status() != QTextStream::Ok)
+        return false;
+
+    if (m_history->persistent())
+        m_history->save(filePath);
+
+    emit saved();
+    return true;
+}
+
+QString TextBuffer::textRange(int start, int end) const
+{
+    return m_table.text(start, end - start);
+}
+
+QString TextBuffer::charAt(int position) const
+{
+    if (position < 0 || position >= m_table.length())
+        return QString();
+
+    return QString(m_table.at(position));
+}
+
+int TextBuffer::lineBreakBefore(int position) const
+{
+    for (int i = qMin(position, m_table.length()) - 1; i >= 0; i--)
+    {
+        const QChar ch = m_table.at(i);
+        if (ch != ' ')
+            return (ch == '\n') ? i : -1;
+    }
+
+    return -1;
+}
+
+QString TextBuffer::text() const
+{
+    return m_table.toString();
+}
+
+const PieceTable &TextBuffer::pieces() const
+{
+    return m_table;
+}
+
+EditHistory *TextBuffer::history() const
+{
+    return m_history;
+}
+
+bool TextBuffer::loading() const
+{
+    return m_loading;
+}
+
+int TextBuffer::length() const
+{
+    return m_table.length();
+}
+
+int TextBuffer::revision() const
+{
+    return m_revision;
+}
+
+int TextBuffer::lastEditPosition() const
+{
+    return m_lastEditPosition;
+}
+
+int TextBuffer::lastCharsRemoved() const
+{
+    return m_lastCharsRemoved;
+}
+
+int TextBuffer::lastCharsAdded() const
+{
+    return m_lastCharsAdded;
+}
+
+void TextBuffer::onContentsChange(int position, int charsRemoved, int charsAdded)
+{
+    if (m_loading)
+        return;
+
+    QTextDocument *document = textDocument();
+    const int documentLength = document->characterCount() - 1;
+
+    // The reported ranges may include the document's final paragraph
+    // separator, which is not part of the plain text
+    charsRemoved = qMin(charsRemoved, m_table.length() - position);
+    charsAdded = qMin(charsAdded, documentLength - position);
+    if (position < 0 || charsRemoved < 0 || charsAdded < 0)
+    {
+        resync();
+        return;
+    }
+
+    const QString added = documentText(position, charsAdded);
+    const QString removed = m_table.text(position, charsRemoved);
+
+    // Format-only changes report the same range as removed and added
+    if (charsRemoved == charsAdded && removed == added)
+        return;
+
+    m_table.remove(position, charsRemoved);
+    m_table.insert(position, added);
+
+    if (m_table.length() != documentLength)
+    {
+        qWarning() << "Text buffer out of sync, reloading it from the document";
+        m_history->clear();
+        resync();
+        return;
+    }
+
+    m_history->record(position, removed, added);
+    setLastEdit(position, charsRemoved, charsAdded);
+}
+
+QString TextBuffer::documentText(int position, int count) const
+{
+    if (count <= 0)
+        return QString();
+
+    QTextCursor cursor(textDocument());
+    cursor.setPosition(position);
+    cursor.setPosition(position + count, QTextCursor::KeepAnchor);
+
+    // same conversions QTextDocument::toPlainText() does
+    QString text = cursor.selectedText();
+    QChar *data = text.data();
+    for (int i = 0; i < text.length(); i++) {
+        const ushort ch = data[i].unicode();
+        if (ch == QChar::ParagraphSeparator || ch == QChar::LineSeparator)
+            data[i] = '\n';
+        else if (ch == QChar::Nbsp)
+            data[i] = ' ';
+    }
+    return text;
+}
+
+void TextBuffer::resync()
+{
+    QTextDocument *document = textDocument();
+    m_table.reset(document ? document->toPlainText() : QString());
+    setLastEdit(0, 0, m_table.length());
+}
+
+void TextBuffer::setLastEdit(int position, int charsRemoved, int charsAdded)
+{
+    m_lastEditPosition = position;
+    m_lastCharsRemoved = charsRemoved;
+    m_lastCharsAdded = charsAdded;
+    m_revision++;
+    emit contentsEdited(position, charsRemoved, charsAdded);
+}
@@ -0,0 +1,82 @@
+#ifndef TEXTBUFFER_H
+#define TEXTBUFFER_H
+
+#include <QObject>
+#include <QQuickTextDocument>
+#include "PieceTable.h"
+#include "EditHistory.h"
+
+// Piece table mirror of an editor document. It is kept in sync from the
+// document's contentsChange, so reading and saving the content never
+// needs a full QString copy of the TextEdit text.
+class TextBuffer : public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY(QObject* document READ document WRITE setDocument NOTIFY documentChanged)
+    Q_PROPERTY(bool loading READ loading NOTIFY loadingChanged)
+    Q_PROPERTY(int length READ length NOTIFY contentsEdited)
+    Q_PROPERTY(int revision READ revision NOTIFY contentsEdited)
+    Q_PROPERTY(int lastEditPosition READ lastEditPosition NOTIFY contentsEdited)
+    Q_PROPERTY(int lastCharsRemoved READ lastCharsRemoved NOTIFY contentsEdited)
+    Q_PROPERTY(int lastCharsAdded READ lastCharsAdded NOTIFY contentsEdited)
+    Q_PROPERTY(EditHistory* history READ history CONSTANT)
+
+public:
+    explicit TextBuffer(QObject *parent = nullptr);
+
+    QObject *document();
+    void setDocument(QObject *p);
+    QTextDocument *textDocument() const;
+
+    Q_INVOKABLE bool load(const QString &filePath);
+    Q_INVOKABLE bool save(const QString &filePath);
+
+    Q_INVOKABLE QString textRange(int start, int end) const;
+    Q_INVOKABLE QString charAt(int position) const;
+    // position of the line break before position when only spaces are in
+    // between, -1 otherwise
+    Q_INVOKABLE int lineBreakBefore(int position) const;
+
+    // replaces the content without touching the disk, history is an
+    // EditHistory::write() stream to restore
+    void loadText(const QString &text, QDataStream *history = nullptr);
+
+    QString text() const;
+    const PieceTable &pieces() const;
+    EditHistory *history() const;
+
+    bool loading() const;
+    int length() const;
+    int revision() const;
+    int lastEditPosition() const;
+    int lastCharsRemoved() const;
+    int lastCharsAdded() const;
+
+private slots:
+    void onContentsChange(int position, int charsRemoved, int charsAdded);
+
+private:
+    QString documentText(int position, int count) const;
+    void replaceContent(const QString &text);
+    void resync();
+    void setLastEdit(int position, int charsRemoved, int charsAdded);
+
+    QQuickTextDocument *m_document = nullptr;
+    PieceTable m_table;
+    EditHistory *m_history;
+    bool m_loading = false;
+
+    int m_revision = 0;
+    int m_lastEditPosition = 0;
+    int m_lastCharsRemoved = 0;
+    int m_lastCharsAdded = 0;
+
+signals:
+    void documentChanged();
+    void loadingChanged();
+    void saved();
+    void contentsEdited(int position, int charsRemoved, int charsAdded);
+};
+
+#endif // TEXTBUFFER_H
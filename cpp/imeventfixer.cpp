@@ -1,6 +1,7 @@
 #include "imeventfixer.h"
 
 #include <QInputMethodQueryEvent>
+#include "LatencyTracer.h"
 
 ImEventFixer::ImEventFixer(QObject *parent) : QObject(parent)
 {
@@ -9,6 +10,10 @@ ImEventFixer::ImEventFixer(QObject *parent) : QObject(parent)
 
 bool ImEventFixer::eventFilter(QObject *obj, QEvent *event)
 {
+    // the editor sees every keystroke here first
+    if (event->type() == QEvent::KeyPress || event->type() == QEvent::InputMethod)
+        LatencyTracer::instance()->input(event);
+
     if (event->type() == QEvent::InputMethodQuery) {
         QInputMethodQueryEvent *imEvt = static_cast<QInputMethodQueryEvent *>(event);
         if (imEvt->queries() == Qt::InputMethodQuery::ImCursorRectangle) {
@@ -19,12 +19,29 @@
 #include <QGuiApplication>
 #include <QDateTime>
 #include <QDir>
+#include <QFile>
 #include <QQmlApplicationEngine>
+#include <QQuickWindow>
 #include <QTranslator>
 #include <QtGlobal>
+#include "CodeFolding.h"
+#include "CodeFormatter.h"
+#include "CodeView.h"
+#include "CompletionModel.h"
+#include "DiagnosticsModel.h"
+#include "DocumentManager.h"
+#include "LatencyTracer.h"
+#include "LineChanges.h"
+#include "MappedFile.h"
 #include "MessageHandler.h"
+#include "Minimap.h"
+#include "ModuleProbe.h"
+#include "OutlineModel.h"
 #include "ProjectManager.h"
+#include "StartupTimeline.h"
+#include "SuspendController.h"
 #include "SyntaxHighlighter.h"
+#include "TextBuffer.h"
 #include "components/linenumbershelper.h"
 #include "imfixerinstaller.h"
 
@@ -65,8 +82,50 @@ bool checkAndroidStoragePermissions() {
 
 #endif
 
+// The Qt Quick Compiler strips the app's QML sources from the resources,
+// so when they are missing the engine can only be running compiled units
+static QString qmlCompilationMode()
+{
+    const bool sourcesShipped = QFile::exists(QStringLiteral(":/qml/main.qml"));
+#ifdef QMLCREATOR_AOT
+    if (!sourcesShipped)
+        return QStringLiteral("compiled ahead of time");
+    return QStringLiteral("compiled at runtime (precompiled units not in use)");
+#else
+    Q_UNUSED(sourcesShipped)
+    if (qEnvironmentVariableIsSet("QML_DISABLE_DISK_CACHE"))
+        return QStringLiteral("compiled at runtime");
+    return QStringLiteral("compiled at runtime (disk cache)");
+#endif
+}
+
+// Registration only records type metadata, the instances (and the disk I/O
+// they do) are created lazily when QML first touches them.
+static void registerQmlTypes()
+{
+    qmlRegisterSingletonType<ProjectManager>("ProjectManager", 1, 1, "ProjectManager", &ProjectManager::projectManagerProvider);
+    qmlRegisterType<SyntaxHighlighter>("SyntaxHighlighter", 1, 1, "SyntaxHighlighter");
+    qmlRegisterType<LineNumbersHelper>("LineNumbersHelper", 1, 1, "LineNumbersHelper");
+    qmlRegisterType<CodeFolding>("CodeFolding", 1, 1, "CodeFolding");
+    qmlRegisterType<CodeFormatter>("CodeFormatter", 1, 1, "CodeFormatter");
+    qmlRegisterType<CodeView>("CodeView", 1, 1, "CodeView");
+    qmlRegisterType<CompletionModel>("CompletionModel", 1, 1, "CompletionModel");
+    qmlRegisterType<DiagnosticsModel>("DiagnosticsModel", 1, 1, "DiagnosticsModel");
+    qmlRegisterType<DocumentManager>("DocumentManager", 1, 1, "DocumentManager");
+    qmlRegisterType<LineChanges>("LineChanges", 1, 1, "LineChanges");
+    qmlRegisterType<MappedFile>("MappedFile", 1, 1, "MappedFile");
+    qmlRegisterType<Minimap>("Minimap", 1, 1, "Minimap");
+    qmlRegisterType<OutlineModel>("OutlineModel", 1, 1, "OutlineModel");
+    qmlRegisterType<ModuleProbe>("ModuleProbe", 1, 1, "ModuleProbe");
+    qmlRegisterType<SuspendController>("SuspendController", 1, 1, "SuspendController");
+    qmlRegisterType<TextBuffer>("TextBuffer", 1, 1, "TextBuffer");
+    qmlRegisterUncreatableType<EditHistory>("TextBuffer", 1, 1, "EditHistory", "EditHistory is owned by a TextBuffer");
+    qmlRegisterUncreatableType<LatencyTracer>("LatencyTracer", 1, 1, "LatencyTracer", "Use the latencyTracer context property");
+}
+
 int main(int argc, char *argv[])
 {
+    StartupTimeline *startupTimeline = StartupTimeline::instance();
     QGuiApplication::setAttribute(Qt::AA_EnableHighDpiScaling);
 
     qInstallMessageHandler(&MessageHandler::handler);
@@ -87,16 +146,14 @@ int main(int argc, char *argv[])
             QStandardPaths::writableLocation(QStandardPaths::CacheLocation) +
             QDir::separator();
 
-    createNecessaryDir(configPath);
-    createNecessaryDir(cachePath);
+    startupTimeline->mark("application created");
 
     QTranslator translator;
     translator.load("qmlcreator_" + QLocale::system().name(), ":/resources/translations");
     app.installTranslator(&translator);
 
-    qmlRegisterSingletonType<ProjectManager>("ProjectManager", 1, 1, "ProjectManager", &ProjectManager::projectManagerProvider);
-    qmlRegisterType<SyntaxHighlighter>("SyntaxHighlighter", 1, 1, "SyntaxHighlighter");
-    qmlRegisterType<LineNumbersHelper>("LineNumbersHelper", 1, 1, "LineNumbersHelper");
+    registerQmlTypes();
+    startupTimeline->mark("types registered");
 
 #ifdef Q_OS_ANDROID
     while(!checkAndroidStoragePermissions());
@@ -108,11 +165,13 @@ int main(int argc, char *argv[])
     }
 
     QQmlApplicationEngine engine;
+    startupTimeline->mark("engine created");
 
     const QString qtVersion = QT_VERSION_STR;
     const QString buildDateTime = QStringLiteral("%1 %2").arg(__DATE__, __TIME__);
     engine.rootContext()->setContextProperty("qtVersion", qtVersion);
     engine.rootContext()->setContextProperty("buildDateTime", buildDateTime);
+    engine.rootContext()->setContextProperty("qmlCompilationMode", qmlCompilationMode());
 
     engine.rootContext()->setContextProperty("configPath", configPath);
     engine.rootContext()->setContextProperty("cachePath", cachePath);
@@ -136,10 +195,27 @@ int main(int argc, char *argv[])
 #endif
 
     engine.rootContext()->setContextProperty("oskEventFixer", new ImFixerInstaller());
+    engine.rootContext()->setContextProperty("startupTimeline", startupTimeline);
+    engine.rootContext()->setContextProperty("latencyTracer", LatencyTracer::instance());
 
     engine.load(QUrl("qrc:/qml/main.qml"));
+    startupTimeline->mark("main.qml loaded");
 
     ProjectManager::setQmlEngine(&engine);
     MessageHandler::setQmlEngine(&engine);
+
+    // Nothing below is needed for the first frame, keep it off that path
+    QObject::connect(startupTimeline, &StartupTimeline::firstFrameSwapped, &app, [configPath, cachePath]() {
+        createNecessaryDir(configPath);
+        createNecessaryDir(cachePath);
+    });
+
+    if (!engine.rootObjects().isEmpty())
+    {
+        QQuickWindow *window = qobject_cast<QQuickWindow*>(engine.rootObjects().first());
+        startupTimeline->watchFirstFrame(window);
+        LatencyTracer::instance()->setWindow(window);
+    }
+
     return app.exec();
 }
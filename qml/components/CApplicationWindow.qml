@@ -37,8 +37,14 @@ ApplicationWindow {
     // Loading
     signal loaded()
 
-    Component.onCompleted:
-        loaded()
+    // First-run work (restoring the examples, version dialogs) waits until
+    // the first frame is on screen
+    Connections {
+        target: startupTimeline
+        function onFirstFrameSwapped() {
+            cApplicationWindow.loaded()
+        }
+    }
 
     onLoaded: {
         // http://doc.qt.io/qt-5/qml-qtquick-window-screen.html
@@ -47,8 +53,7 @@ ApplicationWindow {
 
         var previousVersion = parseInt(settings.previousVersion.split(".").join(""))
         if (previousVersion === 0)
-        { // first run
-            ProjectManager.restoreExamples()
+        { // first run, the examples open read-only from the resources until restored
             settings.previousVersion = Qt.application.version
         }
         else
@@ -87,6 +92,9 @@ ApplicationWindow {
         property string palette: "Cute"
         property int indentSize: 4
         property bool debugging: true
+        property bool persistentUndo: false
+        property bool latencyTracing: false
+        property int playgroundFrameRate: 0
 
         // internal
         property bool debugMode: false
@@ -105,6 +113,9 @@ ApplicationWindow {
         property alias palette: settings.palette
         property alias indentSize: settings.indentSize
         property alias debugging: settings.debugging
+        property alias persistentUndo: settings.persistentUndo
+        property alias latencyTracing: settings.latencyTracing
+        property alias playgroundFrameRate: settings.playgroundFrameRate
     }
 
     Settings {
@@ -114,6 +125,12 @@ ApplicationWindow {
 
     property alias settings: settings
 
+    Binding {
+        target: latencyTracer
+        property: "enabled"
+        value: settings.latencyTracing
+    }
+
     // Palettes
 
     PaletteLoader {
@@ -21,13 +21,27 @@ import QtQuick.Controls 2.1
 import ProjectManager 1.1
 import SyntaxHighlighter 1.1
 import LineNumbersHelper 1.1
+import CodeFolding 1.1
+import CodeFormatter 1.1
+import CodeView 1.1
+import CompletionModel 1.1
+import DiagnosticsModel 1.1
+import LineChanges 1.1
+import Minimap 1.1
+import OutlineModel 1.1
+import TextBuffer 1.1
+import LatencyTracer 1.1
 
 Item {
     id: cCodeArea
 
     property alias text: textEdit.text
     property alias selectedText: textEdit.selectedText
+    property alias cursorPosition: textEdit.cursorPosition
+    property alias scrollPosition: flickable.contentY
     property int indentSize: 0
+    // the examples until they are restored, nothing can be saved
+    property alias readOnly: textEdit.readOnly
 
     readonly property bool useNativeTouchHandling : (Qt.platform.os === "ios")
 
@@ -39,6 +53,8 @@ Item {
     }
 
     function paste() {
+        if (readOnly)
+            return
         textEdit.textChangedManually = true
         textEdit.paste()
     }
@@ -48,10 +64,95 @@ Item {
     }
 
     function cut() {
+        if (readOnly)
+        {
+            copy()
+            return
+        }
         textEdit.textChangedManually = true
         textEdit.cut()
     }
 
+    function undo() {
+        if (readOnly)
+            return
+        textEdit.textChangedManually = true
+        textBuffer.history.undo()
+        textEdit.textChangedManually = false
+    }
+
+    function redo() {
+        if (readOnly)
+            return
+        textEdit.textChangedManually = true
+        textBuffer.history.redo()
+        textEdit.textChangedManually = false
+    }
+
+    function jumpToMatchingBracket() {
+        if (textEdit.matchedBracketPosition < 0)
+            return
+
+        // keep the cursor on the same side of the bracket
+        var offset = textEdit.cursorPosition - textEdit.bracketPosition
+        textEdit.cursorPosition = textEdit.matchedBracketPosition + offset
+        flickable.ensureVisible(textEdit.cursorRectangle)
+    }
+
+    function selectEnclosingBlock() {
+        var start = syntaxHighlighter.enclosingBlockStart(textEdit.selectionStart)
+        if (start < 0)
+            return
+
+        var end = syntaxHighlighter.matchingBracket(start)
+        if (end < 0)
+            return
+
+        textEdit.select(start, end + 1)
+        textEdit.leftSelectionHandle.setPosition()
+        textEdit.rightSelectionHandle.setPosition()
+        flickable.ensureVisible(textEdit.positionToRectangle(textEdit.selectionStart))
+    }
+
+    function jumpTo(position) {
+        codeFolding.reveal(position)
+        textEdit.cursorPosition = position
+        flickable.ensureVisible(textEdit.cursorRectangle)
+        textEdit.forceActiveFocus()
+    }
+
+    function complete(row) {
+        var start = completionModel.wordStart
+        var end = completionModel.wordEnd
+        var completion = completionModel.completion(row)
+        completionModel.clear()
+
+        // one undo step together with the typed prefix
+        textEdit.textChangedManually = true
+        textBuffer.history.continueGroup()
+        textEdit.remove(start, end)
+        textEdit.textChangedManually = true
+        textBuffer.history.continueGroup()
+        textEdit.insert(start, completion)
+    }
+
+    // one undo step, the cursor stays where it was
+    function formatDocument() {
+        if (readOnly)
+            return
+        textEdit.textChangedManually = true
+        codeFormatter.formatDocument()
+        textEdit.textChangedManually = false
+    }
+
+    function formatSelection() {
+        if (readOnly)
+            return
+        textEdit.textChangedManually = true
+        codeFormatter.formatRange(textEdit.selectionStart, textEdit.selectionEnd)
+        textEdit.textChangedManually = false
+    }
+
     function selectAll() {
         textEdit.selectAll()
         textEdit.leftSelectionHandle.setPosition()
@@ -63,10 +164,89 @@ Item {
             textEdit.forceActiveFocus()
     }
 
+    property alias buffer: textBuffer
+    property alias outline: outlineModel
+    property alias diagnostics: diagnosticsModel
+    property alias fileFormat: syntaxHighlighter.fileFormat
+
     LineNumbersHelper {
         id: lineNumbersHelper
     }
 
+    CodeFolding {
+        id: codeFolding
+        onFoldsChanged: {
+            lineNumberRepeater.model = 0
+            lineNumberRepeater.model = lineNumbersHelper.lineCount
+            textEdit.cursorPosition = visiblePosition(textEdit.cursorPosition)
+        }
+    }
+
+    OutlineModel {
+        id: outlineModel
+    }
+
+    CodeFormatter {
+        id: codeFormatter
+        indentSize: cCodeArea.indentSize
+    }
+
+    CompletionModel {
+        id: completionModel
+    }
+
+    DiagnosticsModel {
+        id: diagnosticsModel
+        buffer: textBuffer
+        onDiagnosticsChanged: {
+            lineNumberRepeater.model = 0
+            lineNumberRepeater.model = lineNumbersHelper.lineCount
+            diagnosticBar.update()
+        }
+    }
+
+    // the other files of the project are compiled from the cache
+    Connections {
+        target: ProjectManager
+        function onFileSaved(path) {
+            diagnosticsModel.clearCache()
+        }
+        function onFilesChanged(path) {
+            diagnosticsModel.clearCache()
+        }
+    }
+
+    TextBuffer {
+        id: textBuffer
+        history.persistent: settings.persistentUndo
+    }
+
+    LineChanges {
+        id: lineChanges
+        buffer: textBuffer
+    }
+
+    Connections {
+        target: textBuffer
+        function onContentsEdited() {
+            // only typing a word character completes, the candidates are
+            // looked up once the highlighter has re-lexed the block
+            if (!textBuffer.loading && textBuffer.lastCharsAdded === 1 && textBuffer.lastCharsRemoved === 0
+                    && /\w/.test(textBuffer.charAt(textBuffer.lastEditPosition)))
+                Qt.callLater(textEdit.updateCompletion)
+            else
+                completionModel.clear()
+        }
+    }
+
+    Connections {
+        target: textBuffer.history
+        function onCursorPositionRequested(position) {
+            textEdit.cursorPosition = position
+            flickable.ensureVisible(textEdit.cursorRectangle)
+        }
+    }
+
     Rectangle {
         id: lineNumbers
         anchors.top: parent.top
@@ -83,19 +263,55 @@ Item {
             Repeater {
                 id: lineNumberRepeater
                 model: lineNumbersHelper.lineCount
-                delegate: Text {
+                delegate: Row {
                     readonly property bool isCurrentLine :
                         lineNumbersHelper.isCurrentBlock(index, textEdit.cursorPosition);
+                    readonly property bool isFoldable: codeFolding.isFoldable(index)
 
                     anchors.right: column.right
-                    color: isCurrentLine ?
-                               appWindow.colorPalette.label :
-                               appWindow.colorPalette.lineNumber
                     height: lineNumbersHelper.height(index)
-                    font.family: settings.font
-                    font.pixelSize: settings.fontSize
-                    font.bold: isCurrentLine
-                    text: index + 1
+                    // lines inside a folded region have no height
+                    visible: height > 0
+
+                    // changes since the file was loaded or saved
+                    Rectangle {
+                        readonly property int marker: lineChanges.revision >= 0 ? lineChanges.marker(index) : 0
+
+                        width: Math.max(2, Math.round(settings.pixelDensity * 0.6))
+                        height: marker === LineChanges.Removed ? 2 * width : parent.height
+                        color: marker === LineChanges.Added ? appWindow.colorPalette.lineAdded :
+                               marker === LineChanges.Modified ? appWindow.colorPalette.lineModified :
+                               marker === LineChanges.Removed ? appWindow.colorPalette.lineRemoved :
+                                                                "transparent"
+                    }
+
+                    Text {
+                        height: parent.height
+                        color: diagnosticsModel.hasDiagnostic(index) ?
+                                   appWindow.colorPalette.warning :
+                               isCurrentLine ?
+                                   appWindow.colorPalette.label :
+                                   appWindow.colorPalette.lineNumber
+                        font.family: settings.font
+                        font.pixelSize: settings.fontSize
+                        font.bold: isCurrentLine
+                        text: index + 1
+                    }
+
+                    Text {
+                        width: Math.round(settings.fontSize * 0.7)
+                        height: parent.height
+                        horizontalAlignment: Text.AlignHCenter
+                        color: appWindow.colorPalette.lineNumber
+                        font.pixelSize: settings.fontSize
+                        text: !isFoldable ? "" : (codeFolding.isFolded(index) ? "\u25B8" : "\u25BE")
+
+                        MouseArea {
+                            anchors.fill: parent
+                            enabled: isFoldable
+                            onClicked: codeFolding.toggleFold(index)
+                        }
+                    }
                 }
             }
         }
@@ -106,7 +322,7 @@ Item {
         anchors.top: parent.top
         anchors.bottom: parent.bottom
         anchors.left: lineNumbers.right
-        anchors.right: (scrollBar.visible) ? scrollBar.left : parent.right
+        anchors.right: minimap.left
         interactive: useNativeTouchHandling
         flickableDirection: Flickable.VerticalFlick
 
@@ -146,6 +362,14 @@ Item {
 
             property int currentLine: cursorRectangle.y / cursorRectangle.height + 1
 
+            // draws the text, the cursor and the selection in place of the TextEdit
+            CodeView {
+                anchors.fill: parent
+                editor: textEdit
+                viewportY: flickable.contentY
+                viewportHeight: flickable.height
+            }
+
             onContentHeightChanged:
                 flickable.contentHeight = contentHeight
 
@@ -155,102 +379,221 @@ Item {
             }
 
             onTextChanged: {
+                latencyTracer.begin(LatencyTracer.Gutter)
                 lineNumberRepeater.model = 0
                 lineNumberRepeater.model = lineNumbersHelper.lineCount
+                latencyTracer.end(LatencyTracer.Gutter)
             }
 
             property bool textChangedManually: false
-            property string previousText: ""
+            property int seenRevision: -1
             onLengthChanged: {
-                if (settings.indentSize === 0)
+                latencyTracer.begin(LatencyTracer.Script)
+                autoIndent()
+                latencyTracer.end(LatencyTracer.Script)
+            }
+
+            function autoIndent() {
+                if (settings.indentSize === 0 || textBuffer.loading)
+                    return
+
+                // TextEdit also sends us "lengthChanged" after every select() and forceActiveFocus()
+                // call, only react to edits the buffer has actually recorded
+                if (textBuffer.revision === seenRevision)
+                    return
+
+                seenRevision = textBuffer.revision
+
+                if (textChangedManually)
+                {
+                    textChangedManually = false
+                    return
+                }
+
+                if (textBuffer.lastCharsAdded <= textBuffer.lastCharsRemoved)
                     return
 
-                // This is kind of stupid workaround, we forced to do this check because TextEdit sends
-                // us "textChanged" and "lengthChanged" signals after every select() and forceActiveFocus() call
-                if (text !== previousText)
+                var editEnd = textBuffer.lastEditPosition + textBuffer.lastCharsAdded
+                var lastCharacter = textBuffer.charAt(editEnd - 1)
+                var indentDepth
+
+                switch (lastCharacter)
                 {
-                    if (textChangedManually)
+                case "\n":
+                    indentDepth = syntaxHighlighter.bracketDepth(editEnd - 1)
+                    if (indentDepth > 0)
                     {
-                        previousText = text
-                        textChangedManually = false
-                        return
+                        textChangedManually = true
+                        textBuffer.history.continueGroup()
+                        insert(editEnd, new Array(indentDepth + 1).join(textEdit.indentString))
                     }
-
-                    if (length > previousText.length)
+                    break
+                case "}":
+                    var lineBreakPosition = textBuffer.lineBreakBefore(editEnd - 1)
+                    if (lineBreakPosition >= 0)
                     {
-                        var textBeforeCursor
-                        var openBrackets
-                        var closeBrackets
-                        var openBracketsCount
-                        var closeBracketsCount
-                        var indentDepth
-                        var indentString
+                        textChangedManually = true
+                        textBuffer.history.continueGroup()
+                        remove(lineBreakPosition + 1, editEnd - 1)
 
-                        var lastCharacter = text[cursorPosition - 1]
-
-                        switch (lastCharacter)
+                        var bracketPosition = lineBreakPosition + 1
+                        indentDepth = syntaxHighlighter.bracketDepth(bracketPosition) - 1
+                        if (indentDepth > 0)
                         {
-                        case "\n":
-                            textBeforeCursor = text.substring(0, cursorPosition - 1)
-                            openBrackets = textBeforeCursor.match(/\{/g)
-                            closeBrackets = textBeforeCursor.match(/\}/g)
-
-                            if (openBrackets !== null)
-                            {
-                                openBracketsCount = openBrackets.length
-                                closeBracketsCount = 0
-
-                                if (closeBrackets !== null)
-                                    closeBracketsCount = closeBrackets.length
-
-                                indentDepth = openBracketsCount - closeBracketsCount
-                                indentString = new Array(indentDepth + 1).join(textEdit.indentString)
-                                textChangedManually = true
-                                insert(cursorPosition, indentString)
-                            }
-                            break
-                        case "}":
-                            var lineBreakPosition
-                            for (var i = cursorPosition - 2; i >= 0; i--)
-                            {
-                                if (text[i] !== " ")
-                                {
-                                    if (text[i] === "\n")
-                                        lineBreakPosition = i
-
-                                    break
-                                }
-                            }
+                            textChangedManually = true
+                            textBuffer.history.continueGroup()
+                            insert(bracketPosition, new Array(indentDepth + 1).join(textEdit.indentString))
+                        }
+                    }
+                    break
+                }
+            }
 
-                            if (lineBreakPosition !== undefined)
-                            {
-                                textChangedManually = true
-                                remove(lineBreakPosition + 1, cursorPosition - 1)
+            // the document's own undo stack is disabled, see EditHistory
+            Keys.onPressed: {
+                if (completionList.visible && completionList.handleKey(event))
+                {
+                    event.accepted = true
+                }
+                else if (event.matches(StandardKey.Undo))
+                {
+                    cCodeArea.undo()
+                    event.accepted = true
+                }
+                else if (event.matches(StandardKey.Redo))
+                {
+                    cCodeArea.redo()
+                    event.accepted = true
+                }
+                else if (event.key === Qt.Key_BracketRight && (event.modifiers & Qt.ControlModifier))
+                {
+                    cCodeArea.jumpToMatchingBracket()
+                    event.accepted = true
+                }
+                else if (event.key === Qt.Key_BracketLeft && (event.modifiers & Qt.ControlModifier))
+                {
+                    cCodeArea.selectEnclosingBlock()
+                    event.accepted = true
+                }
+            }
 
-                                textBeforeCursor = text.substring(0, cursorPosition - 1)
-                                openBrackets = textBeforeCursor.match(/\{/g)
-                                closeBrackets = textBeforeCursor.match(/\}/g)
+            // bracket next to the cursor and its pair, both -1 when there is none
+            property int bracketPosition: -1
+            property int matchedBracketPosition: -1
 
-                                if (openBrackets !== null)
-                                {
-                                    openBracketsCount = openBrackets.length
-                                    closeBracketsCount = 0
+            function updateBracketMatch() {
+                var position = cursorPosition
+                var match = syntaxHighlighter.matchingBracket(position)
+                if (match < 0 && position > 0)
+                    match = syntaxHighlighter.matchingBracket(--position)
 
-                                    if (closeBrackets !== null)
-                                        closeBracketsCount = closeBrackets.length
+                bracketPosition = (match < 0) ? -1 : position
+                matchedBracketPosition = match
+            }
 
-                                    indentDepth = openBracketsCount - closeBracketsCount - 1
-                                    indentString = new Array(indentDepth + 1).join(textEdit.indentString)
-                                    textChangedManually = true
-                                    insert(cursorPosition - 1, indentString)
-                                }
-                            }
+            function updateCompletion() {
+                if (cursorPosition === textBuffer.lastEditPosition + 1 && selectionStart === selectionEnd)
+                    completionModel.update(cursorPosition)
+            }
 
-                            break
-                        }
+            ListView {
+                id: completionList
+
+                property int delegateHeight: 10 * settings.pixelDensity
+
+                visible: completionModel.count > 0 && textEdit.activeFocus
+                z: 1
+                x: Math.max(0, Math.min(textEdit.cursorRectangle.x, textEdit.width - width))
+                y: textEdit.cursorRectangle.y + textEdit.cursorRectangle.height
+                width: 50 * settings.pixelDensity
+                height: delegateHeight * Math.min(count, 5)
+                clip: true
+                boundsBehavior: Flickable.StopAtBounds
+                model: completionModel
+
+                Connections {
+                    target: completionModel
+                    function onCountChanged() {
+                        completionList.currentIndex = 0
+                        completionList.positionViewAtBeginning()
                     }
+                }
 
-                    previousText = text
+                function handleKey(event) {
+                    switch (event.key)
+                    {
+                    case Qt.Key_Down:
+                        incrementCurrentIndex()
+                        return true
+                    case Qt.Key_Up:
+                        decrementCurrentIndex()
+                        return true
+                    case Qt.Key_Return:
+                    case Qt.Key_Enter:
+                    case Qt.Key_Tab:
+                        cCodeArea.complete(currentIndex)
+                        return true
+                    case Qt.Key_Escape:
+                        completionModel.clear()
+                        return true
+                    }
+                    return false
+                }
+
+                delegate: Rectangle {
+                    width: ListView.view.width
+                    height: ListView.view.delegateHeight
+                    color: (index === completionList.currentIndex || completionMouseArea.pressed) ?
+                               appWindow.colorPalette.contextMenuButtonPressed :
+                               appWindow.colorPalette.contextMenuButton
+
+                    CLabel {
+                        anchors.left: parent.left
+                        anchors.right: kindLabel.left
+                        anchors.top: parent.top
+                        anchors.bottom: parent.bottom
+                        anchors.leftMargin: 2 * settings.pixelDensity
+                        color: appWindow.colorPalette.contextMenuButtonText
+                        text: model.name
+                    }
+
+                    CLabel {
+                        id: kindLabel
+                        anchors.right: parent.right
+                        anchors.top: parent.top
+                        anchors.bottom: parent.bottom
+                        anchors.rightMargin: 2 * settings.pixelDensity
+                        font.pixelSize: 4 * settings.pixelDensity
+                        color: appWindow.colorPalette.contextMenuButtonText
+                        opacity: 0.6
+                        text: model.kind
+                    }
+
+                    MouseArea {
+                        id: completionMouseArea
+                        anchors.fill: parent
+                        onClicked: cCodeArea.complete(index)
+                    }
+                }
+            }
+
+            FontMetrics {
+                id: bracketMetrics
+                font: textEdit.font
+            }
+
+            Repeater {
+                model: (textEdit.bracketPosition >= 0) ?
+                           [textEdit.bracketPosition, textEdit.matchedBracketPosition] : []
+                delegate: Rectangle {
+                    readonly property rect bracketRectangle: textEdit.positionToRectangle(modelData)
+
+                    z: -1
+                    x: bracketRectangle.x
+                    y: bracketRectangle.y
+                    width: bracketMetrics.averageCharacterWidth
+                    height: bracketRectangle.height
+                    color: appWindow.colorPalette.editorMatchingBracket
                 }
             }
 
@@ -267,22 +610,35 @@ Item {
                 markerColor: appWindow.colorPalette.editorMarker
                 itemColor: appWindow.colorPalette.editorItem
                 propertyColor: appWindow.colorPalette.editorProperty
+                errorColor: appWindow.colorPalette.warning
+                buffer: textBuffer
             }
 
             Component.onCompleted: {
                 oskEventFixer.setupImEventFilter(textEdit)
                 lineNumbersHelper.document = textEdit.textDocument
+                textBuffer.document = textEdit.textDocument
                 syntaxHighlighter.setHighlighter(textEdit)
+                codeFolding.highlighter = syntaxHighlighter
+                outlineModel.highlighter = syntaxHighlighter
+                codeFormatter.highlighter = syntaxHighlighter
+                completionModel.highlighter = syntaxHighlighter
+                diagnosticsModel.highlighter = syntaxHighlighter
+                minimap.highlighter = syntaxHighlighter
                 if (ProjectManager.project !== "") {
                     // add custom components
                     var files = ProjectManager.files()
                     for (var i = 0; i < files.length; i++) {
                         var filename = files[i].name.split(".")
                         if (filename[0] !== "main") {
-                            if (filename[1] === "qml")
+                            if (filename[1] === "qml") {
                                 syntaxHighlighter.addQmlComponent(filename[0])
-                            if (filename[1] === "js")
+                                completionModel.addQmlComponent(filename[0])
+                            }
+                            if (filename[1] === "js") {
                                 syntaxHighlighter.addJsComponent(filename[0])
+                                completionModel.addJsComponent(filename[0])
+                            }
                         }
                     }
                     syntaxHighlighter.rehighlight()
@@ -585,8 +941,15 @@ Item {
                 }
             }
 
-            onCursorPositionChanged:
+            onCursorPositionChanged: {
                 textEdit.contextMenu.visible = false
+                if (cursorPosition !== completionModel.wordEnd)
+                    completionModel.clear()
+                diagnosticBar.update()
+                codeFolding.reveal(cursorPosition)
+                // the highlighter re-lexes the edited block after the cursor moved
+                Qt.callLater(updateBracketMatch)
+            }
 
             property Item contextMenu: ListView {
                 parent: textEdit
@@ -604,6 +967,7 @@ Item {
                     ListElement { text: qsTr("Undo") }
                     ListElement { text: qsTr("Redo") }
                     ListElement { text: qsTr("Paste") }
+                    ListElement { text: qsTr("Select block") }
                 }
 
                 function contextMenuCallback(index) {
@@ -611,14 +975,17 @@ Item {
                     switch (index)
                     {
                     case 0:
-                        textEdit.undo()
+                        cCodeArea.undo()
                         break
                     case 1:
-                        textEdit.redo()
+                        cCodeArea.redo()
                         break
                     case 2:
                         cCodeArea.paste()
                         break
+                    case 3:
+                        cCodeArea.selectEnclosingBlock()
+                        break
                     }
                 }
 
@@ -673,6 +1040,64 @@ Item {
         }
     }
 
+    // compile error on the cursor's line
+    Rectangle {
+        id: diagnosticBar
+
+        function update() {
+            diagnosticLabel.text = diagnosticsModel.messageAt(textEdit.cursorPosition)
+        }
+
+        anchors.left: lineNumbers.right
+        anchors.right: minimap.left
+        anchors.bottom: parent.bottom
+        height: diagnosticLabel.implicitHeight + 2 * settings.pixelDensity
+        visible: diagnosticLabel.text !== ""
+        color: appWindow.colorPalette.tooltipBackground
+
+        CLabel {
+            id: diagnosticLabel
+            anchors.fill: parent
+            anchors.leftMargin: 2 * settings.pixelDensity
+            anchors.rightMargin: 2 * settings.pixelDensity
+            color: appWindow.colorPalette.tooltipText
+            wrapMode: Text.Wrap
+            maximumLineCount: 3
+        }
+    }
+
+    // overview of the document beside the scroll bar, tapping or dragging on it scrolls there
+    Minimap {
+        id: minimap
+
+        anchors.top: parent.top
+        anchors.bottom: parent.bottom
+        anchors.right: (scrollBar.visible) ? scrollBar.left : parent.right
+        width: visible ? 12 * settings.pixelDensity : 0
+        visible: flickable.contentHeight > flickable.height
+
+        color: appWindow.colorPalette.background
+        viewportY: flickable.contentY
+        viewportHeight: flickable.height
+        contentHeight: flickable.contentHeight
+
+        Rectangle {
+            anchors.left: parent.left
+            anchors.right: parent.right
+            y: minimap.indicatorY
+            height: Math.max(minimap.indicatorHeight, settings.pixelDensity)
+            color: appWindow.colorPalette.scrollBar
+        }
+
+        MouseArea {
+            anchors.fill: parent
+            preventStealing: true
+
+            onPressed: flickable.contentY = minimap.contentYAt(mouseY)
+            onMouseYChanged: flickable.contentY = minimap.contentYAt(mouseY)
+        }
+    }
+
     CNavigationScrollBar {
         id: scrollBar
 
@@ -32,6 +32,7 @@ Item {
     property bool isDir : false
 
     signal clicked()
+    signal pressAndHold()
     signal removeClicked()
 
     CHorizontalSeparator {
@@ -81,6 +82,7 @@ Item {
                 id: buttonMouseArea
                 anchors.fill: parent
                 onClicked: cFileButton.clicked()
+                onPressAndHold: cFileButton.pressAndHold()
             }
         }
 
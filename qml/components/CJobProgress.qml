@@ -0,0 +1,70 @@
+/****************************************************************************
+**
+** Copyright (C) 2013-2015 Oleg Yadrov
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+** http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+****************************************************************************/
+import QtQuick 2.5
+import ProjectManager 1.1
+
+// Strip along the bottom of the window while ProjectManager deletes or
+// copies files in the background, with a button that cancels them all
+Rectangle {
+    id: cJobProgress
+    anchors.left: parent.left
+    anchors.right: parent.right
+    anchors.bottom: parent.bottom
+    height: 12 * settings.pixelDensity
+    color: appWindow.colorPalette.toolBarBackground
+    visible: ProjectManager.jobCount > 0
+
+    Rectangle {
+        anchors.left: parent.left
+        anchors.right: parent.right
+        anchors.top: parent.top
+        height: Math.max(1, settings.pixelDensity / 4)
+        color: appWindow.colorPalette.toolBarStripe
+    }
+
+    CLabel {
+        id: label
+        anchors.left: parent.left
+        anchors.right: cancelButton.left
+        anchors.top: parent.top
+        anchors.bottom: stripe.top
+        anchors.leftMargin: 3 * settings.pixelDensity
+        verticalAlignment: Text.AlignVCenter
+        elide: Text.ElideRight
+        text: qsTr("Working on files… %1%").arg(Math.round(ProjectManager.jobProgress * 100))
+    }
+
+    CToolButton {
+        id: cancelButton
+        anchors.right: parent.right
+        anchors.top: parent.top
+        anchors.bottom: parent.bottom
+        icon: "\uf00d"
+        tooltipText: qsTr("Cancel")
+        onClicked: ProjectManager.cancelAllJobs()
+    }
+
+    Rectangle {
+        id: stripe
+        anchors.left: parent.left
+        anchors.bottom: parent.bottom
+        height: settings.pixelDensity
+        width: cancelButton.x * ProjectManager.jobProgress
+        color: appWindow.colorPalette.sliderFilledStripe
+    }
+}
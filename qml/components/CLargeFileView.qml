@@ -0,0 +1,294 @@
+/****************************************************************************
+**
+** Copyright (C) 2013-2015 Oleg Yadrov
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+** http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+****************************************************************************/
+
+import QtQuick 2.5
+import MappedFile 1.1
+import SyntaxHighlighter 1.1
+
+// Read-only viewer for files too large for CCodeArea. The file stays mapped
+// (see MappedFile) and only a window of lines around the viewport is decoded
+// into the TextEdit and highlighted; the flickable is as tall as the whole
+// file and the window moves along while scrolling. The lexer starts each
+// window afresh, so a comment opened above the window is not coloured.
+// The window's lines can be edited and written back to the file.
+Item {
+    id: cLargeFileView
+
+    property alias filePath: mappedFile.filePath
+    property string fileFormat: "qml"
+    readonly property alias lineCount: mappedFile.lineCount
+
+    // the window is frozen while its lines are edited
+    readonly property bool editing: !textEdit.readOnly
+
+    // lines decoded at once, and the first and number of lines of the window
+    readonly property int windowSize: 300
+    property int windowFirst: 0
+    property int windowLines: 0
+
+    readonly property real margin: 1.5 * settings.pixelDensity
+    readonly property real lineHeight: (windowLines > 0 && textEdit.contentHeight > 2 * margin) ?
+                                           (textEdit.contentHeight - 2 * margin) / windowLines :
+                                           fontMetrics.height
+
+    // the next search starts on the line after this one
+    property int searchLine: -1
+
+    function loadWindow(firstLine) {
+        windowFirst = Math.max(0, Math.min(firstLine, lineCount - windowSize))
+        windowLines = Math.min(windowSize, lineCount - windowFirst)
+        textEdit.text = mappedFile.text(windowFirst, windowLines)
+    }
+
+    // moves the window once the viewport gets near one of its ends
+    function updateWindow() {
+        if (editing || lineCount === 0)
+            return
+
+        var first = Math.floor(flickable.contentY / lineHeight)
+        var last = Math.ceil((flickable.contentY + flickable.height) / lineHeight)
+        var windowLast = windowFirst + windowLines
+        if ((first < windowFirst + windowSize / 4 && windowFirst > 0) ||
+                (last > windowLast - windowSize / 4 && windowLast < lineCount) ||
+                last < windowFirst || first > windowLast)
+            loadWindow(Math.round((first + last - windowSize) / 2))
+    }
+
+    // line is 0-based
+    function goToLine(line) {
+        line = Math.max(0, Math.min(line, lineCount - 1))
+        flickable.contentY = Math.max(0, Math.min(line * lineHeight - flickable.height / 2,
+                                                  flickable.contentHeight - flickable.height))
+        updateWindow()
+        searchLine = line
+    }
+
+    // selects the next match of text after the last one, false if there is none
+    function findNext(text) {
+        var line = mappedFile.find(text, searchLine + 1)
+        if (line < 0)
+            return false
+
+        goToLine(line)
+
+        var position = 0
+        for (var i = windowFirst; i < line; i++)
+            position = textEdit.text.indexOf("\n", position) + 1
+        var lineEnd = textEdit.text.indexOf("\n", position)
+        var lineText = textEdit.text.substring(position, lineEnd < 0 ? textEdit.length : lineEnd)
+        var column = lineText.toLowerCase().indexOf(text.toLowerCase())
+        if (column >= 0)
+            textEdit.select(position + column, position + column + text.length)
+        return true
+    }
+
+    function startEditing() {
+        textEdit.readOnly = false
+    }
+
+    // writes the window's lines back to the file
+    function finishEditing() {
+        if (!mappedFile.replaceLines(windowFirst, windowLines, textEdit.text))
+            tooltip.show(qsTr("Unable to save the lines"))
+        textEdit.readOnly = true
+        loadWindow(windowFirst)
+    }
+
+    function cancelEditing() {
+        textEdit.readOnly = true
+        loadWindow(windowFirst)
+    }
+
+    MappedFile {
+        id: mappedFile
+        onMappedChanged: if (!cLargeFileView.editing) cLargeFileView.loadWindow(cLargeFileView.windowFirst)
+    }
+
+    FontMetrics {
+        id: fontMetrics
+        font: textEdit.font
+    }
+
+    // search text or line number, and what to do with it
+    Rectangle {
+        id: searchBar
+        anchors.top: parent.top
+        anchors.left: parent.left
+        anchors.right: parent.right
+        height: 16 * settings.pixelDensity
+        color: appWindow.colorPalette.toolBarBackground
+
+        Item {
+            anchors.left: parent.left
+            anchors.right: buttons.left
+            anchors.verticalCenter: parent.verticalCenter
+            anchors.leftMargin: settings.pixelDensity
+            height: searchField.implicitHeight
+
+            CTextField {
+                id: searchField
+                placeholder: qsTr("Text or line number")
+            }
+        }
+
+        Row {
+            id: buttons
+            anchors.right: parent.right
+            anchors.top: parent.top
+            anchors.bottom: parent.bottom
+
+            CToolButton {
+                height: parent.height
+                visible: !cLargeFileView.editing
+                icon: "\uf002"
+                tooltipText: qsTr("Find next")
+                onClicked: {
+                    if (searchField.text !== "" && !cLargeFileView.findNext(searchField.text))
+                        tooltip.show(qsTr("Not found"))
+                }
+            }
+
+            CToolButton {
+                height: parent.height
+                visible: !cLargeFileView.editing
+                icon: "\uf124"
+                tooltipText: qsTr("Go to line")
+                onClicked: {
+                    var line = parseInt(searchField.text)
+                    if (!isNaN(line))
+                        cLargeFileView.goToLine(line - 1)
+                }
+            }
+
+            CToolButton {
+                height: parent.height
+                visible: !cLargeFileView.editing
+                icon: "\uf044"
+                tooltipText: qsTr("Edit these lines")
+                onClicked: cLargeFileView.startEditing()
+            }
+
+            CToolButton {
+                height: parent.height
+                visible: cLargeFileView.editing
+                icon: "\uf0c7"
+                tooltipText: qsTr("Save lines")
+                onClicked: cLargeFileView.finishEditing()
+            }
+
+            CToolButton {
+                height: parent.height
+                visible: cLargeFileView.editing
+                icon: "\uf00d"
+                tooltipText: qsTr("Discard changes")
+                onClicked: cLargeFileView.cancelEditing()
+            }
+        }
+    }
+
+    Rectangle {
+        id: lineNumbers
+        anchors.top: searchBar.bottom
+        anchors.bottom: parent.bottom
+        anchors.left: parent.left
+        width: lineNumberText.width + 2 * settings.pixelDensity
+        color: appWindow.colorPalette.lineNumbersBackground
+        clip: true
+
+        Text {
+            id: lineNumberText
+            anchors.horizontalCenter: parent.horizontalCenter
+            y: textEdit.y + cLargeFileView.margin - flickable.contentY
+            horizontalAlignment: Text.AlignRight
+            lineHeightMode: Text.FixedHeight
+            lineHeight: cLargeFileView.lineHeight
+            color: appWindow.colorPalette.lineNumber
+            font.family: settings.font
+            font.pixelSize: settings.fontSize
+            text: {
+                var numbers = []
+                for (var i = 1; i <= cLargeFileView.windowLines; i++)
+                    numbers.push(cLargeFileView.windowFirst + i)
+                return numbers.join("\n")
+            }
+        }
+    }
+
+    CFlickable {
+        id: flickable
+        anchors.top: searchBar.bottom
+        anchors.bottom: parent.bottom
+        anchors.left: lineNumbers.right
+        anchors.right: scrollBar.visible ? scrollBar.left : parent.right
+        flickableDirection: Flickable.VerticalFlick
+        contentHeight: mappedFile.lineCount * cLargeFileView.lineHeight + 2 * cLargeFileView.margin
+        clip: true
+
+        onContentYChanged: cLargeFileView.updateWindow()
+        onHeightChanged: cLargeFileView.updateWindow()
+
+        TextEdit {
+            id: textEdit
+            anchors.left: parent.left
+            anchors.right: parent.right
+            y: cLargeFileView.windowFirst * cLargeFileView.lineHeight
+
+            color: appWindow.colorPalette.editorNormal
+            selectionColor: appWindow.colorPalette.editorSelection
+            selectedTextColor: appWindow.colorPalette.editorSelectedText
+
+            font.family: settings.font
+            font.pixelSize: settings.fontSize
+            textMargin: cLargeFileView.margin
+            wrapMode: TextEdit.NoWrap
+            textFormat: TextEdit.PlainText
+            inputMethodHints: Qt.ImhNoPredictiveText
+            readOnly: true
+            selectByMouse: !readOnly
+
+            SyntaxHighlighter {
+                id: syntaxHighlighter
+
+                normalColor: appWindow.colorPalette.editorNormal
+                commentColor: appWindow.colorPalette.editorComment
+                numberColor: appWindow.colorPalette.editorNumber
+                stringColor: appWindow.colorPalette.editorString
+                operatorColor: appWindow.colorPalette.editorOperator
+                keywordColor: appWindow.colorPalette.editorKeyword
+                builtInColor: appWindow.colorPalette.editorBuiltIn
+                markerColor: appWindow.colorPalette.editorMarker
+                itemColor: appWindow.colorPalette.editorItem
+                propertyColor: appWindow.colorPalette.editorProperty
+                errorColor: appWindow.colorPalette.warning
+                fileFormat: cLargeFileView.fileFormat
+            }
+
+            Component.onCompleted: syntaxHighlighter.setHighlighter(textEdit)
+        }
+    }
+
+    CNavigationScrollBar {
+        id: scrollBar
+
+        anchors.top: searchBar.bottom
+        anchors.bottom: parent.bottom
+        anchors.right: parent.right
+
+        flickableItem: flickable
+    }
+}
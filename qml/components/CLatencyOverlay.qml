@@ -0,0 +1,97 @@
+/****************************************************************************
+**
+** Copyright (C) 2013-2015 Oleg Yadrov
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+** http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+****************************************************************************/
+
+import QtQuick 2.5
+
+// Keystroke to frame latency measured by latencyTracer while input latency
+// tracing is on in the settings, tap it to start over
+Rectangle {
+    id: cLatencyOverlay
+    anchors.right: parent.right
+    anchors.top: parent.top
+    anchors.margins: 2 * settings.pixelDensity
+    width: Math.min(parent.width - 4 * settings.pixelDensity, 90 * settings.pixelDensity)
+    height: column.height + 4 * settings.pixelDensity
+    radius: settings.pixelDensity
+    color: appWindow.colorPalette.tooltipBackground
+    visible: latencyTracer.enabled
+
+    readonly property int maximum: Math.max.apply(Math, latencyTracer.histogram.concat(1))
+
+    Column {
+        id: column
+        anchors.left: parent.left
+        anchors.right: parent.right
+        anchors.top: parent.top
+        anchors.margins: 2 * settings.pixelDensity
+        spacing: settings.pixelDensity / 2
+
+        Text {
+            width: parent.width
+            color: appWindow.colorPalette.tooltipText
+            font.pixelSize: 3.5 * settings.pixelDensity
+            wrapMode: Text.Wrap
+            text: latencyTracer.summary
+        }
+
+        Repeater {
+            model: latencyTracer.bucketLabels
+            delegate: Row {
+                spacing: settings.pixelDensity
+
+                readonly property int count: latencyTracer.histogram[index]
+
+                Text {
+                    width: 14 * settings.pixelDensity
+                    color: appWindow.colorPalette.tooltipText
+                    font.pixelSize: 3.5 * settings.pixelDensity
+                    horizontalAlignment: Text.AlignRight
+                    text: modelData
+                }
+
+                Rectangle {
+                    anchors.verticalCenter: parent.verticalCenter
+                    width: Math.max(1, (column.width - 26 * settings.pixelDensity) * count / cLatencyOverlay.maximum)
+                    height: 2.5 * settings.pixelDensity
+                    color: appWindow.colorPalette.tooltipText
+                    opacity: count > 0 ? 0.8 : 0.2
+                }
+
+                Text {
+                    color: appWindow.colorPalette.tooltipText
+                    font.pixelSize: 3.5 * settings.pixelDensity
+                    text: count
+                }
+            }
+        }
+
+        Text {
+            width: parent.width
+            color: appWindow.colorPalette.tooltipText
+            font.pixelSize: 3 * settings.pixelDensity
+            opacity: 0.6
+            elide: Text.ElideMiddle
+            text: latencyTracer.logPath
+        }
+    }
+
+    MouseArea {
+        anchors.fill: parent
+        onClicked: latencyTracer.reset()
+    }
+}
@@ -35,12 +35,14 @@ Loader {
         property string message: "MessageDialog.qml"
         property string confirmation: "ConfirmationDialog.qml"
         property string list: "ListDialog.qml"
+        property string outline: "OutlineDialog.qml"
         property string fontFamily: "FontFamilyDialog.qml"
         property string fontSize: "FontSizeDialog.qml"
         property string indentSize: "IndentSizeDialog.qml"
         property string newFile: "NewFileDialog.qml"
         property string newDir: "NewDirDialog.qml"
         property string newProject: "NewProjectDialog.qml"
+        property string rename: "RenameDialog.qml"
     }
 
     function open(type, parameters, callback) {
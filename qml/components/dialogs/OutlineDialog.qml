@@ -0,0 +1,188 @@
+/****************************************************************************
+**
+** Copyright (C) 2013-2015 Oleg Yadrov
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+** http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+****************************************************************************/
+
+import QtQuick 2.5
+import QtQml.Models 2.2
+import QtGraphicalEffects 1.0
+import ".."
+
+BaseDialog {
+    id: outlineDialog
+    contentItem: mainContent
+
+    property string title
+    property alias model: delegateModel.model
+
+    // names of the objects drilled into, for the header
+    property var path: []
+
+    function initialize(parameters) {
+        for (var attr in parameters)
+            outlineDialog[attr] = parameters[attr];
+    }
+
+    function enter(index, name) {
+        delegateModel.rootIndex = delegateModel.modelIndex(index)
+        path = path.concat([name])
+    }
+
+    function leave() {
+        delegateModel.rootIndex = delegateModel.parentModelIndex()
+        path = path.slice(0, path.length - 1)
+    }
+
+    DropShadow {
+        anchors.fill: mainContent
+        radius: 5 * settings.pixelDensity
+        color: appWindow.colorPalette.dialogShadow
+        transparentBorder: true
+        fast: true
+        source: mainContent
+        scale: mainContent
+    }
+
+    Rectangle {
+        id: mainContent
+        width: popupWidth
+        height: popupHeight
+        anchors.centerIn: parent
+        color: appWindow.colorPalette.dialogBackground
+
+        Rectangle {
+            id: header
+
+            height: 22 * settings.pixelDensity
+            anchors.left: parent.left
+            anchors.right: parent.right
+            color: appWindow.colorPalette.toolBarBackground
+
+            Rectangle {
+                anchors.left: parent.left
+                anchors.right: parent.right
+                anchors.bottom: parent.bottom
+
+                height: Math.max(1, Math.round(0.8 * settings.pixelDensity))
+                color: appWindow.colorPalette.toolBarStripe
+            }
+
+            CIcon {
+                id: backIcon
+                anchors.left: parent.left
+                anchors.top: parent.top
+                anchors.bottom: parent.bottom
+                anchors.leftMargin: 5 * settings.pixelDensity
+                visible: outlineDialog.path.length > 0
+                text: "\uf053"
+
+                MouseArea {
+                    anchors.fill: parent
+                    anchors.margins: -3 * settings.pixelDensity
+                    onClicked: outlineDialog.leave()
+                }
+            }
+
+            CLabel {
+                anchors.left: backIcon.visible ? backIcon.right : parent.left
+                anchors.right: parent.right
+                anchors.top: parent.top
+                anchors.bottom: parent.bottom
+                anchors.leftMargin: 5 * settings.pixelDensity
+                font.pixelSize: 10 * settings.pixelDensity
+                text: outlineDialog.path.length > 0 ? outlineDialog.path[outlineDialog.path.length - 1]
+                                                    : outlineDialog.title
+            }
+        }
+
+        DelegateModel {
+            id: delegateModel
+
+            delegate: Item {
+                id: row
+
+                anchors.left: parent.left
+                anchors.right: parent.right
+                height: 18.5 * settings.pixelDensity
+
+                CHorizontalSeparator {
+                    anchors.left: parent.left
+                    anchors.right: parent.right
+                    anchors.bottom: parent.bottom
+                }
+
+                Rectangle {
+                    anchors.fill: parent
+                    color: appWindow.colorPalette.button
+                    visible: mouseArea.pressed
+                }
+
+                MouseArea {
+                    id: mouseArea
+                    anchors.fill: parent
+                    onClicked: outlineDialog.process(model.position)
+                }
+
+                CLabel {
+                    anchors.left: parent.left
+                    anchors.right: childrenIcon.left
+                    anchors.leftMargin: 5 * settings.pixelDensity
+                    anchors.rightMargin: 3 * settings.pixelDensity
+                    anchors.verticalCenter: parent.verticalCenter
+                    textFormat: Text.StyledText
+                    text: {
+                        var label = model.kind === "object" ? model.name : model.kind + " " + model.name
+                        if (model.detail !== "")
+                            label += " <font color=\"" + appWindow.colorPalette.description + "\">" + model.detail + "</font>"
+                        return label
+                    }
+                }
+
+                CIcon {
+                    id: childrenIcon
+                    anchors.right: parent.right
+                    anchors.top: parent.top
+                    anchors.bottom: parent.bottom
+                    width: 15 * settings.pixelDensity
+                    horizontalAlignment: Text.AlignHCenter
+                    visible: model.hasModelChildren
+                    text: "\uf054"
+
+                    MouseArea {
+                        anchors.fill: parent
+                        onClicked: outlineDialog.enter(index, model.name)
+                    }
+                }
+            }
+        }
+
+        ListView {
+            id: listView
+
+            anchors.left: parent.left
+            anchors.right: parent.right
+            anchors.top: header.bottom
+            anchors.bottom: parent.bottom
+            boundsBehavior: Flickable.StopAtBounds
+            clip: true
+            model: delegateModel
+        }
+
+        CScrollBar {
+            flickableItem: listView
+        }
+    }
+}
@@ -0,0 +1,182 @@
+/****************************************************************************
+**
+** Copyright (C) 2013-2015 Oleg Yadrov
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+** http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+****************************************************************************/
+
+import QtQuick 2.5
+import QtGraphicalEffects 1.0
+import ProjectManager 1.1
+import ".."
+
+BaseDialog {
+    id: renameDialog
+    contentItem: mainContent
+
+    property alias title: titleLabel.text
+    // the current name, to start from
+    property alias name: nameTextField.text
+
+    function initialize(parameters) {
+        for (var attr in parameters) {
+            renameDialog[attr] = parameters[attr]
+        }
+    }
+
+    DropShadow {
+        anchors.fill: mainContent
+        radius: 5 * settings.pixelDensity
+        color: colorPalette.dialogShadow
+        transparentBorder: true
+        fast: true
+        source: mainContent
+        scale: mainContent.scale
+    }
+
+    Rectangle {
+        id: mainContent
+        width: popupWidth
+        height: popupHeight
+        anchors.centerIn: parent
+        color: colorPalette.dialogBackground
+
+        Rectangle {
+            id: header
+
+            height: 22 * settings.pixelDensity
+            anchors.left: parent.left
+            anchors.right: parent.right
+            color: colorPalette.toolBarBackground
+
+            Rectangle {
+                anchors.left: parent.left
+                anchors.right: parent.right
+                anchors.bottom: parent.bottom
+
+                height: Math.max(1, Math.round(0.8 * settings.pixelDensity))
+                color: colorPalette.toolBarStripe
+            }
+
+            CLabel {
+                id: titleLabel
+                anchors.fill: parent
+                anchors.leftMargin: 5 * settings.pixelDensity
+                font.pixelSize: 10 * settings.pixelDensity
+            }
+        }
+
+        Flickable {
+            id: flickable
+
+            anchors.left: parent.left
+            anchors.right: parent.right
+            anchors.top: header.bottom
+            anchors.bottom: footer.top
+            boundsBehavior: Flickable.StopAtBounds
+            clip: true
+
+            property double margin: 3 * settings.pixelDensity
+
+            leftMargin: margin
+            rightMargin: margin
+            topMargin: margin
+            bottomMargin: margin
+
+            contentWidth: width - margin * 2
+            contentHeight: column.height
+
+            Column {
+                id: column
+                anchors.left: parent.left
+                anchors.right: parent.right
+                spacing: 2 * settings.pixelDensity
+
+                CLabel {
+                    anchors.left: parent.left
+                    anchors.right: parent.right
+                    text: qsTr("New name") + ":"
+                }
+
+                CTextField {
+                    id: nameTextField
+
+                    validator: RegExpValidator {
+                        regExp: new RegExp("[a-zA-Z0-9_.-]*")
+                    }
+
+                    onTextChanged: {
+                        if (warningLabel.visible)
+                            warningLabel.visible = false
+                    }
+                }
+
+                CLabel {
+                    id: warningLabel
+                    anchors.left: parent.left
+                    anchors.right: parent.right
+                    wrapMode: Text.WordWrap
+                    color: colorPalette.warning
+                    visible: false
+                }
+            }
+        }
+
+        CScrollBar {
+            flickableItem: flickable
+        }
+
+        CDialogButton {
+            anchors.left: parent.left
+            anchors.right: footer.left
+            anchors.bottom: parent.bottom
+            text: qsTr("Cancel")
+            onClicked: renameDialog.close()
+        }
+
+        CVerticalSeparator {
+            id: footer
+            anchors.horizontalCenter: parent.horizontalCenter
+            anchors.bottom: parent.bottom
+        }
+
+        CDialogButton {
+            anchors.left: footer.right
+            anchors.right: parent.right
+            anchors.bottom: parent.bottom
+            text: qsTr("OK")
+            onClicked: {
+                var name = nameTextField.text
+
+                if (name.length === 0)
+                {
+                    warningLabel.text = qsTr("The name cannot be left blank")
+                    warningLabel.visible = true
+                }
+                else
+                {
+                    if (ProjectManager.fileExists(name))
+                    {
+                        warningLabel.text = qsTr("A file or directory with that name already exists")
+                        warningLabel.visible = true
+                    }
+                    else
+                    {
+                        renameDialog.process(name)
+                    }
+                }
+            }
+        }
+    }
+}
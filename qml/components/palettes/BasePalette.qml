@@ -67,11 +67,15 @@ QtObject {
 
     property color lineNumbersBackground:"#dddddd"
     property color lineNumber: "#aaaaaa"
+    property color lineAdded: "#4caf50"
+    property color lineModified: "#2196f3"
+    property color lineRemoved: "#f44336"
 
     property color editorSelection: "#aaaaaa"
     property color editorSelectedText: "#ffffff"
 
     property color editorSelectionHandle: "#777777"
+    property color editorMatchingBracket: "#cccccc"
 
     property color editorNormal: "#000000"
     property color editorComment: "#008000"
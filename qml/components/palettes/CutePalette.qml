@@ -67,11 +67,15 @@ BasePalette {
 
     lineNumbersBackground:"#e8e8e8"
     lineNumber: "#999999"
+    lineAdded: "#80c342"
+    lineModified: "#2a7ab0"
+    lineRemoved: "#d0453f"
 
     editorSelection: "#80c342"
     editorSelectedText: "#ffffff"
 
     editorSelectionHandle: "#006325"
+    editorMatchingBracket: "#c0e1a0"
 
     editorNormal: "#1e1b18"
     editorComment: "#008000"
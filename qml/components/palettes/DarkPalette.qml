@@ -67,11 +67,15 @@ BasePalette {
 
     lineNumbersBackground:"#485257"
     lineNumber: "#aaaaaa"
+    lineAdded: "#81c784"
+    lineModified: "#80cbc4"
+    lineRemoved: "#e57373"
 
     editorSelection: "#687074"
     editorSelectedText: "#ffffff"
 
     editorSelectionHandle: "#80cbc4"
+    editorMatchingBracket: "#59676e"
 
     editorNormal: "#f3f3f3"
     editorComment: "#55ffff"
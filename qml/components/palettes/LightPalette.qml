@@ -67,11 +67,15 @@ BasePalette {
 
     lineNumbersBackground:"#e6e5eb"
     lineNumber: "#aaaaaa"
+    lineAdded: "#4cd964"
+    lineModified: "#167ffc"
+    lineRemoved: "#ff3b30"
 
     editorSelection: "#aaaaaa"
     editorSelectedText: "#ffffff"
 
     editorSelectionHandle: "#167ffc"
+    editorMatchingBracket: "#cccccc"
 
     editorNormal: "#222222"
     editorComment: "#008000"
@@ -19,6 +19,8 @@
 import QtQuick 2.5
 import QtQuick.Controls 2.2
 import QtQuick.Controls.Material 2.2
+import DocumentManager 1.1
+import ProjectManager 1.1
 import "components"
 import "components/dialogs"
 import "screens"
@@ -51,6 +53,48 @@ CApplicationWindow {
         }
     }
 
+    // Screens that are not part of the first frame are compiled in the
+    // background once it is shown, so pushing them later is instant
+    property var preloadedScreens: []
+    readonly property var screensToPreload: [
+        "screens/ProjectsScreen.qml",
+        "screens/ExamplesScreen.qml",
+        "screens/FilesScreen.qml",
+        "screens/EditorScreen.qml",
+        "screens/SettingsScreen.qml",
+        "screens/ModulesScreen.qml",
+        "screens/AboutScreen.qml"
+    ]
+
+    function preloadScreens() {
+        screensToPreload.forEach(function(screen) {
+            var component = Qt.createComponent(Qt.resolvedUrl(screen), Component.Asynchronous)
+            var reportStatus = function() {
+                if (component.status === Component.Ready)
+                    startupTimeline.mark(screen + " compiled")
+                else if (component.status === Component.Error)
+                    console.warn(component.errorString())
+            }
+
+            if (component.status === Component.Loading)
+                component.statusChanged.connect(reportStatus)
+            else
+                reportStatus()
+
+            preloadedScreens.push(component)
+        })
+    }
+
+    Component.onCompleted:
+        startupTimeline.mark("main.qml completed")
+
+    Connections {
+        target: startupTimeline
+        function onFirstFrameSwapped() {
+            appWindow.preloadScreens()
+        }
+    }
+
     CSplitView {
         id: splitView
         anchors.fill: parent
@@ -75,6 +119,7 @@ CApplicationWindow {
             Image {
                 anchors.fill: parent
                 anchors.margins: parent.width / 4
+                asynchronous: true
                 visible: splitView.enableDualView
                 fillMode: Image.PreserveAspectFit
                 source: "qrc:/resources/images/icon512.png"
@@ -82,6 +127,24 @@ CApplicationWindow {
         }
     }
 
+    // open editors, shared by all FilesScreens
+    DocumentManager {
+        id: documentManager
+    }
+
+    Connections {
+        target: ProjectManager
+        function onFilesChanged(path) {
+            documentManager.remove(path)
+        }
+    }
+
+    CJobProgress {
+    }
+
+    CLatencyOverlay {
+    }
+
     DialogLoader {
         id: dialog
         anchors.fill: parent
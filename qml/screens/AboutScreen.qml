@@ -36,7 +36,8 @@ BlankScreen {
         text:  textStyle() +
                "QML Creator " + Qt.application.version + "<br>
                Based on Qt Quick (Qt " + qtVersion + ")<br>
-               Built on " + buildDateTime + "<br><br>
+               Built on " + buildDateTime + "<br>
+               QML " + qmlCompilationMode + "<br><br>
                Copyright (C) 2019 <a href=\"https://fredl.me/\">Alfred Neumayer</a><br>
                <a class=\"link\" href=\"mailto:dev.beidl@gmail.com\">dev.beidl@gmail.com</a><br><br>
                Copyright (C) 2013-2015 <a href=\"https://linkedin.com/in/olegyadrov/\">Oleg Yadrov</a><br>
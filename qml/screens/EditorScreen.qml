@@ -17,7 +17,7 @@
 ****************************************************************************/
 
 import QtQuick 2.5
-import QtQuick.Controls 2.0
+import QtQuick.Controls 2.1
 import QtQuick.Layouts 1.2
 import QtGraphicalEffects 1.0
 import ProjectManager 1.1
@@ -28,22 +28,76 @@ BlankScreen {
     objectName: "EditorScreen"
 
     function saveContent() {
+        // the viewer writes its edits itself, the buffer is empty
+        if (largeFile || discarded || readOnly)
+            return
+
+        ProjectManager.subDir = subDir
         ProjectManager.fileName = fileName
-        ProjectManager.saveFileContent(codeArea.text)
+        ProjectManager.saveBuffer(codeArea.buffer)
+        documentManager.synced(filePath)
+    }
+
+    // called by documentManager when the file changed on disk under the
+    // editor, which then goes without saving once it is off the stack
+    function discard() {
+        discarded = true
+        if (!stacked)
+            destroy()
     }
 
     property alias codeArea : codeArea
     property string fileName: ""
+    property string subDir: ""
+    // key of this editor in documentManager
+    property string filePath: ""
+
+    // state documentManager keeps for evicted editors
+    readonly property alias buffer: codeArea.buffer
+    property alias cursorPosition: codeArea.cursorPosition
+    property alias scrollPosition: codeArea.scrollPosition
+
+    property bool loaded: false
+    property bool discarded: false
+    // opened from the resources, see ProjectManager.readOnly
+    property bool readOnly: false
+    property bool stacked: false
+    // shown in largeFileView instead of codeArea
+    property bool largeFile: false
 
     StackView.onStatusChanged: {
         if (StackView.status === StackView.Activating) {
+            stacked = true
+            ProjectManager.subDir = subDir
             ProjectManager.fileName = fileName
-            codeArea.text = ProjectManager.getFileContent();
+            codeArea.fileFormat = ProjectManager.fileFormat
+            readOnly = ProjectManager.readOnly
+            if (readOnly)
+                tooltip.show(qsTr("Restore the examples to edit them"))
+            // editors kept open by documentManager already hold the file
+            if (!loaded) {
+                largeFile = ProjectManager.isLargeFile()
+                if (largeFile) {
+                    largeFileView.fileFormat = ProjectManager.fileFormat
+                    largeFileView.filePath = ProjectManager.filePath(fileName)
+                } else if (!documentManager.restore(filePath, editorScreen)) {
+                    ProjectManager.loadBuffer(codeArea.buffer)
+                }
+                documentManager.synced(filePath)
+                loaded = true
+            }
+            codeArea.diagnostics.fileUrl = (ProjectManager.fileFormat === "qml") ? ProjectManager.getFilePath() : ""
         } else if (StackView.status === StackView.Deactivating) {
             saveContent()
         }
     }
 
+    StackView.onRemoved: {
+        stacked = false
+        if (discarded)
+            destroy()
+    }
+
 
 
     CCodeArea {
@@ -55,8 +109,19 @@ BlankScreen {
         anchors.right: parent.right
 
         indentSize: settings.indentSize
+        readOnly: editorScreen.readOnly
+        visible: !largeFile
+    }
 
-        text: ""
+    CLargeFileView {
+        id: largeFileView
+
+        anchors.top: toolBar.bottom
+        anchors.bottom: parent.bottom
+        anchors.left: parent.left
+        anchors.right: parent.right
+
+        visible: largeFile
     }
 
     CToolBar {
@@ -97,13 +162,46 @@ BlankScreen {
             }
 
             CToolButton {
-                visible: codeArea.selectedText.length > 0 && !codeArea.useNativeTouchHandling
+                visible: codeArea.selectedText.length > 0 && !codeArea.useNativeTouchHandling && !readOnly
                 Layout.fillHeight: true
                 icon: "\uf0c4"
                 tooltipText: qsTr("Cut")
                 onClicked: codeArea.cut()
             }
 
+            CToolButton {
+                visible: !largeFile && !readOnly
+                Layout.fillHeight: true
+                icon: "\uf03c"
+                tooltipText: codeArea.selectedText.length > 0 ? qsTr("Format selection") : qsTr("Format")
+                onClicked: {
+                    if (codeArea.selectedText.length > 0)
+                        codeArea.formatSelection()
+                    else
+                        codeArea.formatDocument()
+                }
+            }
+
+            CToolButton {
+                visible: ProjectManager.fileFormat === "qml" && !largeFile &&
+                         (!codeArea.selectedText.length > 0 || codeArea.useNativeTouchHandling)
+                Layout.fillHeight: true
+                icon: "\uf03a"
+                tooltipText: qsTr("Outline")
+                onClicked: {
+                    var parameters = {
+                        title: qsTr("Outline"),
+                        model: codeArea.outline
+                    }
+
+                    var callback = function(value) {
+                        codeArea.jumpTo(value)
+                    }
+
+                    dialog.open(dialog.types.outline, parameters, callback)
+                }
+            }
+
             CToolButton {
                 visible: ProjectManager.fileFormat === "qml" &&
                          (!codeArea.selectedText.length > 0 || codeArea.useNativeTouchHandling)
@@ -111,7 +209,7 @@ BlankScreen {
                 icon: "\uf04b"
                 tooltipText: qsTr("Run")
                 onClicked: {
-                    ProjectManager.saveFileContent(codeArea.text)
+                    saveContent()
                     ProjectManager.clearComponentCache()
                     Qt.inputMethod.hide()
                     rightView.push(Qt.resolvedUrl("PlaygroundScreen.qml"))
@@ -128,7 +226,7 @@ BlankScreen {
         opacity: 0.55
 
         source: ShaderEffectSource {
-            sourceItem: codeArea
+            sourceItem: largeFile ? largeFileView : codeArea
             sourceRect: Qt.rect(0, -toolBar.height, fastBlur.width, fastBlur.height)
         }
     }
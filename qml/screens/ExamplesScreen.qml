@@ -37,6 +37,16 @@ BlankScreen {
         }
     }
 
+    // deletions and the restore finish in the background
+    Connections {
+        target: ProjectManager
+        enabled: examplesScreen.StackView.status === StackView.Active
+        function onListingChanged(dirPath) {
+            if (dirPath === ProjectManager.projectsPath())
+                listView.model = ProjectManager.projects()
+        }
+    }
+
     CListView {
         id: listView
         anchors.left: parent.left
@@ -47,6 +57,7 @@ BlankScreen {
         delegate: CFileButton {
             text: modelData
             isDir: true
+            removeButtonVisible: !ProjectManager.readOnly
 
             onClicked: {
                 while (rightView.depth > 1) {
@@ -68,7 +79,6 @@ BlankScreen {
                     if (value)
                     {
                         ProjectManager.removeProject(modelData)
-                        listView.model = ProjectManager.projects()
                     }
                 }
 
@@ -108,7 +118,6 @@ BlankScreen {
                         if (value)
                         {
                             ProjectManager.restoreExamples()
-                            listView.model = ProjectManager.projects()
                         }
                     }
 
@@ -53,6 +53,16 @@ BlankScreen {
     }
 
 
+    // deletions, moves and imports finish in the background
+    Connections {
+        target: ProjectManager
+        enabled: projectsScreen.StackView.status === StackView.Active
+        function onListingChanged(dirPath) {
+            if (dirPath === ProjectManager.currentDirPath())
+                listView.model = ProjectManager.files()
+        }
+    }
+
     CListView {
         id: listView
         anchors.left: parent.left
@@ -63,7 +73,7 @@ BlankScreen {
 
         delegate: CFileButton {
             text: modelData.name
-            removeButtonVisible: modelData.name !== "main.qml"
+            removeButtonVisible: modelData.name !== "main.qml" && !ProjectManager.readOnly
             isDir: modelData.isDir
 
             onClicked: {
@@ -80,16 +90,32 @@ BlankScreen {
                                                               });
                     leftView.push(newScreen)
                 } else {
-                    newScreen =
-                            editorScreenComponent.createObject(rightView,
-                                                               {
-                                                                   fileName : modelData.name,
-                                                               });
+                    var filePath = ProjectManager.filePath(modelData.name)
+                    newScreen = documentManager.editor(filePath)
+                    if (!newScreen) {
+                        newScreen =
+                                editorScreenComponent.createObject(rightView,
+                                                                   {
+                                                                       fileName : modelData.name,
+                                                                       subDir : subPath,
+                                                                       filePath : filePath
+                                                                   });
+                        documentManager.insert(filePath, newScreen)
+                    }
                     rightView.push(newScreen)
                 }
 
             }
 
+            onPressAndHold: {
+                if (modelData.name === "main.qml" || ProjectManager.readOnly)
+                    return
+
+                fileMenu.fileName = modelData.name
+                fileMenu.y = mapToItem(projectsScreen, 0, height).y
+                fileMenu.open()
+            }
+
             onRemoveClicked: {
                 var parameters = {
                     title: qsTr("Delete the file"),
@@ -100,8 +126,8 @@ BlankScreen {
                 {
                     if (value)
                     {
+                        documentManager.remove(ProjectManager.filePath(modelData.name))
                         ProjectManager.removeFile(modelData.name)
-                        listView.model = ProjectManager.files()
                     }
                 }
 
@@ -128,6 +154,7 @@ BlankScreen {
 
             CToolButton {
                 Layout.fillHeight: true
+                visible: !ProjectManager.readOnly
                 icon: "\uf067"
                 tooltipText: qsTr("New...")
                 onClicked: newContextMenu.open()
@@ -135,6 +162,70 @@ BlankScreen {
         }
     }
 
+    ListModel {
+        id: choicesModel
+    }
+
+    Menu {
+        id: fileMenu
+        x: parent.width - width
+
+        property string fileName
+
+        MenuItem {
+            text: qsTr("Rename...")
+            onTriggered: {
+                var fileName = fileMenu.fileName
+                var parameters = {
+                    title: qsTr("Rename \"%1\"").arg(fileName),
+                    name: fileName
+                }
+
+                var callback = function(value)
+                {
+                    ProjectManager.moveFile(fileName, value)
+                }
+
+                dialog.open(dialog.types.rename, parameters, callback)
+            }
+        }
+
+        MenuItem {
+            text: qsTr("Move to...")
+            onTriggered: {
+                var fileName = fileMenu.fileName
+
+                // the directories next to it, and the one above
+                choicesModel.clear()
+                if (subPath !== "")
+                    choicesModel.append({ name: "..", path: ".." })
+                ProjectManager.files().forEach(function(file) {
+                    if (file.isDir && file.name !== fileName)
+                        choicesModel.append({ name: file.name, path: file.name })
+                })
+
+                if (choicesModel.count === 0)
+                {
+                    tooltip.show(qsTr("No directory to move \"%1\" to").arg(fileName))
+                    return
+                }
+
+                var parameters = {
+                    title: qsTr("Move \"%1\" to").arg(fileName),
+                    model: choicesModel,
+                    currentIndex: -1
+                }
+
+                var callback = function(value)
+                {
+                    ProjectManager.moveFile(fileName, choicesModel.get(value).path + "/" + fileName)
+                }
+
+                dialog.open(dialog.types.list, parameters, callback)
+            }
+        }
+    }
+
     Menu {
         id: newContextMenu
         x: parent.width - width
@@ -172,6 +263,36 @@ BlankScreen {
                 dialog.open(dialog.types.newDir, parameters, callback)
             }
         }
+
+        MenuItem {
+            text: qsTr("Import file...")
+            onTriggered: {
+                var files = ProjectManager.importableFiles()
+                if (files.length === 0)
+                {
+                    tooltip.show(qsTr("No QML or JavaScript files in %1").arg(ProjectManager.archivesPath()))
+                    return
+                }
+
+                choicesModel.clear()
+                files.forEach(function(file) {
+                    choicesModel.append({ name: file, path: ProjectManager.archivesPath() + "/" + file })
+                })
+
+                var parameters = {
+                    title: qsTr("Import a file"),
+                    model: choicesModel,
+                    currentIndex: -1
+                }
+
+                var callback = function(value)
+                {
+                    ProjectManager.importFile(choicesModel.get(value).path)
+                }
+
+                dialog.open(dialog.types.list, parameters, callback)
+            }
+        }
     }
 
     FastBlur {
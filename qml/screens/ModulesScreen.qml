@@ -19,6 +19,7 @@
 import QtQuick 2.5
 import QtQuick.Controls 2.0
 import QtGraphicalEffects 1.0
+import ModuleProbe 1.1
 import "../components"
 
 BlankScreen {
@@ -30,38 +31,38 @@ BlankScreen {
     ListModel {
         id: modules
 
-        ListElement { module: "QtQml";                   version: ""; status: 0; testComponent: "Qml.qml" }
-        ListElement { module: "QtQuick";                 version: ""; status: 0; testComponent: "Quick.qml" }
-        ListElement { module: "QtQuick.Controls";        version: ""; status: 0; testComponent: "Controls.qml" }
-        ListElement { module: "QtQuick.Controls.Styles"; version: ""; status: 0; testComponent: "Styles.qml" }
-        ListElement { module: "QtQuick.Layouts";         version: ""; status: 0; testComponent: "Layouts.qml" }
-        ListElement { module: "QtQml.Models";            version: ""; status: 0; testComponent: "Models.qml" }
-        ListElement { module: "QtQuick.XmlListModel";    version: ""; status: 0; testComponent: "XmlListModel.qml" }
-        ListElement { module: "QtQuick.LocalStorage";    version: ""; status: 0; testComponent: "LocalStorage.qml" }
-        ListElement { module: "QtQuick.Particles";       version: ""; status: 0; testComponent: "Particles.qml" }
-        ListElement { module: "QtQuick.Window";          version: ""; status: 0; testComponent: "Window.qml" }
-        ListElement { module: "QtQuick.Dialogs";         version: ""; status: 0; testComponent: "Dialogs.qml" }
-        ListElement { module: "QtQuick.Extras";          version: ""; status: 0; testComponent: "Extras.qml" }
-        ListElement { module: "QtTest";                  version: ""; status: 0; testComponent: "Test.qml" }
-        ListElement { module: "QtGraphicalEffects";      version: ""; status: 0; testComponent: "GraphicalEffects.qml" }
-        ListElement { module: "QtSensors";               version: ""; status: 0; testComponent: "Sensors.qml" }
-        ListElement { module: "QtMultimedia";            version: ""; status: 0; testComponent: "Multimedia.qml" }
-        ListElement { module: "QtAudioEngine";           version: ""; status: 0; testComponent: "AudioEngine.qml" }
-        ListElement { module: "QtPositioning";           version: ""; status: 0; testComponent: "Positioning.qml" }
-        ListElement { module: "QtBluetooth";             version: ""; status: 0; testComponent: "Bluetooth.qml" }
-        ListElement { module: "QtNfc";                   version: ""; status: 0; testComponent: "Nfc.qml" }
-        ListElement { module: "QtWebSockets";            version: ""; status: 0; testComponent: "WebSockets.qml" }
-        ListElement { module: "QtWebView";               version: ""; status: 0; testComponent: "WebView.qml" }
-
-        ListElement { module: "Qt3D.Core";               version: ""; status: 0; testComponent: "3D.qml" }
-        ListElement { module: "Qt3D.Input";              version: ""; status: 0; testComponent: "3DInput.qml" }
-        ListElement { module: "Qt3D.Render";             version: ""; status: 0; testComponent: "3DRenderer.qml" }
-        ListElement { module: "QtQuick.Scene3D";         version: ""; status: 0; testComponent: "Scene3D.qml" }
-
-        ListElement { module: "QtCanvas3D";              version: ""; status: 0; testComponent: "Canvas3D.qml" }
-        ListElement { module: "QtLocation";              version: ""; status: 0; testComponent: "Location.qml" }
-        ListElement { module: "Qt.labs.folderlistmodel"; version: ""; status: 0; testComponent: "FolderListModel.qml" }
-        ListElement { module: "Qt.labs.settings";        version: ""; status: 0; testComponent: "Settings.qml" }
+        ListElement { module: "QtQml";                   version: "2.2"; status: 0; foundVersion: "" }
+        ListElement { module: "QtQuick";                 version: "2.5"; status: 0; foundVersion: "" }
+        ListElement { module: "QtQuick.Controls";        version: "2.0"; status: 0; foundVersion: "" }
+        ListElement { module: "QtQuick.Controls.Styles"; version: "1.4"; status: 0; foundVersion: "" }
+        ListElement { module: "QtQuick.Layouts";         version: "1.2"; status: 0; foundVersion: "" }
+        ListElement { module: "QtQml.Models";            version: "2.2"; status: 0; foundVersion: "" }
+        ListElement { module: "QtQuick.XmlListModel";    version: "2.0"; status: 0; foundVersion: "" }
+        ListElement { module: "QtQuick.LocalStorage";    version: "2.0"; status: 0; foundVersion: "" }
+        ListElement { module: "QtQuick.Particles";       version: "2.0"; status: 0; foundVersion: "" }
+        ListElement { module: "QtQuick.Window";          version: "2.2"; status: 0; foundVersion: "" }
+        ListElement { module: "QtQuick.Dialogs";         version: "1.2"; status: 0; foundVersion: "" }
+        ListElement { module: "QtQuick.Extras";          version: "1.4"; status: 0; foundVersion: "" }
+        ListElement { module: "QtTest";                  version: "1.1"; status: 0; foundVersion: "" }
+        ListElement { module: "QtGraphicalEffects";      version: "1.0"; status: 0; foundVersion: "" }
+        ListElement { module: "QtSensors";               version: "5.4"; status: 0; foundVersion: "" }
+        ListElement { module: "QtMultimedia";            version: "5.5"; status: 0; foundVersion: "" }
+        ListElement { module: "QtAudioEngine";           version: "1.0"; status: 0; foundVersion: "" }
+        ListElement { module: "QtPositioning";           version: "5.2"; status: 0; foundVersion: "" }
+        ListElement { module: "QtBluetooth";             version: "5.2"; status: 0; foundVersion: "" }
+        ListElement { module: "QtNfc";                   version: "5.2"; status: 0; foundVersion: "" }
+        ListElement { module: "QtWebSockets";            version: "1.0"; status: 0; foundVersion: "" }
+        ListElement { module: "QtWebView";               version: "1.0"; status: 0; foundVersion: "" }
+
+        ListElement { module: "Qt3D.Core";               version: "2.0"; status: 0; foundVersion: "" }
+        ListElement { module: "Qt3D.Input";              version: "2.0"; status: 0; foundVersion: "" }
+        ListElement { module: "Qt3D.Render";             version: "2.0"; status: 0; foundVersion: "" }
+        ListElement { module: "QtQuick.Scene3D";         version: "2.0"; status: 0; foundVersion: "" }
+
+        ListElement { module: "QtCanvas3D";              version: "1.0"; status: 0; foundVersion: "" }
+        ListElement { module: "QtLocation";              version: "5.3"; status: 0; foundVersion: "" }
+        ListElement { module: "Qt.labs.folderlistmodel"; version: "2.0"; status: 0; foundVersion: "" }
+        ListElement { module: "Qt.labs.settings";        version: "1.0"; status: 0; foundVersion: "" }
     }
 
     ListView {
@@ -78,6 +79,8 @@ BlankScreen {
             text: module + " " + version
             description: if (status === 1)
                              qsTr("Available")
+                         else if (status === 2 && foundVersion !== "")
+                             qsTr("Not available, %1 installed").arg(foundVersion)
                          else if (status === 2)
                              qsTr("Not available")
                          else
@@ -122,32 +125,26 @@ BlankScreen {
         flickableItem: listView
     }
 
-    property int moduleId: 0
-
-    Loader {
-        id: loader
-        asynchronous: true
-        onStatusChanged: {
-            if (status === Loader.Ready || status === Loader.Error)
+    ModuleProbe {
+        id: moduleProbe
+        onProbed: {
+            for (var i = 0; i < modules.count; i++)
             {
-                var module = modules.get(moduleId)
-
-                if (status === Loader.Ready)
-                {
-                    module.status = 1
-                    module.version = item.version
-                }
-                else
+                var entry = modules.get(i)
+                if (entry.module === module)
                 {
-                    module.status = 2
+                    entry.status = available ? 1 : 2
+                    entry.foundVersion = version
+                    break
                 }
-
-                if (++moduleId < modules.count)
-                    loader.source = "../modules/" + modules.get(moduleId).testComponent
             }
         }
     }
 
-    Component.onCompleted:
-        loader.source = "../modules/" + modules.get(0).testComponent
+    Component.onCompleted: {
+        var requests = []
+        for (var i = 0; i < modules.count; i++)
+            requests.push({ module: modules.get(i).module, version: modules.get(i).version })
+        moduleProbe.probe(requests)
+    }
 }
@@ -17,14 +17,19 @@
 ****************************************************************************/
 
 import QtQuick 2.5
+import QtQuick.Controls 2.0
 import QtQuick.Layouts 1.2
 import ProjectManager 1.1
+import SuspendController 1.1
 import "../components"
 
 BlankScreen {
     id: playgroundScreen
     enabled: true
 
+    // paused from the toolbar, until resumed there
+    property bool userPaused: false
+
     CToolBar {
         id: toolBar
         anchors.left: parent.left
@@ -43,6 +48,16 @@ BlankScreen {
                 text: ProjectManager.fileName
             }
 
+            CToolButton {
+                Layout.fillHeight: true
+                icon: playgroundScreen.userPaused ? "\uf04b" : "\uf04c"
+                tooltipText: playgroundScreen.userPaused ? qsTr("Resume") : qsTr("Pause")
+                checked: playgroundScreen.userPaused
+                onClicked: {
+                    playgroundScreen.userPaused = !playgroundScreen.userPaused
+                }
+            }
+
             CToolButton {
                 Layout.fillHeight: true
                 icon: "\uf188"
@@ -100,6 +115,38 @@ BlankScreen {
         }
     }
 
+    // Animations and timers of the content stop while nobody can see it:
+    // another page covers the playground, the window is hidden or the app
+    // is in the background. They pick up again once it is back in view.
+    SuspendController {
+        id: suspendController
+        target: playArea
+        suspended: playgroundScreen.userPaused || !playgroundScreen.visible ||
+                   playgroundScreen.StackView.status === StackView.Inactive ||
+                   Qt.application.state !== Qt.ApplicationActive
+    }
+
+    // With a frame rate set in the settings the content is drawn into a
+    // texture that is only updated that often, the editor next to it in
+    // dual view keeps the rest of the frame. The content still animates
+    // every frame, it is only rendered less often.
+    ShaderEffectSource {
+        id: frameLimiter
+        anchors.fill: playArea
+        sourceItem: settings.playgroundFrameRate > 0 ? playArea : null
+        visible: sourceItem !== null
+        hideSource: true
+        live: false
+    }
+
+    Timer {
+        interval: 1000 / Math.max(1, settings.playgroundFrameRate)
+        repeat: true
+        triggeredOnStart: true
+        running: frameLimiter.visible && !suspendController.suspended
+        onTriggered: frameLimiter.scheduleUpdate()
+    }
+
     Component.onCompleted: {
         var componentUrl = ProjectManager.getFilePath()
         var playComponent = Qt.createComponent(componentUrl, Component.PreferSynchronous, playgroundScreen)
@@ -110,6 +157,8 @@ BlankScreen {
         else
         {
             playComponent.createObject(playArea)
+            // created after the pushed page was already counted as covered
+            suspendController.refresh()
         }
     }
 }
@@ -35,6 +35,20 @@ BlankScreen {
         listView.model = ProjectManager.projects()
     }
 
+    ListModel {
+        id: archivesModel
+    }
+
+    // deletions, copies and imports finish in the background
+    Connections {
+        target: ProjectManager
+        enabled: projectsScreen.StackView.status === StackView.Active
+        function onListingChanged(dirPath) {
+            if (dirPath === ProjectManager.projectsPath())
+                listView.model = ProjectManager.projects()
+        }
+    }
+
     CListView {
         id: listView
         anchors.left: parent.left
@@ -51,6 +65,11 @@ BlankScreen {
                 ProjectManager.projectName = modelData
                 leftView.push(Qt.resolvedUrl("FilesScreen.qml"))
             }
+            onPressAndHold: {
+                projectMenu.projectName = modelData
+                projectMenu.y = mapToItem(projectsScreen, 0, height).y
+                projectMenu.open()
+            }
             onRemoveClicked: {
                 var parameters = {
                     title: qsTr("Delete the project"),
@@ -62,7 +81,6 @@ BlankScreen {
                     if (value)
                     {
                         ProjectManager.removeProject(modelData)
-                        listView.model = ProjectManager.projects()
                     }
                 }
 
@@ -71,6 +89,49 @@ BlankScreen {
         }
     }
 
+    Menu {
+        id: projectMenu
+        x: parent.width - width
+
+        property string projectName
+
+        MenuItem {
+            text: qsTr("Duplicate...")
+            onTriggered: {
+                var projectName = projectMenu.projectName
+                var parameters = {
+                    title: qsTr("Duplicate \"%1\"").arg(projectName)
+                }
+
+                var callback = function(value)
+                {
+                    ProjectManager.duplicateProject(projectName, value)
+                }
+
+                dialog.open(dialog.types.newProject, parameters, callback)
+            }
+        }
+
+        MenuItem {
+            text: qsTr("Export...")
+            onTriggered: {
+                var projectName = projectMenu.projectName
+                var parameters = {
+                    title: qsTr("Export the project"),
+                    text: qsTr("Write \"%1\" to an archive in %2?").arg(projectName).arg(ProjectManager.archivesPath())
+                }
+
+                var callback = function(value)
+                {
+                    if (value)
+                        ProjectManager.exportProject(projectName)
+                }
+
+                dialog.open(dialog.types.confirmation, parameters, callback)
+            }
+        }
+    }
+
     CToolBar {
         id: toolBar
         anchors.left: parent.left
@@ -87,6 +148,38 @@ BlankScreen {
                 text: qsTr("Projects")
             }
 
+            CToolButton {
+                Layout.fillHeight: true
+                icon: "\uf019"
+                tooltipText: qsTr("Import a project")
+                onClicked: {
+                    var archives = ProjectManager.archives()
+                    if (archives.length === 0)
+                    {
+                        tooltip.show(qsTr("No archives in %1").arg(ProjectManager.archivesPath()))
+                        return
+                    }
+
+                    archivesModel.clear()
+                    archives.forEach(function(archive) {
+                        archivesModel.append({ name: archive })
+                    })
+
+                    var parameters = {
+                        title: qsTr("Import a project"),
+                        model: archivesModel,
+                        currentIndex: -1
+                    }
+
+                    var callback = function(value)
+                    {
+                        ProjectManager.importProject(archivesModel.get(value).name)
+                    }
+
+                    dialog.open(dialog.types.list, parameters, callback)
+                }
+            }
+
             CToolButton {
                 Layout.fillHeight: true
                 icon: "\uf067"
@@ -119,6 +119,24 @@ BlankScreen {
                 }
             }
 
+            CSettingButton {
+                text: qsTr("Keep undo history")
+                description: settings.persistentUndo ? qsTr("Enabled") : qsTr("Disabled")
+
+                onClicked: {
+                    settings.persistentUndo = !settings.persistentUndo
+                }
+            }
+
+            CSettingButton {
+                text: qsTr("Input latency tracing")
+                description: settings.latencyTracing ? qsTr("Enabled") : qsTr("Disabled")
+
+                onClicked: {
+                    settings.latencyTracing = !settings.latencyTracing
+                }
+            }
+
             CSettingButton {
                 text: qsTr("Palette")
                 description: settings.palette
@@ -136,6 +154,24 @@ BlankScreen {
                     dialog.open(dialog.types.list, parameters, callback)
                 }
             }
+
+            CSettingButton {
+                text: qsTr("Playground frame rate")
+                description: frameRates.get(frameRates.getCurrentIndex()).name
+                onClicked: {
+                    var parameters = {
+                        title: qsTr("Playground frame rate"),
+                        model: frameRates,
+                        currentIndex: frameRates.getCurrentIndex()
+                    }
+
+                    var callback = function(value) {
+                        settings.playgroundFrameRate = frameRates.get(value).value
+                    }
+
+                    dialog.open(dialog.types.list, parameters, callback)
+                }
+            }
         }
     }
 
@@ -198,4 +234,34 @@ BlankScreen {
             return -1;
         }
     }
+
+    // how often the playground redraws its content, 0 is every frame
+    ListModel {
+        id: frameRates
+
+        ListElement {
+            name: qsTr("Unlimited")
+            value: 0
+        }
+
+        ListElement {
+            name: qsTr("30 fps")
+            value: 30
+        }
+
+        ListElement {
+            name: qsTr("15 fps")
+            value: 15
+        }
+
+        function getCurrentIndex() {
+            for (var i = 0; i < count; i++)
+            {
+                if (get(i).value === settings.playgroundFrameRate)
+                    return i;
+            }
+
+            return 0;
+        }
+    }
 }
@@ -1,5 +1,6 @@
 QT += \
     core gui qml quick \
+    concurrent \
     multimedia sql \
     network websockets \
     xml svg
@@ -13,13 +14,64 @@ CONFIG += mobility
 MOBILITY =
 
 RESOURCES += \
-    qmlcreator_resources.qrc
+    qmlcreator_resources.qrc \
+    qmlcreator_sources.qrc
+
+# Compile the app's own QML/JS ahead of time, pass CONFIG+=noaot to fall
+# back to runtime compilation. Examples and file templates are copied to
+# disk as text, so their resource file keeps the sources.
+!noaot {
+    CONFIG += qtquickcompiler
+    QTQUICK_COMPILER_SKIPPED_RESOURCES += qmlcreator_sources.qrc
+    DEFINES += QMLCREATOR_AOT
+}
+
+# "make qmlcache" compiles every app QML/JS file on its own and stops at
+# the first one that cannot be compiled ahead of time
+APP_QML_FILES = \
+    $$files($$PWD/qml/*.qml) \
+    $$files($$PWD/qml/components/*.qml) \
+    $$files($$PWD/qml/components/dialogs/*.qml) \
+    $$files($$PWD/qml/components/palettes/*.qml) \
+    $$files($$PWD/qml/screens/*.qml)
+
+qmlcache.commands = $$sprintf($$QMAKE_MKDIR_CMD, $$shell_path($$OUT_PWD/qmlcache)) $$escape_expand(\n\t)
+for(qmlFile, APP_QML_FILES) {
+    qmlcache.commands += $$shell_path($$[QT_HOST_BINS]/qmlcachegen) \
+        -o $$shell_path($$OUT_PWD/qmlcache/$$basename(qmlFile)c) \
+        $$shell_path($$qmlFile) $$escape_expand(\n\t)
+}
+QMAKE_EXTRA_TARGETS += qmlcache
 
 HEADERS += \
+    cpp/BlockData.h \
+    cpp/BracketIndex.h \
+    cpp/CodeFolding.h \
+    cpp/CodeFormatter.h \
+    cpp/CodeView.h \
+    cpp/CompletionModel.h \
+    cpp/DiagnosticsModel.h \
+    cpp/DocumentManager.h \
+    cpp/FileJobQueue.h \
+    cpp/FileSystem.h \
+    cpp/ProjectArchive.h \
     cpp/ProjectManager.h \
     cpp/QMLHighlighter.h \
     cpp/SyntaxHighlighter.h \
+    cpp/EditHistory.h \
+    cpp/HighlightCache.h \
+    cpp/Language.h \
+    cpp/LatencyTracer.h \
+    cpp/LineChanges.h \
+    cpp/MappedFile.h \
     cpp/MessageHandler.h \
+    cpp/Minimap.h \
+    cpp/ModuleProbe.h \
+    cpp/OutlineModel.h \
+    cpp/PieceTable.h \
+    cpp/StartupTimeline.h \
+    cpp/SuspendController.h \
+    cpp/TextBuffer.h \
     cpp/components/linenumbershelper.h \
     cpp/imeventfixer.h \
     cpp/imfixerinstaller.h
@@ -29,17 +81,39 @@ SOURCES += \
     cpp/imeventfixer.cpp \
     cpp/imfixerinstaller.cpp \
     cpp/main.cpp \
+    cpp/BracketIndex.cpp \
+    cpp/CodeFolding.cpp \
+    cpp/CodeFormatter.cpp \
+    cpp/CodeView.cpp \
+    cpp/CompletionModel.cpp \
+    cpp/DiagnosticsModel.cpp \
+    cpp/DocumentManager.cpp \
+    cpp/FileJobQueue.cpp \
+    cpp/FileSystem.cpp \
+    cpp/ProjectArchive.cpp \
     cpp/ProjectManager.cpp \
     cpp/QMLHighlighter.cpp \
     cpp/SyntaxHighlighter.cpp \
-    cpp/MessageHandler.cpp
+    cpp/EditHistory.cpp \
+    cpp/HighlightCache.cpp \
+    cpp/Language.cpp \
+    cpp/LatencyTracer.cpp \
+    cpp/LineChanges.cpp \
+    cpp/MappedFile.cpp \
+    cpp/MessageHandler.cpp \
+    cpp/Minimap.cpp \
+    cpp/ModuleProbe.cpp \
+    cpp/OutlineModel.cpp \
+    cpp/PieceTable.cpp \
+    cpp/StartupTimeline.cpp \
+    cpp/SuspendController.cpp \
+    cpp/TextBuffer.cpp
 
 lupdate_only {
 SOURCES += \
     qml/components/*.qml \
     qml/components/dialogs/*.qml \
     qml/components/palettes/*.qml \
-    qml/modules/*.qml \
     qml/screens/*.qml \
     qml/*.qml
 }
@@ -0,0 +1,15 @@
+QT += core gui qml quick
+
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+TARGET = examplebench
+TEMPLATE = app
+
+SOURCES += \
+    main.cpp
+
+# the examples and the images they use, as the app has them
+RESOURCES += \
+    ../../qmlcreator_resources.qrc \
+    ../../qmlcreator_sources.qrc
@@ -0,0 +1,280 @@
+// Loads every example the way PlaygroundScreen does (a component created
+// synchronously from its URL, then instantiated into an item filling the
+// window) and measures compile time, instantiation time, the change in
+// resident memory and the times of the first frames. Runs headless on the
+// offscreen platform with the software scene graph, or with OpenGL, which
+// is Mesa's llvmpipe on machines without a GPU. Writes JSON so that runs
+// before and after an engine or app change can be compared.
+//
+//   examplebench --frames 300 --output before.json
+//   examplebench --renderer opengl Particles "Shader Effect"
+//
+// Every example gets its own engine and window. Imports are cached per
+// process, so the first example using a module also pays for loading its
+// plugin; name it twice to measure it warm.
+
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QGuiApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QQmlComponent>
+#include <QQmlEngine>
+#include <QQuickItem>
+#include <QQuickWindow>
+#include <QSGRendererInterface>
+#include <QTextStream>
+#include <QTimer>
+#include <algorithm>
+
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#endif
+
+namespace {
+
+struct Options
+{
+    int frames = 120;
+    QSize size = QSize(720, 1280);
+    int timeout = 20000;
+};
+
+// -1 where it is not known
+qint64 residentKiB()
+{
+#ifdef Q_OS_LINUX
+    QFile statm("/proc/self/statm");
+    if (!statm.open(QIODevice::ReadOnly))
+        return -1;
+
+    const QList<QByteArray> fields = statm.readAll().split(' ');
+    if (fields.count() < 2)
+        return -1;
+    return fields.at(1).toLongLong() * (sysconf(_SC_PAGESIZE) / 1024);
+#else
+    return -1;
+#endif
+}
+
+double milliseconds(qint64 nanoseconds)
+{
+    return qRound64(nanoseconds / 1000.0) / 1000.0;
+}
+
+QJsonObject statistics(QVector<qint64> samples)
+{
+    QJsonObject statistics;
+    statistics["count"] = samples.count();
+    if (samples.isEmpty())
+        return statistics;
+
+    std::sort(samples.begin(), samples.end());
+    qint64 sum = 0;
+    for (qint64 sample : samples)
+        sum += sample;
+
+    statistics["mean"] = milliseconds(sum / samples.count());
+    statistics["median"] = milliseconds(samples.at(samples.count() / 2));
+    statistics["p95"] = milliseconds(samples.at(qMin(samples.count() - 1, samples.count() * 95 / 100)));
+    statistics["max"] = milliseconds(samples.last());
+    return statistics;
+}
+
+QJsonArray errorList(const QList<QQmlError> &errors)
+{
+    QJsonArray list;
+    for (const QQmlError &error : errors)
+        list.append(error.toString());
+    return list;
+}
+
+QJsonObject measure(const QString &name, const QUrl &url, const Options &options)
+{
+    QJsonObject result;
+    result["name"] = name;
+
+    QQmlEngine engine;
+    QQuickWindow window;
+    window.resize(options.size);
+
+    // PlaygroundScreen's playArea
+    QQuickItem *playArea = new QQuickItem(window.contentItem());
+    playArea->setSize(options.size);
+
+    const qint64 memoryBefore = residentKiB();
+    QElapsedTimer timer;
+    timer.start();
+
+    QQmlComponent component(&engine, url, QQmlComponent::PreferSynchronous);
+    if (component.isLoading())
+    {
+        QEventLoop loop;
+        QObject::connect(&component, &QQmlComponent::statusChanged, &loop, &QEventLoop::quit);
+        loop.exec();
+    }
+    result["compileMs"] = milliseconds(timer.nsecsElapsed());
+    if (component.isError())
+    {
+        result["errors"] = errorList(component.errors());
+        return result;
+    }
+
+    // createObject(playArea) sets the parent before bindings are completed
+    timer.restart();
+    QObject *object = component.beginCreate(engine.rootContext());
+    if (QQuickItem *item = qobject_cast<QQuickItem*>(object))
+        item->setParentItem(playArea);
+    component.completeCreate();
+    result["createMs"] = milliseconds(timer.nsecsElapsed());
+    if (!object)
+    {
+        result["errors"] = errorList(component.errors());
+        return result;
+    }
+
+    // examples with a Window of their own render in that one
+    QQuickWindow *target = qobject_cast<QQuickWindow*>(object);
+    if (!target)
+        target = &window;
+
+    // interval is swap to swap, render is synchronizing to swap
+    QVector<qint64> intervals;
+    QVector<qint64> renders;
+    QElapsedTimer frameTimer;
+    QElapsedTimer renderTimer;
+    QEventLoop loop;
+    QObject::connect(target, &QQuickWindow::beforeSynchronizing, &loop, [&renderTimer]() {
+        renderTimer.start();
+    }, Qt::DirectConnection);
+    QObject::connect(target, &QQuickWindow::frameSwapped, &loop, [&]() {
+        if (renderTimer.isValid())
+            renders += renderTimer.nsecsElapsed();
+        if (frameTimer.isValid())
+            intervals += frameTimer.nsecsElapsed();
+        frameTimer.start();
+
+        if (intervals.count() >= options.frames)
+            loop.quit();
+        else
+            target->update();
+    }, Qt::DirectConnection);
+    QTimer::singleShot(options.timeout, &loop, &QEventLoop::quit);
+
+    target->show();
+    target->update();
+    loop.exec();
+    target->hide();
+
+    result["frameIntervalMs"] = statistics(intervals);
+    result["frameRenderMs"] = statistics(renders);
+    if (intervals.count() < options.frames)
+        result["timedOut"] = true;
+
+    const qint64 memoryAfter = residentKiB();
+    if (memoryBefore >= 0 && memoryAfter >= 0)
+        result["memoryDeltaKiB"] = memoryAfter - memoryBefore;
+
+    delete object;
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    // headless unless asked otherwise, everything on the GUI thread so the
+    // frame timings do not depend on thread scheduling
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    if (qEnvironmentVariableIsEmpty("QSG_RENDER_LOOP"))
+        qputenv("QSG_RENDER_LOOP", "basic");
+
+    QGuiApplication app(argc, argv);
+    QCoreApplication::setApplicationName("examplebench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Measures how the QML Creator examples load and render.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("examples", "Examples to run, all of them if none are given.", "[examples...]");
+    QCommandLineOption framesOption("frames", "Frames to render of every example.", "count", "120");
+    QCommandLineOption sizeOption("size", "Window size.", "WIDTHxHEIGHT", "720x1280");
+    QCommandLineOption rendererOption("renderer", "Scene graph backend, software or opengl.", "renderer", "software");
+    QCommandLineOption timeoutOption("timeout", "Milliseconds to wait for the frames of one example.", "ms", "20000");
+    QCommandLineOption examplesOption("examples", "Directory to load the examples from instead of the resources.", "path");
+    QCommandLineOption outputOption("output", "File to write the JSON to instead of the standard output.", "file");
+    parser.addOptions({ framesOption, sizeOption, rendererOption, timeoutOption, examplesOption, outputOption });
+    parser.process(app);
+
+    Options options;
+    options.frames = qMax(1, parser.value(framesOption).toInt());
+    options.timeout = qMax(1, parser.value(timeoutOption).toInt());
+    const QStringList size = parser.value(sizeOption).split('x');
+    if (size.count() == 2 && size.at(0).toInt() > 0 && size.at(1).toInt() > 0)
+        options.size = QSize(size.at(0).toInt(), size.at(1).toInt());
+
+    const QString renderer = parser.value(rendererOption);
+    if (renderer == "opengl")
+    {
+        QQuickWindow::setSceneGraphBackend(QSGRendererInterface::OpenGL);
+    }
+    else if (renderer == "software")
+    {
+        QQuickWindow::setSceneGraphBackend(QSGRendererInterface::Software);
+    }
+    else
+    {
+        qCritical() << "Unknown renderer" << renderer;
+        return 1;
+    }
+
+    // the playground opens the examples from the resources until they are restored
+    const bool fromResources = !parser.isSet(examplesOption);
+    const QString examplesPath = fromResources ? QString(":/qml/examples") : parser.value(examplesOption);
+    QStringList names = parser.positionalArguments();
+    if (names.isEmpty())
+        names = QDir(examplesPath).entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
+
+    QJsonArray examples;
+    for (const QString &name : names)
+    {
+        const QString filePath = examplesPath + "/" + name + "/main.qml";
+        if (!QFile::exists(filePath))
+        {
+            qWarning() << "No example" << name;
+            continue;
+        }
+
+        const QUrl url = fromResources ? QUrl("qrc" + filePath) : QUrl::fromLocalFile(QDir(filePath).absolutePath());
+        qInfo().noquote() << "Measuring" << name;
+        examples.append(measure(name, url, options));
+    }
+
+    QJsonObject report;
+    report["qtVersion"] = QString(qVersion());
+    report["platform"] = QGuiApplication::platformName();
+    report["renderer"] = renderer;
+    report["frames"] = options.frames;
+    report["size"] = QString("%1x%2").arg(options.size.width()).arg(options.size.height());
+    report["examples"] = examples;
+    const QByteArray json = QJsonDocument(report).toJson();
+
+    if (!parser.isSet(outputOption))
+    {
+        QTextStream(stdout) << json;
+        return 0;
+    }
+
+    QFile output(parser.value(outputOption));
+    if (!output.open(QIODevice::WriteOnly) || output.write(json) != json.size())
+    {
+        qCritical() << "Unable to write" << output.fileName();
+        return 1;
+    }
+    return 0;
+}
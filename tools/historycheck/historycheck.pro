@@ -0,0 +1,20 @@
+QT += core gui quick
+
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+TARGET = historycheck
+TEMPLATE = app
+
+INCLUDEPATH += ../../cpp
+
+HEADERS += \
+    ../../cpp/EditHistory.h \
+    ../../cpp/PieceTable.h \
+    ../../cpp/TextBuffer.h
+
+SOURCES += \
+    main.cpp \
+    ../../cpp/EditHistory.cpp \
+    ../../cpp/PieceTable.cpp \
+    ../../cpp/TextBuffer.cpp
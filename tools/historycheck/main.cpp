@@ -0,0 +1,62 @@
+// Fills an EditHistory past its memory limit with edits that each make a
+// group of their own and checks that eviction only drops the oldest
+// groups: the history has to stay under the limit and keep most of the
+// groups that fit into it. Exits with 1 when it does not.
+//
+//   historycheck --limit 262144 --edits 20000 --length 40
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QTextStream>
+
+#include "EditHistory.h"
+#include "TextBuffer.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("historycheck");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Checks that the edit history evicts only its oldest groups.");
+    parser.addHelpOption();
+    QCommandLineOption limitOption("limit", "Memory limit of the history in bytes.", "bytes", "262144");
+    QCommandLineOption editsOption("edits", "Edits to record.", "count", "20000");
+    QCommandLineOption lengthOption("length", "Characters every edit replaces and inserts.", "count", "40");
+    parser.addOptions({ limitOption, editsOption, lengthOption });
+    parser.process(app);
+
+    const int limit = qMax(1, parser.value(limitOption).toInt());
+    const int edits = qMax(1, parser.value(editsOption).toInt());
+    const int length = qMax(1, parser.value(lengthOption).toInt());
+
+    // without a document the history only records, undo moves the index
+    TextBuffer buffer;
+    EditHistory *history = buffer.history();
+    history->setMemoryLimit(limit);
+
+    // replacements always close their group
+    const QString removed(length, 'a');
+    const QString added(length, 'b');
+    for (int i = 0; i < edits; i++)
+        history->record(i * length, removed, added);
+
+    const int usage = history->memoryUsage();
+    int groups = 0;
+    while (history->canUndo())
+    {
+        history->undo();
+        groups++;
+    }
+
+    // text of both sides plus a group and a record, eviction works in
+    // whole arena blocks so up to one of those may be gone on top
+    const int perGroup = 2 * length * int(sizeof(QChar)) + 64;
+    const int expected = qMin(edits, limit / perGroup);
+    const bool passed = usage <= limit && groups * 2 >= expected;
+
+    QTextStream(stdout) << "limit " << limit << " bytes, usage " << usage << " bytes, "
+                        << groups << " of " << edits << " groups kept, about "
+                        << expected << " fit: " << (passed ? "ok" : "FAILED") << '\n';
+    return passed ? 0 : 1;
+}
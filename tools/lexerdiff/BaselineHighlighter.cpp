@@ -0,0 +1,263 @@
+/****************************************************************************
+**
+** Copyright (C) 2013-2015 Oleg Yadrov
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+** http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+****************************************************************************/
+
+#include "BaselineHighlighter.h"
+#include <QFile>
+#include <QTextStream>
+
+bool BaselineHighlighter::m_cacheLoaded = false;
+QSet<QString> BaselineHighlighter::m_keywordsCache = QSet<QString>();
+QSet<QString> BaselineHighlighter::m_jsIdsCache = QSet<QString>();
+QSet<QString> BaselineHighlighter::m_qmlIdsCache = QSet<QString>();
+QSet<QString> BaselineHighlighter::m_propertiesCache = QSet<QString>();
+
+static Token::Keyword keywordOf(const QStringRef &word)
+{
+    if (word.length() > 2 && word.startsWith(QLatin1String("on")) && word.at(2).isUpper())
+        return Token::Handler;
+    if (word == QLatin1String("property"))
+        return Token::Property;
+    if (word == QLatin1String("signal"))
+        return Token::Signal;
+    if (word == QLatin1String("function"))
+        return Token::Function;
+    if (word == QLatin1String("id"))
+        return Token::Id;
+    if (word == QLatin1String("readonly"))
+        return Token::Readonly;
+    if (word == QLatin1String("default"))
+        return Token::Default;
+    if (word == QLatin1String("required"))
+        return Token::Required;
+    if (word == QLatin1String("import"))
+        return Token::Import;
+    if (word == QLatin1String("pragma"))
+        return Token::Pragma;
+    return Token::NoKeyword;
+}
+
+BaselineHighlighter::BaselineHighlighter(QTextDocument *parent) : QSyntaxHighlighter(parent)
+{
+    if (!m_cacheLoaded) {
+        loadDictionary(":/resources/dictionaries/keywords.txt", m_keywordsCache);
+        loadDictionary(":/resources/dictionaries/javascript.txt", m_jsIdsCache);
+        loadDictionary(":/resources/dictionaries/qml.txt", m_qmlIdsCache);
+        loadDictionary(":/resources/dictionaries/properties.txt", m_propertiesCache);
+        m_cacheLoaded = true;
+    }
+}
+
+void BaselineHighlighter::setColor(ColorComponent component, const QColor &color)
+{
+    m_colors[component] = color;
+}
+
+void BaselineHighlighter::highlightBlock(const QString &text)
+{
+    enum {
+        StartState = 0,
+        NumberState = 1,
+        IdentifierState = 2,
+        StringState = 3,
+        CommentState = 4
+    };
+
+    int blockState = previousBlockState();
+    int bracketLevel = blockState >> 4;
+    int state = blockState & 15;
+    if (blockState < 0) {
+        bracketLevel = 0;
+        state = StartState;
+    }
+
+    // reuse the block's data, this runs for every block on each rehighlight
+    BlockData *blockData = static_cast<BlockData *>(currentBlockUserData());
+    if (!blockData) {
+        blockData = new BlockData;
+        setCurrentBlockUserData(blockData);
+    }
+
+    auto applyFormat = [this, blockData](int start, int count, ColorComponent component) {
+        setFormat(start, count, m_colors[component]);
+        blockData->spans += FormatSpan { start, count, static_cast<unsigned char>(component) };
+    };
+
+    blockData->brackets.clear();
+    blockData->tokens.clear();
+    blockData->spans.clear();
+    blockData->depthBefore = bracketLevel;
+    blockData->minDepth = bracketLevel;
+
+    int start = 0;
+    int i = 0;
+    while (i <= text.length()) {
+        QChar ch = (i < text.length()) ? text.at(i) : QChar();
+        QChar next = (i < text.length() - 1) ? text.at(i + 1) : QChar();
+
+        switch (state) {
+
+        case StartState:
+            start = i;
+            if (ch.isSpace()) {
+                ++i;
+            } else if (ch.isDigit()) {
+                ++i;
+                state = NumberState;
+            } else if (ch.isLetter() || ch == '_') {
+                ++i;
+                state = IdentifierState;
+            } else if (ch == '\'' || ch == '\"') {
+                ++i;
+                state = StringState;
+            } else if (ch == '/' && next == '*') {
+                ++i;
+                ++i;
+                state = CommentState;
+            } else if (ch == '/' && next == '/') {
+                i = text.length();
+                applyFormat(start, text.length(), Comment);
+            } else {
+                if (!QString("(){}[]").contains(ch))
+                    applyFormat(start, 1, Operator);
+                if (QString("(){}[]:;,.=").contains(ch))
+                    blockData->tokens += Token { i, 1, ch, Token::NoKeyword, false };
+                if (ch == '{') {
+                    bracketLevel++;
+                    blockData->brackets += Bracket { i, bracketLevel, true };
+                } else if (ch == '}') {
+                    blockData->brackets += Bracket { i, bracketLevel, false };
+                    bracketLevel--;
+                    blockData->minDepth = qMin(blockData->minDepth, bracketLevel);
+                }
+                ++i;
+                state = StartState;
+            }
+            break;
+
+        case NumberState:
+            if (ch.isSpace() || !ch.isDigit()) {
+                applyFormat(start, i - start, Number);
+                state = StartState;
+            } else {
+                ++i;
+            }
+            break;
+
+        case IdentifierState:
+            if (ch.isSpace() || !(ch.isDigit() || ch.isLetter() || ch == '_')) {
+                blockData->tokens += Token { start, i - start, QChar(),
+                                             keywordOf(text.midRef(start, i - start)),
+                                             text.at(start).isUpper() };
+                QString token = text.mid(start, i - start).trimmed();
+                if (m_keywordsCache.contains(token))
+                    applyFormat(start, i - start, Keyword);
+                else if (m_qmlIdsCache.contains(token) || m_qmlIds.contains(token))
+                    applyFormat(start, i - start, Item);
+                else if (m_propertiesCache.contains(token))
+                    applyFormat(start, i - start, Property);
+                else if (m_jsIdsCache.contains(token) || m_jsIds.contains(token))
+                    applyFormat(start, i - start, BuiltIn);
+                state = StartState;
+            } else {
+                ++i;
+            }
+            break;
+
+        case StringState:
+            if (ch == text.at(start)) {
+                QChar prev = (i > 0) ? text.at(i - 1) : QChar();
+                if (prev != '\\') {
+                    ++i;
+                    applyFormat(start, i - start, String);
+                    state = StartState;
+                } else {
+                    ++i;
+                }
+            } else {
+                ++i;
+            }
+            break;
+
+        case CommentState:
+            if (ch == '*' && next == '/') {
+                ++i;
+                ++i;
+                applyFormat(start, i - start, Comment);
+                state = StartState;
+            } else {
+                ++i;
+            }
+            break;
+
+        default:
+            state = StartState;
+            break;
+        }
+    }
+
+    if (state == CommentState)
+        applyFormat(start, text.length(), Comment);
+    else
+        state = StartState;
+
+    blockData->endsInComment = (state == CommentState);
+    blockData->foldOffset = -1;
+    int unclosed = 0;
+    foreach (const Bracket &bracket, blockData->brackets) {
+        if (bracket.opening) {
+            if (unclosed++ == 0)
+                blockData->foldOffset = bracket.offset;
+        } else if (unclosed > 0) {
+            unclosed--;
+        }
+    }
+    if (unclosed == 0)
+        blockData->foldOffset = -1;
+
+    blockState = (state & 15) | (bracketLevel << 4);
+    setCurrentBlockState(blockState);
+}
+
+void BaselineHighlighter::loadDictionary(QString filepath, QSet<QString> &dictionary) {
+    QFile file(filepath);
+    file.open(QIODevice::ReadOnly | QIODevice::Text);
+    QTextStream textStream(&file);
+    while (!textStream.atEnd()) {
+        dictionary<<textStream.readLine().trimmed();
+    }
+}
+
+void BaselineHighlighter::addQmlComponent(QString componentName)
+{
+    m_qmlIds<<componentName;
+}
+
+void BaselineHighlighter::addJsComponent(QString componentName)
+{
+    m_jsIds<<componentName;
+}
+
+int BaselineHighlighter::commentState(int blockState)
+{
+    return blockState & 15;
+}
+
+int BaselineHighlighter::bracketLevel(int blockState)
+{
+    return blockState >> 4;
+}
@@ -0,0 +1,77 @@
+/****************************************************************************
+**
+** Copyright (C) 2013-2015 Oleg Yadrov
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+** http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+****************************************************************************/
+
+#ifndef BASELINEHIGHLIGHTER_H
+#define BASELINEHIGHLIGHTER_H
+
+#include <QSet>
+#include <QSyntaxHighlighter>
+#include "BlockData.h"
+
+// QMLHighlighter's lexer as it was before the character class table
+// (9c3c2d0), the reference lexerdiff compares the current one with. The
+// lexing in highlightBlock is kept as it was; the highlight cache, the
+// marks and the error squiggles are left out, they do not depend on it.
+class BaselineHighlighter : public QSyntaxHighlighter
+{
+    Q_OBJECT
+
+public:
+    // the same values as QMLHighlighter::ColorComponent
+    enum ColorComponent {
+        Normal,
+        Comment,
+        Number,
+        String,
+        Operator,
+        Keyword,
+        BuiltIn,
+        Marker,
+        Item,
+        Property,
+        Error
+    };
+
+    BaselineHighlighter(QTextDocument *parent = 0);
+    void setColor(ColorComponent component, const QColor &color);
+    void addQmlComponent(QString componentName);
+    void addJsComponent(QString componentName);
+
+    // block states are the lexer state in the low 4 bits, the bracket
+    // level above them
+    static int commentState(int blockState);
+    static int bracketLevel(int blockState);
+
+protected:
+    void highlightBlock(const QString &text);
+
+private:
+    void loadDictionary(QString filepath, QSet<QString> &dictionary);
+    static bool m_cacheLoaded;
+    static QSet<QString> m_keywordsCache;
+    static QSet<QString> m_jsIdsCache;
+    static QSet<QString> m_qmlIdsCache;
+    static QSet<QString> m_propertiesCache;
+
+    QSet<QString> m_jsIds;
+    QSet<QString> m_qmlIds;
+
+    QHash<ColorComponent, QColor> m_colors;
+};
+
+#endif // BASELINEHIGHLIGHTER_H
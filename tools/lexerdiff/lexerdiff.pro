@@ -0,0 +1,31 @@
+QT += core gui quick
+
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+TARGET = lexerdiff
+TEMPLATE = app
+
+INCLUDEPATH += ../../cpp
+
+HEADERS += \
+    BaselineHighlighter.h \
+    ../../cpp/BlockData.h \
+    ../../cpp/BracketIndex.h \
+    ../../cpp/HighlightCache.h \
+    ../../cpp/Language.h \
+    ../../cpp/LatencyTracer.h \
+    ../../cpp/QMLHighlighter.h
+
+SOURCES += \
+    main.cpp \
+    BaselineHighlighter.cpp \
+    ../../cpp/BracketIndex.cpp \
+    ../../cpp/HighlightCache.cpp \
+    ../../cpp/Language.cpp \
+    ../../cpp/LatencyTracer.cpp \
+    ../../cpp/QMLHighlighter.cpp
+
+# the dictionaries both highlighters colour identifiers by
+RESOURCES += \
+    ../../qmlcreator_resources.qrc
@@ -0,0 +1,273 @@
+// Differential test of QMLHighlighter's lexer: highlights the same text
+// with the current QMLHighlighter and with the lexer it replaced
+// (BaselineHighlighter, the code before the character class table) and
+// compares, block by block, the colours set on the text, the spans kept
+// for the highlight cache, the state handed to the next block (open
+// comment and bracket level), the brackets, depthBefore, minDepth,
+// foldOffset and the tokens. Takes every .qml and .js file under the
+// given directories, lexed as QML like the baseline did, plus generated
+// documents. Exits with 1 when any of them differs.
+//
+//   lexerdiff --documents 200000 ../../qml
+//   lexerdiff --seed 7 --show 20 ../../qml
+//
+// Differences the rewrite made on purpose, left out of the comparison:
+//
+// - the baseline's loop also ran at the position one past the end of the
+//   text and coloured it as an operator. setFormat clips that away, so
+//   the colours on the text agree, but the baseline keeps a one character
+//   Operator span there. Spans are compared per character of the text.
+// - the baseline's span for a comment left open starts where the comment
+//   does and runs text.length() characters. Same treatment.
+// - adjacent spans of the same colour are merged now, again only the
+//   characters they cover count.
+// - the block state encoding is different since the lexers for other
+//   languages came in, the bracket level sits higher. The open comment
+//   and the level are compared, not the raw number.
+// - strings bound to an embedding property (fragmentShader and
+//   vertexShader in QML) are lexed as GLSL since then. A document is only
+//   compared up to the first block naming one of them.
+
+#include <QCommandLineParser>
+#include <QDirIterator>
+#include <QFile>
+#include <QGuiApplication>
+#include <QRandomGenerator>
+#include <QTextBlock>
+#include <QTextDocument>
+#include <QTextLayout>
+#include <QTextStream>
+
+#include "BaselineHighlighter.h"
+#include "QMLHighlighter.h"
+
+namespace {
+
+const int ComponentCount = QMLHighlighter::Error + 1;
+
+// a colour per component, so the formats tell which one was set
+QColor componentColor(int component)
+{
+    return QColor(component * 20 + 10, 255 - component * 20, 128);
+}
+
+template <typename Highlighter>
+void setUp(Highlighter *highlighter)
+{
+    for (int component = 0; component < ComponentCount; component++)
+        highlighter->setColor(typename Highlighter::ColorComponent(component), componentColor(component));
+    highlighter->addQmlComponent("CustomButton");
+    highlighter->addJsComponent("Utils");
+}
+
+// foreground colour per character of the block, 0 where none was set
+QVector<QRgb> visibleColors(const QTextBlock &block)
+{
+    QVector<QRgb> colors(block.length() - 1, 0);
+    foreach (const QTextLayout::FormatRange &range, block.layout()->formats()) {
+        const int end = qMin(range.start + range.length, colors.count());
+        for (int i = qMax(0, range.start); i < end; i++)
+            colors[i] = range.format.foreground().color().rgb();
+    }
+    return colors;
+}
+
+// component per character of text, -1 where no span covers it
+QVector<int> spanComponents(const QVector<FormatSpan> &spans, int length)
+{
+    QVector<int> components(length, -1);
+    foreach (const FormatSpan &span, spans) {
+        const int end = qMin(span.start + span.length, length);
+        for (int i = qMax(0, span.start); i < end; i++)
+            components[i] = span.component;
+    }
+    return components;
+}
+
+// the bracket level the block hands on
+int levelAfter(const BlockData *blockData)
+{
+    int level = blockData->depthBefore;
+    foreach (const Bracket &bracket, blockData->brackets)
+        level += bracket.opening ? 1 : -1;
+    return level;
+}
+
+bool sameBrackets(const QVector<Bracket> &a, const QVector<Bracket> &b)
+{
+    if (a.count() != b.count())
+        return false;
+    for (int i = 0; i < a.count(); i++) {
+        if (a[i].offset != b[i].offset || a[i].depth != b[i].depth || a[i].opening != b[i].opening)
+            return false;
+    }
+    return true;
+}
+
+bool sameTokens(const QVector<Token> &a, const QVector<Token> &b)
+{
+    if (a.count() != b.count())
+        return false;
+    for (int i = 0; i < a.count(); i++) {
+        if (a[i].offset != b[i].offset || a[i].length != b[i].length || a[i].symbol != b[i].symbol
+                || a[i].keyword != b[i].keyword || a[i].capitalized != b[i].capitalized)
+            return false;
+    }
+    return true;
+}
+
+bool namesEmbeddingProperty(const QString &text, const BlockData *blockData)
+{
+    foreach (const Token &token, blockData->tokens) {
+        if (token.isIdentifier() && Language::qml().embeds(text.midRef(token.offset, token.length)))
+            return true;
+    }
+    return false;
+}
+
+struct Result
+{
+    int documents = 0;
+    int blocks = 0;
+    int blocksLeftOut = 0;
+    int mismatches = 0;
+    QStringList reports;
+};
+
+// first difference of the block, empty if there is none
+QString difference(const QTextBlock &current, const QTextBlock &baseline)
+{
+    const BlockData *currentData = static_cast<const BlockData *>(current.userData());
+    const BlockData *baselineData = static_cast<const BlockData *>(baseline.userData());
+    const QString text = current.text();
+
+    if (visibleColors(current) != visibleColors(baseline))
+        return "colours";
+    if (spanComponents(currentData->spans, text.length()) != spanComponents(baselineData->spans, text.length()))
+        return "spans";
+    // a negative state, from more closing than opening brackets, makes
+    // both start the next block afresh
+    const int currentState = current.userState();
+    const int baselineState = baseline.userState();
+    if ((currentState < 0) != (baselineState < 0))
+        return "state";
+    if (currentState >= 0 && (QMLHighlighter::endsInLiteral(currentState)
+                              != (BaselineHighlighter::commentState(baselineState) == 4)))
+        return "open comment";
+    if (currentData->endsInComment != baselineData->endsInComment)
+        return "open comment";
+    if (currentState >= 0 && BaselineHighlighter::bracketLevel(baselineState) != levelAfter(currentData))
+        return "bracket level";
+    if (currentData->depthBefore != baselineData->depthBefore || currentData->minDepth != baselineData->minDepth)
+        return "depth";
+    if (!sameBrackets(currentData->brackets, baselineData->brackets))
+        return "brackets";
+    if (currentData->foldOffset != baselineData->foldOffset)
+        return "fold offset";
+    if (!sameTokens(currentData->tokens, baselineData->tokens))
+        return "tokens";
+    return QString();
+}
+
+void compare(const QString &name, const QString &text, Result &result, int show)
+{
+    QTextDocument currentDocument;
+    QTextDocument baselineDocument;
+    currentDocument.setPlainText(text);
+    baselineDocument.setPlainText(text);
+
+    // without an event loop the delayed first highlighting never runs
+    QMLHighlighter *current = new QMLHighlighter(&currentDocument);
+    BaselineHighlighter *baseline = new BaselineHighlighter(&baselineDocument);
+    setUp(current);
+    setUp(baseline);
+    current->rehighlight();
+    baseline->rehighlight();
+
+    result.documents++;
+    QTextBlock baselineBlock = baselineDocument.firstBlock();
+    for (QTextBlock block = currentDocument.firstBlock(); block.isValid();
+         block = block.next(), baselineBlock = baselineBlock.next()) {
+        if (namesEmbeddingProperty(block.text(), static_cast<const BlockData *>(block.userData()))) {
+            result.blocksLeftOut += currentDocument.blockCount() - block.blockNumber();
+            break;
+        }
+
+        result.blocks++;
+        const QString what = difference(block, baselineBlock);
+        if (what.isEmpty())
+            continue;
+
+        if (result.mismatches++ < show) {
+            result.reports += QString("%1:%2: %3 differ in \"%4\"")
+                    .arg(name).arg(block.blockNumber() + 1).arg(what, block.text());
+        }
+        break;
+    }
+}
+
+// Text made of pieces the lexer treats differently, mostly ASCII with
+// some letters, digits and spaces from outside it
+QString generate(QRandomGenerator &random)
+{
+    static const char *const pieces[] = {
+        "Item", "Rectangle", "CustomButton", "Utils", "Math", "property", "signal", "function",
+        "id", "readonly", "default", "required", "import", "pragma", "onClicked", "on", "width",
+        "color", "var", "x", "_y", "a1", "0", "42", "3.14", "0x1f", "\"", "'", "\\", "\\\"",
+        "\"text\"", "'c'", "/*", "*/", "/", "*", "//", "{", "}", "(", ")", "[", "]", ":", ";",
+        ",", ".", "=", "+", "-", "!", "?", "<", ">", "&", "|", "#", "$", "`", "@", " ", " ",
+        "  ", "\t", "\n", "\n", "\n    ", "été", "٣", "中", " ", " "
+    };
+    const int pieceCount = int(sizeof(pieces) / sizeof(pieces[0]));
+
+    QString text;
+    const int count = random.bounded(1, 200);
+    for (int i = 0; i < count; i++)
+        text += QString::fromUtf8(pieces[random.bounded(pieceCount)]);
+    return text;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QGuiApplication app(argc, argv);
+    QCoreApplication::setApplicationName("lexerdiff");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Compares QMLHighlighter's lexer with the lexer it replaced.");
+    parser.addHelpOption();
+    QCommandLineOption documentsOption("documents", "Generated documents to compare.", "count", "20000");
+    QCommandLineOption seedOption("seed", "Seed of the generated documents.", "number", "1");
+    QCommandLineOption showOption("show", "Mismatches to print.", "count", "10");
+    parser.addOptions({ documentsOption, seedOption, showOption });
+    parser.addPositionalArgument("directories", "Directories whose .qml and .js files are compared.", "[directories...]");
+    parser.process(app);
+
+    const int documents = qMax(0, parser.value(documentsOption).toInt());
+    const int show = qMax(0, parser.value(showOption).toInt());
+    QRandomGenerator random(parser.value(seedOption).toUInt());
+
+    Result result;
+    foreach (const QString &directory, parser.positionalArguments()) {
+        QDirIterator it(directory, QStringList() << "*.qml" << "*.js", QDir::Files, QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            QFile file(it.next());
+            if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+                QTextStream(stderr) << "Unable to read " << file.fileName() << '\n';
+                return 1;
+            }
+            compare(file.fileName(), QString::fromUtf8(file.readAll()), result, show);
+        }
+    }
+    for (int i = 0; i < documents; i++)
+        compare(QString("generated #%1").arg(i), generate(random), result, show);
+
+    QTextStream out(stdout);
+    foreach (const QString &report, result.reports)
+        out << report << '\n';
+    out << result.documents << " documents, " << result.blocks << " blocks compared, "
+        << result.blocksLeftOut << " left out after an embedding property, "
+        << result.mismatches << " documents differ: " << (result.mismatches == 0 ? "ok" : "FAILED") << '\n';
+    return result.mismatches == 0 ? 0 : 1;
+}
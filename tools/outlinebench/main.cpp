@@ -0,0 +1,236 @@
+// Types into a generated QML file of about 5000 lines the way the editor
+// does, one character per edit, and measures how long OutlineModel takes
+// to bring its tree up to date after every keystroke. The edits change a
+// binding inside an object in the middle of the file, add a property to
+// it and one to the root object between its children, then take all of
+// it back. After each of these the tree is compared with the one a fresh
+// model parses from the whole file. Runs headless on the offscreen
+// platform and exits with 1 when the trees differ or the 95th percentile
+// is over the budget.
+//
+//   outlinebench --lines 5000 --budget 1.0
+//
+// Only the outline update counts against the budget; the highlighter
+// re-lexes within the edit itself, which is reported next to it.
+
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QGuiApplication>
+#include <QQmlComponent>
+#include <QQmlEngine>
+#include <QTextBlock>
+#include <QTextCursor>
+#include <QTextDocument>
+#include <QTextStream>
+#include <algorithm>
+
+#include "OutlineModel.h"
+#include "SyntaxHighlighter.h"
+
+namespace {
+
+double milliseconds(qint64 nanoseconds)
+{
+    return qRound64(nanoseconds / 1000.0) / 1000.0;
+}
+
+// an Item with a little of everything the outline shows per 13 lines
+QString generate(int lines)
+{
+    QString text = "import QtQuick 2.5\n\nRectangle {\n    id: root\n    width: 720\n    height: 1280\n";
+    for (int i = 0; text.count('\n') < lines - 2; i++)
+    {
+        text += QString("\n"
+                        "    Item {\n"
+                        "        id: item%1\n"
+                        "        x: %1\n"
+                        "        y: %1 * 2\n"
+                        "        property int value%1: %1\n"
+                        "        signal picked%1(int index)\n"
+                        "        onValueChanged: console.log(value)\n"
+                        "        function compute%1(a) {\n"
+                        "            return a * %1\n"
+                        "        }\n"
+                        "        Text { text: \"item %1\" }\n"
+                        "    }\n").arg(i);
+    }
+    return text + "}\n";
+}
+
+// the tree as text, one row per line
+QString dump(const OutlineModel &model, const QModelIndex &parent = QModelIndex(), int depth = 0)
+{
+    QString text;
+    for (int row = 0; row < model.rowCount(parent); row++)
+    {
+        const QModelIndex index = model.index(row, 0, parent);
+        text += QString(depth * 2, ' ') + QString("%1 %2 %3 %4\n")
+                .arg(model.data(index, OutlineModel::KindRole).toString(),
+                     model.data(index, OutlineModel::NameRole).toString(),
+                     model.data(index, OutlineModel::DetailRole).toString())
+                .arg(model.data(index, OutlineModel::PositionRole).toInt());
+        text += dump(model, index, depth + 1);
+    }
+    return text;
+}
+
+class Bench
+{
+public:
+    Bench(SyntaxHighlighter *highlighter, OutlineModel *outline) :
+        m_highlighter(highlighter),
+        m_outline(outline),
+        m_document(highlighter->highlighter()->document())
+    {
+    }
+
+    void type(int position, const QString &text)
+    {
+        for (int i = 0; i < text.count(); i++)
+        {
+            QTextCursor cursor(m_document);
+            cursor.setPosition(position + i);
+            edit([&cursor, &text, i]() { cursor.insertText(text.mid(i, 1)); });
+        }
+    }
+
+    void erase(int position, int count)
+    {
+        for (int i = count; i > 0; i--)
+        {
+            QTextCursor cursor(m_document);
+            cursor.setPosition(position + i);
+            edit([&cursor]() { cursor.deletePreviousChar(); });
+        }
+    }
+
+    // the tree as a model parsing the whole file builds it
+    bool check(const QString &what)
+    {
+        OutlineModel fresh;
+        fresh.setHighlighter(m_highlighter);
+        QCoreApplication::processEvents();
+
+        if (dump(fresh) == dump(*m_outline))
+            return true;
+
+        QTextStream(stderr) << "The outline differs from a full parse after " << what << '\n';
+        m_passed = false;
+        return false;
+    }
+
+    // where text starts, a search across lines
+    int find(const QString &text) const
+    {
+        return m_document->toPlainText().indexOf(text);
+    }
+
+    bool report(double budget)
+    {
+        std::sort(m_updates.begin(), m_updates.end());
+        std::sort(m_edits.begin(), m_edits.end());
+        const qint64 p95 = m_updates.at(m_updates.count() * 95 / 100);
+
+        QTextStream(stdout) << m_document->blockCount() << " lines, " << m_updates.count() << " keystrokes\n"
+                            << "outline update: median " << milliseconds(m_updates.at(m_updates.count() / 2))
+                            << " ms, p95 " << milliseconds(p95) << " ms, max " << milliseconds(m_updates.last()) << " ms\n"
+                            << "edit with highlighting: median " << milliseconds(m_edits.at(m_edits.count() / 2))
+                            << " ms, max " << milliseconds(m_edits.last()) << " ms\n";
+
+        const bool inBudget = milliseconds(p95) < budget;
+        QTextStream(stdout) << "budget " << budget << " ms: "
+                            << (m_passed && inBudget ? "ok" : "FAILED") << '\n';
+        return m_passed && inBudget;
+    }
+
+private:
+    template <typename Edit>
+    void edit(Edit change)
+    {
+        QElapsedTimer timer;
+        timer.start();
+        change();
+        m_edits += timer.nsecsElapsed();
+
+        // what the queued update does once the event loop gets to it
+        timer.restart();
+        QMetaObject::invokeMethod(m_outline, "update", Qt::DirectConnection);
+        m_updates += timer.nsecsElapsed();
+
+        QCoreApplication::processEvents();
+    }
+
+    SyntaxHighlighter *m_highlighter;
+    OutlineModel *m_outline;
+    QTextDocument *m_document;
+    QVector<qint64> m_updates;
+    QVector<qint64> m_edits;
+    bool m_passed = true;
+};
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QGuiApplication app(argc, argv);
+    QCoreApplication::setApplicationName("outlinebench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Measures the outline update after every keystroke in a large file.");
+    parser.addHelpOption();
+    QCommandLineOption linesOption("lines", "Lines of the generated file.", "count", "5000");
+    QCommandLineOption budgetOption("budget", "Milliseconds the 95th percentile has to stay under.", "ms", "1.0");
+    parser.addOptions({ linesOption, budgetOption });
+    parser.process(app);
+
+    const int lines = qMax(20, parser.value(linesOption).toInt());
+    const double budget = parser.value(budgetOption).toDouble();
+
+    // the editor's document is a TextEdit's, the highlighter takes it from there
+    QQmlEngine engine;
+    QQmlComponent component(&engine);
+    component.setData("import QtQuick 2.5\nTextEdit {}\n", QUrl());
+    QScopedPointer<QObject> textEdit(component.create());
+    if (!textEdit)
+    {
+        QTextStream(stderr) << component.errorString();
+        return 1;
+    }
+    textEdit->setProperty("text", generate(lines));
+
+    SyntaxHighlighter highlighter;
+    highlighter.setHighlighter(textEdit.data());
+    OutlineModel outline;
+    outline.setHighlighter(&highlighter);
+    QCoreApplication::processEvents();
+
+    Bench bench(&highlighter, &outline);
+    const int item = lines / 26;
+
+    // a binding in the middle
+    const QString middle = QString("        x: %1\n").arg(item);
+    const int binding = bench.find(middle) + middle.count() - 1;
+    bench.type(binding, " + 10");
+    bench.check("changing a binding");
+
+    // a new member of that object
+    const QString property = "\n        property real extra: 0";
+    bench.type(binding + 5, property);
+    bench.check("adding a property");
+
+    // a new member of the root object, between two of its children
+    const QString between = QString("\n    }\n\n    Item {\n        id: item%1\n").arg(item + 1);
+    const int root = bench.find(between) + 6;
+    const QString rootProperty = "\n    property int count: 0";
+    bench.type(root, rootProperty);
+    bench.check("adding a property to the root object");
+
+    bench.erase(root, rootProperty.count());
+    bench.erase(binding, 5 + property.count());
+    bench.check("taking it back");
+
+    return bench.report(budget) ? 0 : 1;
+}
@@ -0,0 +1,39 @@
+QT += core gui qml quick concurrent
+
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+TARGET = outlinebench
+TEMPLATE = app
+
+INCLUDEPATH += ../../cpp
+
+HEADERS += \
+    ../../cpp/BlockData.h \
+    ../../cpp/BracketIndex.h \
+    ../../cpp/EditHistory.h \
+    ../../cpp/HighlightCache.h \
+    ../../cpp/Language.h \
+    ../../cpp/LatencyTracer.h \
+    ../../cpp/OutlineModel.h \
+    ../../cpp/PieceTable.h \
+    ../../cpp/QMLHighlighter.h \
+    ../../cpp/SyntaxHighlighter.h \
+    ../../cpp/TextBuffer.h
+
+SOURCES += \
+    main.cpp \
+    ../../cpp/BracketIndex.cpp \
+    ../../cpp/EditHistory.cpp \
+    ../../cpp/HighlightCache.cpp \
+    ../../cpp/Language.cpp \
+    ../../cpp/LatencyTracer.cpp \
+    ../../cpp/OutlineModel.cpp \
+    ../../cpp/PieceTable.cpp \
+    ../../cpp/QMLHighlighter.cpp \
+    ../../cpp/SyntaxHighlighter.cpp \
+    ../../cpp/TextBuffer.cpp
+
+# the dictionaries the highlighter colours identifiers by
+RESOURCES += \
+    ../../qmlcreator_resources.qrc
@@ -0,0 +1,212 @@
+// Drives ProjectManager on a MemoryFileSystem: restores the examples,
+// creates projects full of files, duplicates, moves, lists, removes and
+// restores again, and checks after every step that the listings are what
+// they should be and that nothing is copied or moved over what exists. No
+// disk is touched, so the timings only measure ProjectManager and the
+// file system layer and every run sees the same state. Writes JSON and
+// exits with 1 when a check fails.
+//
+//   projectbench --projects 200 --files 50 --output before.json
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+
+#include "FileSystem.h"
+#include "ProjectManager.h"
+
+namespace {
+
+double milliseconds(qint64 nanoseconds)
+{
+    return qRound64(nanoseconds / 1000.0) / 1000.0;
+}
+
+class Bench
+{
+public:
+    explicit Bench(ProjectManager *manager)
+    {
+        QObject::connect(manager, &ProjectManager::error, [this](const QString &description) {
+            m_errors += description;
+        });
+    }
+
+    template <typename Step>
+    void measure(const QString &name, Step step)
+    {
+        QElapsedTimer timer;
+        timer.start();
+        step();
+        m_steps[name] = milliseconds(timer.nsecsElapsed());
+    }
+
+    void check(bool passed, const QString &what)
+    {
+        if (passed)
+            return;
+        qWarning().noquote() << "Check failed:" << what;
+        m_failures += what;
+    }
+
+    // for steps that have to fail
+    bool takeError()
+    {
+        if (m_errors.isEmpty())
+            return false;
+        m_errors.removeLast();
+        return true;
+    }
+
+    QJsonObject report() const
+    {
+        QJsonObject report;
+        report["stepsMs"] = m_steps;
+        report["errors"] = QJsonArray::fromStringList(m_errors);
+        report["failures"] = QJsonArray::fromStringList(m_failures);
+        return report;
+    }
+
+    bool passed() const
+    {
+        return m_errors.isEmpty() && m_failures.isEmpty();
+    }
+
+private:
+    QJsonObject m_steps;
+    QStringList m_errors;
+    QStringList m_failures;
+};
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("projectbench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Measures and checks ProjectManager on an in-memory file system.");
+    parser.addHelpOption();
+    QCommandLineOption projectsOption("projects", "Projects to create.", "count", "100");
+    QCommandLineOption filesOption("files", "Files to create in every project.", "count", "20");
+    QCommandLineOption outputOption("output", "File to write the JSON to instead of the standard output.", "file");
+    parser.addOptions({ projectsOption, filesOption, outputOption });
+    parser.process(app);
+
+    const int projectCount = qMax(1, parser.value(projectsOption).toInt());
+    const int fileCount = qMax(1, parser.value(filesOption).toInt());
+
+    MemoryFileSystem *fileSystem = new MemoryFileSystem;
+    ProjectManager manager(fileSystem);
+    Bench bench(&manager);
+
+    const ResourceFileSystem resources(":/qml/examples");
+    const int exampleCount = resources.entries(QString()).count();
+
+    manager.setBaseFolder(ProjectManager::Examples);
+    bench.check(manager.readOnly(), "examples are read-only before they are restored");
+    bench.check(manager.projects().count() == exampleCount, "examples are listed from the resources");
+
+    bench.measure("restoreExamples", [&]() { manager.restoreExamples(); });
+    bench.check(!manager.readOnly(), "restored examples are writable");
+    bench.check(manager.projects().count() == exampleCount, "every example is restored");
+
+    manager.setBaseFolder(ProjectManager::Projects);
+    bench.measure("createProjects", [&]() {
+        for (int i = 0; i < projectCount; i++)
+        {
+            const QString projectName = QString("Project %1").arg(i);
+            manager.createProject(projectName);
+            manager.setProjectName(projectName);
+            for (int j = 0; j < fileCount; j++)
+                manager.createFile(QString("File%1").arg(j), (j % 2) ? "js" : "qml");
+        }
+    });
+
+    bench.measure("listProjects", [&]() {
+        bench.check(manager.projects().count() == projectCount, "every project is listed");
+    });
+
+    bench.measure("listFiles", [&]() {
+        for (int i = 0; i < projectCount; i++)
+        {
+            manager.setProjectName(QString("Project %1").arg(i));
+            // main.qml of createProject on top of the created ones
+            bench.check(manager.files().count() == fileCount + 1,
+                        QString("every file of project %1 is listed").arg(i));
+        }
+    });
+
+    bench.measure("duplicateProject", [&]() { manager.duplicateProject("Project 0", "Duplicate"); });
+    manager.setProjectName("Duplicate");
+    bench.check(manager.files().count() == fileCount + 1, "a duplicate has every file");
+    manager.duplicateProject("Project 1", "Duplicate");
+    bench.check(bench.takeError(), "a duplicate does not replace a project");
+    manager.setProjectName("Duplicate");
+    bench.check(manager.files().count() == fileCount + 1, "a refused duplicate leaves the project as it was");
+
+    bench.measure("moveFiles", [&]() {
+        manager.createDir("Moved");
+        for (int j = 0; j < fileCount; j += 2)
+            manager.moveFile(QString("File%1.qml").arg(j), QString("Moved/Renamed%1.qml").arg(j));
+    });
+    manager.setSubDir("Moved");
+    bench.check(manager.files().count() == (fileCount + 1) / 2, "moved files are in their new directory");
+    manager.setSubDir(QString());
+    manager.moveFile("File1.js", "main.qml");
+    bench.check(bench.takeError(), "a move does not replace a file");
+    manager.removeProject("Duplicate");
+
+    manager.setProjectName("Project 0");
+    manager.setFileName("main.qml");
+    bench.check(manager.getFileContent().startsWith("// Project \"Project 0\""), "main.qml is read back");
+
+    bench.measure("removeFiles", [&]() {
+        for (int j = 0; j < fileCount; j++)
+            manager.removeFile(QString("File%1.%2").arg(j).arg((j % 2) ? "js" : "qml"));
+    });
+    bench.check(manager.files().count() == 1, "removed files are gone");
+
+    bench.measure("removeProjects", [&]() {
+        for (int i = 0; i < projectCount; i++)
+            manager.removeProject(QString("Project %1").arg(i));
+    });
+    bench.check(manager.projects().isEmpty(), "removed projects are gone");
+
+    // the file system refuses what would leave its root
+    bench.check(!fileSystem->remove(QString()), "the root cannot be removed");
+    bench.check(!fileSystem->remove(".."), "nothing outside the root can be removed");
+    bench.check(!fileSystem->rename("Projects", "Examples"), "a rename does not replace what exists");
+
+    manager.setBaseFolder(ProjectManager::Examples);
+    bench.measure("restoreExamplesAgain", [&]() { manager.restoreExamples(); });
+    bench.check(manager.projects().count() == exampleCount, "examples are restored over themselves");
+
+    QJsonObject report = bench.report();
+    report["qtVersion"] = QString(qVersion());
+    report["projects"] = projectCount;
+    report["files"] = fileCount;
+    report["examples"] = exampleCount;
+    const QByteArray json = QJsonDocument(report).toJson();
+
+    if (!parser.isSet(outputOption))
+    {
+        QTextStream(stdout) << json;
+        return bench.passed() ? 0 : 1;
+    }
+
+    QFile output(parser.value(outputOption));
+    if (!output.open(QIODevice::WriteOnly) || output.write(json) != json.size())
+    {
+        qCritical() << "Unable to write" << output.fileName();
+        return 1;
+    }
+    return bench.passed() ? 0 : 1;
+}
@@ -0,0 +1,32 @@
+QT += core gui qml quick concurrent
+
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+TARGET = projectbench
+TEMPLATE = app
+
+INCLUDEPATH += ../../cpp
+
+HEADERS += \
+    ../../cpp/EditHistory.h \
+    ../../cpp/FileJobQueue.h \
+    ../../cpp/FileSystem.h \
+    ../../cpp/PieceTable.h \
+    ../../cpp/ProjectArchive.h \
+    ../../cpp/ProjectManager.h \
+    ../../cpp/TextBuffer.h
+
+SOURCES += \
+    main.cpp \
+    ../../cpp/EditHistory.cpp \
+    ../../cpp/FileJobQueue.cpp \
+    ../../cpp/FileSystem.cpp \
+    ../../cpp/PieceTable.cpp \
+    ../../cpp/ProjectArchive.cpp \
+    ../../cpp/ProjectManager.cpp \
+    ../../cpp/TextBuffer.cpp
+
+# the examples and file templates, as the app has them
+RESOURCES += \
+    ../../qmlcreator_sources.qrc